@@ -0,0 +1,650 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Unattended setup, for provisioning machines on a production line.
+ *
+ * Given --answer-file, the main window is never shown. Instead, each
+ * page is filled in from the group of the keyfile named after its page
+ * ID and then applied, exactly as if the user had pressed Next:
+ *
+ *   [language]
+ *   locale=en_US.UTF-8
+ *
+ *   [keyboard]
+ *   layout=us
+ *
+ *   [timezone]
+ *   timezone=Europe/London
+ *
+ *   [account]
+ *   fullname=Factory User
+ *   username=factory
+ *
+ *   [password]
+ *   password=correct horse battery staple
+ *
+ * The eula page also needs accept=true; the endless-eula "metrics" and
+ * privacy "location" and "reporting" keys, the keyboard "type", the
+ * account "passwordless" and the password "hint" are optional.
+ *
+ * Pages without a group are applied with whatever they default to.
+ * The run stops at the first page that cannot be completed or applied.
+ * Once the last page is reached, the system settings the pages queued
+ * up are committed, and a JSON summary of what happened to each page
+ * and each setting is written to --answer-summary, or to standard
+ * output.
+ *
+ * With --benchmark, the window is shown as usual while this happens,
+ * and the summary also has the time to the first frame, how long each
+ * page took to go from Next to being painted, and the peak RSS. This
+ * is what gis-bench.sh runs.
+ */
+
+#include "config.h"
+
+#include <sys/resource.h>
+
+#include <json-glib/json-glib.h>
+
+#include "gis-answer-file.h"
+
+/* How long a page may take to become complete and be applied */
+#define PAGE_TIMEOUT_SECONDS 60
+
+/* How long to wait for the login keyring to pick up the new password */
+#define KEYRING_UPDATE_TIMEOUT 10000
+
+struct _GisAnswerFile {
+  GKeyFile *answers;
+  gchar *summary_path;
+
+  GisDriver *driver;
+  GisAssistant *assistant;
+  gulong page_changed_id;
+
+  /* the page being answered, and its signal handlers */
+  GisPage *page;
+  gulong complete_id;
+  gulong applying_id;
+  guint timeout_id;
+  gint64 page_start_time;
+  /* what to record for it once the assistant moves on */
+  const gchar *result;
+  gint64 apply_start_time;
+  gint64 apply_time;
+  gint64 transition_time;
+
+  gboolean benchmark;
+  gint64 process_start_time;
+  gint64 first_frame_time;
+  GdkFrameClock *frame_clock;
+  gulong after_paint_id;
+  gint64 transition_start_time;
+  /* between the assistant moving on and the new page being painted */
+  gboolean awaiting_paint;
+
+  gint64 start_time;
+  JsonBuilder *results;
+  GHashTable *answered_groups;
+  GHashTable *answered_pages;
+  gboolean finished;
+  gboolean succeeded;
+};
+
+/**
+ * gis_answer_file_new:
+ * @path: the keyfile of answers
+ * @summary_path: (nullable): where to write the summary, or %NULL for
+ *   standard output
+ * @error: return location for a #GError
+ *
+ * Returns: the answers, ready to be run with gis_answer_file_run(), or
+ *   %NULL if @path could not be loaded
+ */
+GisAnswerFile *
+gis_answer_file_new (const gchar  *path,
+                     const gchar  *summary_path,
+                     GError      **error)
+{
+  GisAnswerFile *answer_file;
+  GKeyFile *answers;
+
+  answers = g_key_file_new ();
+  if (!g_key_file_load_from_file (answers, path, G_KEY_FILE_NONE, error))
+    {
+      g_key_file_free (answers);
+      return NULL;
+    }
+
+  answer_file = g_slice_new0 (GisAnswerFile);
+  answer_file->answers = answers;
+  answer_file->summary_path = g_strdup (summary_path);
+  answer_file->answered_groups = g_hash_table_new (g_str_hash, g_str_equal);
+  answer_file->answered_pages = g_hash_table_new (NULL, NULL);
+
+  return answer_file;
+}
+
+void
+gis_answer_file_free (GisAnswerFile *answer_file)
+{
+  g_key_file_free (answer_file->answers);
+  g_free (answer_file->summary_path);
+  g_hash_table_destroy (answer_file->answered_groups);
+  g_hash_table_destroy (answer_file->answered_pages);
+  g_clear_object (&answer_file->results);
+  g_slice_free (GisAnswerFile, answer_file);
+}
+
+/**
+ * gis_answer_file_set_benchmark:
+ * @answer_file: a #GisAnswerFile
+ * @process_start_time: the monotonic time the process started at
+ *
+ * Makes the run show the window and time its frames, as well as fill
+ * in the pages.
+ */
+void
+gis_answer_file_set_benchmark (GisAnswerFile *answer_file,
+                               gint64         process_start_time)
+{
+  answer_file->benchmark = TRUE;
+  answer_file->process_start_time = process_start_time;
+}
+
+gboolean
+gis_answer_file_is_benchmark (GisAnswerFile *answer_file)
+{
+  return answer_file->benchmark;
+}
+
+gboolean
+gis_answer_file_succeeded (GisAnswerFile *answer_file)
+{
+  return answer_file->finished && answer_file->succeeded;
+}
+
+static void answer_current_page (GisAnswerFile *answer_file);
+
+static void
+stop_watching_page (GisAnswerFile *answer_file)
+{
+  if (answer_file->page == NULL)
+    return;
+
+  if (answer_file->complete_id != 0)
+    g_signal_handler_disconnect (answer_file->page, answer_file->complete_id);
+  if (answer_file->applying_id != 0)
+    g_signal_handler_disconnect (answer_file->page, answer_file->applying_id);
+  answer_file->complete_id = 0;
+  answer_file->applying_id = 0;
+
+  if (answer_file->timeout_id != 0)
+    g_source_remove (answer_file->timeout_id);
+  answer_file->timeout_id = 0;
+
+  g_clear_object (&answer_file->page);
+}
+
+static void
+add_milliseconds (JsonBuilder *builder,
+                  const gchar *name,
+                  gint64       usec)
+{
+  json_builder_set_member_name (builder, name);
+  json_builder_add_double_value (builder, usec / 1000.0);
+}
+
+static void
+add_result (GisAnswerFile *answer_file,
+            const gchar   *result,
+            const gchar   *message)
+{
+  JsonBuilder *builder = answer_file->results;
+
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "page");
+  json_builder_add_string_value (builder, GIS_PAGE_GET_CLASS (answer_file->page)->page_id);
+  json_builder_set_member_name (builder, "result");
+  json_builder_add_string_value (builder, result);
+  add_milliseconds (builder, "duration_ms",
+                    g_get_monotonic_time () - answer_file->page_start_time);
+  add_milliseconds (builder, "construct_ms",
+                    gis_page_get_construct_time (answer_file->page));
+  if (answer_file->apply_time != 0)
+    add_milliseconds (builder, "apply_ms", answer_file->apply_time);
+  if (answer_file->transition_time != 0)
+    add_milliseconds (builder, "transition_ms", answer_file->transition_time);
+  if (message != NULL)
+    {
+      json_builder_set_member_name (builder, "error");
+      json_builder_add_string_value (builder, message);
+    }
+  json_builder_end_object (builder);
+
+  answer_file->apply_time = 0;
+  answer_file->transition_time = 0;
+}
+
+static void
+add_setting_result (const gchar  *key,
+                    const GError *error,
+                    gpointer      user_data)
+{
+  JsonBuilder *builder = user_data;
+
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "setting");
+  json_builder_add_string_value (builder, key);
+  json_builder_set_member_name (builder, "result");
+  json_builder_add_string_value (builder, error == NULL ? "applied" : "failed");
+  if (error != NULL)
+    {
+      json_builder_set_member_name (builder, "error");
+      json_builder_add_string_value (builder, error->message);
+    }
+  json_builder_end_object (builder);
+}
+
+static void
+write_summary (GisAnswerFile *answer_file)
+{
+  JsonBuilder *builder = answer_file->results;
+  JsonGenerator *generator;
+  JsonNode *root;
+  GList *unused = NULL, *l;
+  gchar **groups;
+  gchar *json;
+  GError *error = NULL;
+  guint i;
+
+  /* Groups for pages that never came up are most likely typos */
+  groups = g_key_file_get_groups (answer_file->answers, NULL);
+  for (i = 0; groups[i] != NULL; i++)
+    if (!g_hash_table_contains (answer_file->answered_groups, groups[i]))
+      unused = g_list_prepend (unused, groups[i]);
+  unused = g_list_reverse (unused);
+
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "unused_answers");
+  json_builder_begin_array (builder);
+  for (l = unused; l != NULL; l = l->next)
+    json_builder_add_string_value (builder, l->data);
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "settings");
+  json_builder_begin_array (builder);
+  gis_settings_transaction_foreach_result (gis_driver_get_settings_transaction (answer_file->driver),
+                                           add_setting_result, builder);
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "succeeded");
+  json_builder_add_boolean_value (builder, answer_file->succeeded);
+  add_milliseconds (builder, "duration_ms",
+                    g_get_monotonic_time () - answer_file->start_time);
+
+  if (answer_file->benchmark)
+    {
+      struct rusage usage;
+
+      if (answer_file->first_frame_time != 0)
+        add_milliseconds (builder, "time_to_first_frame_ms",
+                          answer_file->first_frame_time - answer_file->process_start_time);
+
+      /* ru_maxrss is in kilobytes on Linux */
+      if (getrusage (RUSAGE_SELF, &usage) == 0)
+        {
+          json_builder_set_member_name (builder, "peak_rss_kb");
+          json_builder_add_int_value (builder, usage.ru_maxrss);
+        }
+    }
+
+  json_builder_end_object (builder);
+
+  g_list_free (unused);
+  g_strfreev (groups);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+  json = json_generator_to_data (generator, NULL);
+
+  if (answer_file->summary_path == NULL)
+    g_print ("%s\n", json);
+  else if (!g_file_set_contents (answer_file->summary_path, json, -1, &error))
+    {
+      g_warning ("Could not write %s: %s", answer_file->summary_path, error->message);
+      g_error_free (error);
+    }
+
+  g_free (json);
+  g_object_unref (generator);
+  json_node_unref (root);
+}
+
+static void
+quit (GisAnswerFile *answer_file)
+{
+  if (answer_file->succeeded &&
+      gis_driver_get_mode (answer_file->driver) == GIS_DRIVER_MODE_EXISTING_USER)
+    gis_add_setup_done_file ();
+
+  write_summary (answer_file);
+
+  g_application_release (G_APPLICATION (answer_file->driver));
+  g_application_quit (G_APPLICATION (answer_file->driver));
+}
+
+static void
+keyring_password_changed (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GisAnswerFile *answer_file = user_data;
+  GError *error = NULL;
+
+  if (!gis_wait_for_login_keyring_password_finish (result, &error))
+    {
+      g_warning ("%s", error->message);
+      g_error_free (error);
+    }
+
+  quit (answer_file);
+}
+
+static void
+finish (GisAnswerFile *answer_file,
+        gboolean       succeeded)
+{
+  if (answer_file->finished)
+    return;
+
+  answer_file->finished = TRUE;
+  answer_file->succeeded = succeeded;
+
+  stop_watching_page (answer_file);
+  g_signal_handler_disconnect (answer_file->assistant, answer_file->page_changed_id);
+  if (answer_file->after_paint_id != 0)
+    g_signal_handler_disconnect (answer_file->frame_clock, answer_file->after_paint_id);
+  answer_file->after_paint_id = 0;
+  g_clear_object (&answer_file->frame_clock);
+
+  /* The keyring is copied over to the new user, so the password
+   * change has to land before the machine is shut down. The
+   * application is still held, so the answer file outlives the wait. */
+  if (succeeded)
+    gis_wait_for_login_keyring_password_async (KEYRING_UPDATE_TIMEOUT,
+                                               NULL,
+                                               keyring_password_changed,
+                                               answer_file);
+  else
+    quit (answer_file);
+}
+
+static void
+page_failed (GisAnswerFile *answer_file,
+             const gchar   *message)
+{
+  g_warning ("Unattended setup failed on page %s: %s",
+             GIS_PAGE_GET_CLASS (answer_file->page)->page_id, message);
+
+  add_result (answer_file, "failed", message);
+  finish (answer_file, FALSE);
+}
+
+static void
+settings_committed (GObject      *source,
+                    GAsyncResult *res,
+                    gpointer      user_data)
+{
+  GisAnswerFile *answer_file = user_data;
+  GError *error = NULL;
+
+  /* Each setting's own result goes into the summary */
+  if (!gis_settings_transaction_commit_finish (GIS_SETTINGS_TRANSACTION (source), res, &error))
+    {
+      g_warning ("Unattended setup failed to apply system settings: %s", error->message);
+      g_error_free (error);
+      finish (answer_file, FALSE);
+      return;
+    }
+
+  finish (answer_file, TRUE);
+}
+
+static gboolean
+page_timed_out (gpointer user_data)
+{
+  GisAnswerFile *answer_file = user_data;
+
+  answer_file->timeout_id = 0;
+  page_failed (answer_file, "Timed out");
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+answer_current_page_idle (gpointer user_data)
+{
+  answer_current_page (user_data);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+after_paint (GdkFrameClock *frame_clock,
+             GisAnswerFile *answer_file)
+{
+  gint64 now = g_get_monotonic_time ();
+
+  if (answer_file->first_frame_time == 0)
+    answer_file->first_frame_time = now;
+
+  if (answer_file->awaiting_paint)
+    {
+      answer_file->awaiting_paint = FALSE;
+      answer_file->transition_time = now - answer_file->transition_start_time;
+      answer_current_page (answer_file);
+    }
+}
+
+static void
+page_changed (GisAssistant  *assistant,
+              GisAnswerFile *answer_file)
+{
+  if (answer_file->page == NULL ||
+      gis_assistant_get_current_page (assistant) == answer_file->page)
+    return;
+
+  add_result (answer_file, answer_file->result, NULL);
+  stop_watching_page (answer_file);
+
+  /* Let the new page finish being shown first; when benchmarking, that
+   * is once it has been painted. */
+  if (answer_file->frame_clock != NULL)
+    {
+      answer_file->awaiting_paint = TRUE;
+      gtk_widget_queue_draw (gtk_widget_get_toplevel (GTK_WIDGET (assistant)));
+    }
+  else
+    g_idle_add (answer_current_page_idle, answer_file);
+}
+
+static gboolean
+check_apply_rejected (gpointer user_data)
+{
+  GisAnswerFile *answer_file = user_data;
+  GisPage *page = answer_file->page;
+
+  /* A page that accepts its apply moves the assistant on straight
+   * away; one that is still current afterwards turned it down. */
+  if (page != NULL && !gis_page_get_applying (page) &&
+      gis_assistant_get_current_page (answer_file->assistant) == page)
+    page_failed (answer_file, "The page did not accept the answers");
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+page_applying_changed (GisPage       *page,
+                       GParamSpec    *pspec,
+                       GisAnswerFile *answer_file)
+{
+  if (gis_page_get_applying (page))
+    return;
+
+  /* Pages that apply synchronously notify twice */
+  if (answer_file->apply_time == 0)
+    answer_file->apply_time = g_get_monotonic_time () - answer_file->apply_start_time;
+
+  g_idle_add (check_apply_rejected, answer_file);
+}
+
+static void
+go_forward (GisAnswerFile *answer_file)
+{
+  GisPage *page = answer_file->page;
+
+  if (answer_file->complete_id != 0)
+    {
+      g_signal_handler_disconnect (page, answer_file->complete_id);
+      answer_file->complete_id = 0;
+    }
+
+  /* Skippable pages the answers did not fill in are skipped */
+  answer_file->result = gis_page_get_complete (page) ? "applied" : "skipped";
+
+  answer_file->applying_id = g_signal_connect (page, "notify::applying",
+                                               G_CALLBACK (page_applying_changed),
+                                               answer_file);
+  answer_file->apply_start_time = g_get_monotonic_time ();
+  answer_file->transition_start_time = answer_file->apply_start_time;
+  gis_assistant_next_page (answer_file->assistant);
+}
+
+static void
+page_complete_changed (GisPage       *page,
+                       GParamSpec    *pspec,
+                       GisAnswerFile *answer_file)
+{
+  if (gis_page_get_complete (page))
+    go_forward (answer_file);
+}
+
+static void
+answer_current_page (GisAnswerFile *answer_file)
+{
+  GisPage *page;
+  GError *error = NULL;
+
+  page = gis_assistant_get_current_page (answer_file->assistant);
+  if (page == NULL)
+    {
+      g_warning ("Unattended setup failed: there are no pages");
+      finish (answer_file, FALSE);
+      return;
+    }
+
+  answer_file->page = g_object_ref (page);
+  answer_file->page_start_time = g_get_monotonic_time ();
+  g_hash_table_add (answer_file->answered_groups,
+                    (gpointer) GIS_PAGE_GET_CLASS (page)->page_id);
+
+  /* The assistant sends us back to pages whose background apply
+   * failed; answering them again would only fail again. */
+  if (!g_hash_table_add (answer_file->answered_pages, page))
+    {
+      page_failed (answer_file, "Applying the answers failed in the background");
+      return;
+    }
+
+  if (!gis_page_apply_answers (page, answer_file->answers, &error))
+    {
+      page_failed (answer_file, error->message);
+      g_error_free (error);
+      return;
+    }
+
+  if (gis_assistant_is_last_page (answer_file->assistant))
+    {
+      add_result (answer_file, "reached", NULL);
+      gis_settings_transaction_commit_async (gis_driver_get_settings_transaction (answer_file->driver),
+                                             NULL, settings_committed, answer_file);
+      return;
+    }
+
+  answer_file->timeout_id = g_timeout_add_seconds (PAGE_TIMEOUT_SECONDS,
+                                                   page_timed_out, answer_file);
+
+  /* Some answers, like usernames, are checked asynchronously */
+  if (gis_page_get_complete (page) || gis_page_get_skippable (page))
+    go_forward (answer_file);
+  else
+    answer_file->complete_id = g_signal_connect (page, "notify::complete",
+                                                 G_CALLBACK (page_complete_changed),
+                                                 answer_file);
+}
+
+/**
+ * gis_answer_file_run:
+ * @answer_file: a #GisAnswerFile
+ * @driver: the driver, with its pages already set up
+ *
+ * Goes through the pages with the given answers, and quits @driver
+ * once done.
+ */
+void
+gis_answer_file_run (GisAnswerFile *answer_file,
+                     GisDriver     *driver)
+{
+  g_return_if_fail (answer_file->driver == NULL);
+
+  answer_file->driver = driver;
+  answer_file->assistant = gis_driver_get_assistant (driver);
+  answer_file->start_time = g_get_monotonic_time ();
+
+  answer_file->results = json_builder_new ();
+  json_builder_begin_object (answer_file->results);
+  json_builder_set_member_name (answer_file->results, "pages");
+  json_builder_begin_array (answer_file->results);
+
+  answer_file->page_changed_id = g_signal_connect (answer_file->assistant, "page-changed",
+                                                   G_CALLBACK (page_changed), answer_file);
+
+  /* The driver has presented the window by now */
+  if (answer_file->benchmark)
+    {
+      GdkFrameClock *frame_clock;
+
+      frame_clock = gtk_widget_get_frame_clock (gtk_widget_get_toplevel (GTK_WIDGET (answer_file->assistant)));
+      if (frame_clock != NULL)
+        {
+          answer_file->frame_clock = g_object_ref (frame_clock);
+          answer_file->after_paint_id = g_signal_connect (frame_clock, "after-paint",
+                                                          G_CALLBACK (after_paint), answer_file);
+        }
+      else
+        {
+          g_warning ("The window is not realized; not timing frames");
+        }
+    }
+
+  g_application_hold (G_APPLICATION (driver));
+  g_idle_add (answer_current_page_idle, answer_file);
+}
@@ -0,0 +1,41 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_ANSWER_FILE_H__
+#define __GIS_ANSWER_FILE_H__
+
+#include "gnome-initial-setup.h"
+
+G_BEGIN_DECLS
+
+GisAnswerFile *gis_answer_file_new       (const gchar    *path,
+                                          const gchar    *summary_path,
+                                          GError        **error);
+void           gis_answer_file_free      (GisAnswerFile  *answer_file);
+
+void           gis_answer_file_set_benchmark (GisAnswerFile *answer_file,
+                                              gint64         process_start_time);
+gboolean       gis_answer_file_is_benchmark  (GisAnswerFile *answer_file);
+
+void           gis_answer_file_run       (GisAnswerFile  *answer_file,
+                                          GisDriver      *driver);
+gboolean       gis_answer_file_succeeded (GisAnswerFile  *answer_file);
+
+G_END_DECLS
+
+#endif /* __GIS_ANSWER_FILE_H__ */
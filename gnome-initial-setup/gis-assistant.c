@@ -26,6 +26,10 @@
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
 #include "gis-assistant.h"
 
 enum {
@@ -55,9 +59,25 @@ struct _GisAssistantPrivate
   GtkWidget *titlebar;
   GtkWidget *title;
   GtkWidget *stack;
+  GtkWidget *apply_error;
+  GtkWidget *apply_error_label;
+  GtkWidget *apply_error_review;
 
   GList *pages;
   GisPage *current_page;
+
+  /* Pages which have not been constructed yet, in order */
+  GList *factories;
+  guint prebuild_id;
+
+  /* Pages we moved on from while they were still applying */
+  GList *background_applies;
+  /* Pages whose background apply failed, to send the user back to */
+  GList *failed_pages;
+  /* The last page, held back until the background applies are done */
+  GisPage *barrier_page;
+
+  guint trim_id;
 };
 typedef struct _GisAssistantPrivate GisAssistantPrivate;
 
@@ -68,6 +88,23 @@ struct _GisAssistantPagePrivate
   GList *link;
 };
 
+typedef struct {
+  gchar *page_id;
+  GisPreparePageFunc prepare_page_func;
+  GisDriver *driver;
+} PageFactory;
+
+void update_navigation_buttons (GisAssistant *assistant);
+static void update_applying_state (GisAssistant *assistant);
+static void update_apply_error (GisAssistant *assistant);
+
+static void
+page_factory_free (PageFactory *factory)
+{
+  g_free (factory->page_id);
+  g_slice_free (PageFactory, factory);
+}
+
 static void
 visible_child_changed (GisAssistant *assistant)
 {
@@ -84,6 +121,13 @@ widget_destroyed (GtkWidget    *widget,
   priv->pages = g_list_delete_link (priv->pages, page->assistant_priv->link);
   if (page == priv->current_page)
     priv->current_page = NULL;
+  if (page == priv->barrier_page)
+    priv->barrier_page = NULL;
+
+  /* Destroying the page cancels its apply */
+  priv->background_applies = g_list_remove (priv->background_applies, page);
+  priv->failed_pages = g_list_remove (priv->failed_pages, page);
+  update_apply_error (assistant);
 
   g_slice_free (GisAssistantPagePrivate, page->assistant_priv);
   page->assistant_priv = NULL;
@@ -95,30 +139,237 @@ switch_to (GisAssistant          *assistant,
 {
   GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
 
+  /* Before it slides in */
+  gis_page_restore_resources (page);
   gtk_stack_set_visible_child (GTK_STACK (priv->stack), GTK_WIDGET (page));
 }
 
+/* Pages before the current one have been gone past. Once they are off
+ * screen and done applying, they can let go of what they only need
+ * while shown; going back to one restores it in switch_to(). */
+#ifdef __GLIBC__
+static gboolean
+trim_heap (gpointer user_data)
+{
+  GisAssistant *assistant = user_data;
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  gint64 trace_time;
+
+  trace_time = gis_trace_begin ();
+  malloc_trim (0);
+  gis_trace_end (trace_time, "page", "malloc_trim");
+
+  priv->trim_id = 0;
+  return G_SOURCE_REMOVE;
+}
+#endif
+
+static void
+release_completed_pages (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  gboolean released = FALSE;
+  GList *l;
+
+  if (priv->current_page == NULL ||
+      gtk_stack_get_transition_running (GTK_STACK (priv->stack)))
+    return;
+
+  for (l = priv->pages; l != NULL && l->data != priv->current_page; l = l->next)
+    {
+      GisPage *page = l->data;
+
+      if (!gis_page_get_applying (page))
+        released |= gis_page_release_resources (page);
+    }
+
+#ifdef __GLIBC__
+  /* Much of what pages release is widgets, made of small allocations
+   * which malloc would otherwise keep to itself. Give it back once for
+   * the whole lot, when nothing else needs doing. */
+  if (released && priv->trim_id == 0)
+    priv->trim_id = g_idle_add_full (G_PRIORITY_LOW, trim_heap, assistant, NULL);
+#endif
+}
+
 static inline gboolean
 should_show_page (GList *l)
 {
   return l != NULL && gtk_widget_get_visible (GTK_WIDGET (l->data));
 }
 
+/**
+ * gis_assistant_build_next_page:
+ * @assistant: a #GisAssistant
+ *
+ * Constructs the pages of the first pending page factory, if any.
+ * Factories may add any number of pages, including none.
+ *
+ * Returns: %FALSE if there was nothing left to construct
+ */
+gboolean
+gis_assistant_build_next_page (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  PageFactory *factory;
+  gint64 start, trace_time, rss;
+
+  if (priv->factories == NULL)
+    return FALSE;
+
+  factory = priv->factories->data;
+  priv->factories = g_list_delete_link (priv->factories, priv->factories);
+
+  start = g_get_monotonic_time ();
+  trace_time = gis_trace_begin ();
+  rss = gis_memory_stats_begin ();
+  factory->prepare_page_func (factory->driver);
+  gis_memory_stats_end (rss, factory->page_id, GIS_MEMORY_STATS_BUILD);
+  gis_trace_end (trace_time, "page", "gis_prepare_%s_page", factory->page_id);
+  g_debug ("Constructed page %s in %" G_GINT64_FORMAT " ms",
+           factory->page_id, (g_get_monotonic_time () - start) / 1000);
+
+  page_factory_free (factory);
+
+  if (priv->factories == NULL)
+    update_navigation_buttons (assistant);
+
+  return TRUE;
+}
+
 static GisPage *
-find_next_page (GisPage *page)
+find_built_next_page (GisPage *page)
 {
   GList *l = page->assistant_priv->link->next;
-  while (!should_show_page (l)) {
+
+  while (l != NULL && !should_show_page (l))
     l = l->next;
-  }
-  return GIS_PAGE (l->data);
+
+  return l != NULL ? GIS_PAGE (l->data) : NULL;
+}
+
+static GisPage *
+find_next_page (GisAssistant *assistant,
+                GisPage      *page)
+{
+  GisPage *next;
+
+  do {
+    next = find_built_next_page (page);
+    if (next != NULL)
+      return next;
+  } while (gis_assistant_build_next_page (assistant));
+
+  return NULL;
+}
+
+/* Builds the page after the current one while the user is busy with
+ * the current one, so that moving forward does not have to wait for
+ * it. One factory per idle callback keeps each slice short, and we
+ * stop as soon as there is a next page: anything further ahead waits
+ * until the user gets closer. */
+static gboolean
+prebuild_next_page (gpointer user_data)
+{
+  GisAssistant *assistant = user_data;
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  if (priv->current_page == NULL ||
+      gis_page_get_applying (priv->current_page) ||
+      find_built_next_page (priv->current_page) != NULL ||
+      !gis_assistant_build_next_page (assistant))
+    {
+      priv->prebuild_id = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+schedule_prebuild (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  if (priv->prebuild_id == 0 && priv->factories != NULL)
+    priv->prebuild_id = g_idle_add_full (G_PRIORITY_LOW, prebuild_next_page,
+                                         assistant, NULL);
+}
+
+static void
+update_apply_error (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  gchar *text;
+
+  if (priv->failed_pages == NULL)
+    {
+      gtk_widget_hide (priv->apply_error);
+      return;
+    }
+
+  text = g_strdup_printf (_("Some changes from “%s” could not be applied."),
+                          gis_page_get_title (priv->failed_pages->data));
+  gtk_label_set_text (GTK_LABEL (priv->apply_error_label), text);
+  g_free (text);
+
+  gtk_widget_show (priv->apply_error);
+}
+
+static void
+review_failed_page (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  GisPage *page;
+
+  g_return_if_fail (priv->failed_pages != NULL);
+
+  page = priv->failed_pages->data;
+  priv->failed_pages = g_list_delete_link (priv->failed_pages, priv->failed_pages);
+  priv->barrier_page = NULL;
+
+  update_apply_error (assistant);
+  update_applying_state (assistant);
+  switch_to (assistant, page);
+}
+
+/* The summary goes last, and it must only be shown once everything
+ * before it has actually been applied. */
+static gboolean
+is_final_page (GisAssistant *assistant,
+               GisPage      *page)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  return find_built_next_page (page) == NULL && priv->factories == NULL;
 }
 
 static void
 switch_to_next_page (GisAssistant *assistant)
 {
   GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
-  switch_to (assistant, find_next_page (priv->current_page));
+  GisPage *next;
+
+  next = find_next_page (assistant, priv->current_page);
+  g_return_if_fail (next != NULL);
+
+  if (is_final_page (assistant, next))
+    {
+      if (priv->failed_pages != NULL)
+        {
+          review_failed_page (assistant);
+          return;
+        }
+
+      if (priv->background_applies != NULL)
+        {
+          priv->barrier_page = next;
+          update_applying_state (assistant);
+          return;
+        }
+    }
+
+  switch_to (assistant, next);
 }
 
 static void
@@ -132,6 +383,40 @@ on_apply_done (GisPage *page,
     switch_to_next_page (assistant);
 }
 
+static void
+on_background_apply_done (GisPage *page,
+                          gboolean valid,
+                          gpointer user_data)
+{
+  GisAssistant *assistant = GIS_ASSISTANT (user_data);
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  GisPage *barrier_page;
+
+  priv->background_applies = g_list_remove (priv->background_applies, page);
+
+  if (!valid && g_list_find (priv->failed_pages, page) == NULL)
+    {
+      g_debug ("Applying page %s in the background failed",
+               GIS_PAGE_GET_CLASS (page)->page_id);
+      priv->failed_pages = g_list_append (priv->failed_pages, page);
+      update_apply_error (assistant);
+    }
+
+  if (priv->barrier_page != NULL && priv->background_applies == NULL)
+    {
+      barrier_page = priv->barrier_page;
+      priv->barrier_page = NULL;
+
+      if (priv->failed_pages != NULL)
+        review_failed_page (assistant);
+      else
+        switch_to (assistant, barrier_page);
+    }
+
+  update_applying_state (assistant);
+  release_completed_pages (assistant);
+}
+
 GisPage *
 gis_assistant_get_page_by_id (GisAssistant *assistant,
                               const char   *id)
@@ -147,6 +432,20 @@ gis_assistant_get_page_by_id (GisAssistant *assistant,
       return page;
   }
 
+  /* Construct it, and everything before it, if it is still pending */
+  for (l = priv->factories; l != NULL; l = l->next) {
+    PageFactory *factory = l->data;
+
+    if (g_strcmp0 (factory->page_id, id) == 0) {
+      GList *after = l->next;
+
+      while (priv->factories != after)
+        gis_assistant_build_next_page (assistant);
+
+      return gis_assistant_get_page_by_id (assistant, id);
+    }
+  }
+
   return NULL;
 }
 
@@ -154,9 +453,32 @@ void
 gis_assistant_next_page (GisAssistant *assistant)
 {
   GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
-  if (priv->current_page)
-    gis_page_apply_begin (priv->current_page, on_apply_done, assistant);
-  else
+  GisPage *page = priv->current_page;
+
+  if (page == NULL)
+    {
+      switch_to_next_page (assistant);
+      return;
+    }
+
+  /* Going forward again is another try */
+  if (g_list_find (priv->failed_pages, page) != NULL)
+    {
+      priv->failed_pages = g_list_remove (priv->failed_pages, page);
+      update_apply_error (assistant);
+    }
+
+  if (!GIS_PAGE_GET_CLASS (page)->apply_in_background)
+    {
+      gis_page_apply_begin (page, on_apply_done, assistant);
+      return;
+    }
+
+  priv->background_applies = g_list_append (priv->background_applies, page);
+  gis_page_apply_begin (page, on_background_apply_done, assistant);
+
+  /* It may have failed straight away */
+  if (g_list_find (priv->failed_pages, page) == NULL)
     switch_to_next_page (assistant);
 }
 
@@ -231,7 +553,7 @@ update_navigation_buttons (GisAssistant *assistant)
 
   page_priv = page->assistant_priv;
 
-  is_last_page = (page_priv->link->next == NULL);
+  is_last_page = gis_assistant_is_last_page (assistant);
 
   if (is_last_page)
     {
@@ -277,16 +599,22 @@ update_navigation_buttons (GisAssistant *assistant)
 static void
 update_applying_state (GisAssistant *assistant)
 {
-  gboolean applying = FALSE;
+  gboolean applying = FALSE, waiting, busy;
   GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
   if (priv->current_page)
     applying = gis_page_get_applying (priv->current_page);
-  gtk_widget_set_sensitive (priv->forward, !applying);
-  gtk_widget_set_visible (priv->back, !applying);
+
+  /* Held back at the summary until the background applies finish */
+  waiting = (priv->barrier_page != NULL);
+  /* The spinner also shows that background applies are still going */
+  busy = applying || waiting || priv->background_applies != NULL;
+
+  gtk_widget_set_sensitive (priv->forward, !applying && !waiting);
+  gtk_widget_set_visible (priv->back, !applying && !waiting);
   gtk_widget_set_visible (priv->cancel, applying);
-  gtk_widget_set_visible (priv->spinner, applying);
+  gtk_widget_set_visible (priv->spinner, busy);
 
-  if (applying)
+  if (busy)
     gtk_spinner_start (GTK_SPINNER (priv->spinner));
   else
     gtk_spinner_stop (GTK_SPINNER (priv->spinner));
@@ -327,7 +655,10 @@ page_notify (GisPage      *page,
   if (strcmp (pspec->name, "title") == 0)
     g_object_notify_by_pspec (G_OBJECT (assistant), obj_props[PROP_TITLE]);
   else if (strcmp (pspec->name, "applying") == 0)
-    update_applying_state (assistant);
+    {
+      update_applying_state (assistant);
+      schedule_prebuild (assistant);
+    }
   else
     update_navigation_buttons (assistant);
 }
@@ -350,10 +681,61 @@ gis_assistant_add_page (GisAssistant *assistant,
 
   gtk_container_add (GTK_CONTAINER (priv->stack), GTK_WIDGET (page));
 
-  if (priv->current_page->assistant_priv->link == link->prev)
+  if (priv->current_page != NULL &&
+      priv->current_page->assistant_priv->link == link->prev)
     update_navigation_buttons (assistant);
 }
 
+/**
+ * gis_assistant_add_page_factory:
+ * @assistant: a #GisAssistant
+ * @page_id: the id of the page(s) @prepare_page_func creates
+ * @prepare_page_func: function which constructs the page(s) and adds
+ *   them with gis_driver_add_page()
+ * @driver: the #GisDriver to pass to @prepare_page_func
+ *
+ * Queues pages to be constructed once navigation reaches them, rather
+ * than up front.
+ */
+void
+gis_assistant_add_page_factory (GisAssistant       *assistant,
+                                const gchar        *page_id,
+                                GisPreparePageFunc  prepare_page_func,
+                                GisDriver          *driver)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+  PageFactory *factory;
+
+  factory = g_slice_new0 (PageFactory);
+  factory->page_id = g_strdup (page_id);
+  factory->prepare_page_func = prepare_page_func;
+  factory->driver = driver;
+
+  priv->factories = g_list_append (priv->factories, factory);
+
+  update_navigation_buttons (assistant);
+  schedule_prebuild (assistant);
+}
+
+void
+gis_assistant_clear_page_factories (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  g_list_free_full (priv->factories, (GDestroyNotify) page_factory_free);
+  priv->factories = NULL;
+}
+
+gboolean
+gis_assistant_is_last_page (GisAssistant *assistant)
+{
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  return (priv->current_page != NULL &&
+          priv->current_page->assistant_priv->link->next == NULL &&
+          priv->factories == NULL);
+}
+
 GisPage *
 gis_assistant_get_current_page (GisAssistant *assistant)
 {
@@ -382,6 +764,13 @@ go_backward (GtkWidget    *button,
   gis_assistant_previous_page (assistant);
 }
 
+static void
+review_clicked (GtkWidget    *button,
+                GisAssistant *assistant)
+{
+  review_failed_page (assistant);
+}
+
 static void
 do_cancel (GtkWidget    *button,
            GisAssistant *assistant)
@@ -420,6 +809,9 @@ update_current_page (GisAssistant *assistant,
   priv->current_page = page;
   g_object_notify_by_pspec (G_OBJECT (assistant), obj_props[PROP_TITLE]);
 
+  gis_watchdog_set_page (page != NULL ? GIS_PAGE_GET_CLASS (page)->page_id : NULL);
+  gis_frame_stats_set_page (page != NULL ? GIS_PAGE_GET_CLASS (page)->page_id : NULL);
+
   update_titlebar (assistant);
   update_forward_button (assistant);
   update_applying_state (assistant);
@@ -430,6 +822,9 @@ update_current_page (GisAssistant *assistant,
 
   if (page)
     gis_page_shown (page);
+
+  schedule_prebuild (assistant);
+  release_completed_pages (assistant);
 }
 
 static void
@@ -444,6 +839,21 @@ current_page_changed (GObject    *gobject,
   update_current_page (assistant, GIS_PAGE (new_page));
 }
 
+static void
+transition_running_changed (GObject    *gobject,
+                            GParamSpec *pspec,
+                            gpointer    user_data)
+{
+  GisAssistant *assistant = GIS_ASSISTANT (user_data);
+  gboolean running = gtk_stack_get_transition_running (GTK_STACK (gobject));
+
+  gis_frame_stats_set_transition (running);
+
+  /* The page we came from was still showing until now */
+  if (!running)
+    release_completed_pages (assistant);
+}
+
 void
 gis_assistant_locale_changed (GisAssistant *assistant)
 {
@@ -455,6 +865,8 @@ gis_assistant_locale_changed (GisAssistant *assistant)
   gtk_button_set_label (GTK_BUTTON (priv->skip), _("_Skip"));
   gtk_button_set_label (GTK_BUTTON (priv->back), _("_Previous"));
   gtk_button_set_label (GTK_BUTTON (priv->cancel), _("_Cancel"));
+  gtk_button_set_label (GTK_BUTTON (priv->apply_error_review), _("_Review"));
+  update_apply_error (assistant);
 
   for (l = priv->pages; l != NULL; l = l->next)
     gis_page_locale_changed (l->data);
@@ -481,6 +893,8 @@ gis_assistant_init (GisAssistant *assistant)
 
   g_signal_connect (priv->stack, "notify::visible-child",
                     G_CALLBACK (current_page_changed), assistant);
+  g_signal_connect (priv->stack, "notify::transition-running",
+                    G_CALLBACK (transition_running_changed), assistant);
 
   g_signal_connect (priv->forward, "clicked", G_CALLBACK (go_forward), assistant);
   g_signal_connect (priv->accept, "clicked", G_CALLBACK (go_forward), assistant);
@@ -488,6 +902,7 @@ gis_assistant_init (GisAssistant *assistant)
 
   g_signal_connect (priv->back, "clicked", G_CALLBACK (go_backward), assistant);
   g_signal_connect (priv->cancel, "clicked", G_CALLBACK (do_cancel), assistant);
+  g_signal_connect (priv->apply_error_review, "clicked", G_CALLBACK (review_clicked), assistant);
 
   gis_assistant_locale_changed (assistant);
   update_applying_state (assistant);
@@ -513,6 +928,24 @@ gis_assistant_get_property (GObject    *object,
     }
 }
 
+static void
+gis_assistant_finalize (GObject *object)
+{
+  GisAssistant *assistant = GIS_ASSISTANT (object);
+  GisAssistantPrivate *priv = gis_assistant_get_instance_private (assistant);
+
+  if (priv->prebuild_id != 0)
+    g_source_remove (priv->prebuild_id);
+  if (priv->trim_id != 0)
+    g_source_remove (priv->trim_id);
+
+  gis_assistant_clear_page_factories (assistant);
+  g_list_free (priv->background_applies);
+  g_list_free (priv->failed_pages);
+
+  G_OBJECT_CLASS (gis_assistant_parent_class)->finalize (object);
+}
+
 static void
 gis_assistant_class_init (GisAssistantClass *klass)
 {
@@ -531,10 +964,14 @@ gis_assistant_class_init (GisAssistantClass *klass)
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, titlebar);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, title);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, stack);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, apply_error);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, apply_error_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAssistant, apply_error_review);
 
   gtk_widget_class_bind_template_callback (GTK_WIDGET_CLASS (klass), visible_child_changed);
 
   gobject_class->get_property = gis_assistant_get_property;
+  gobject_class->finalize = gis_assistant_finalize;
 
   obj_props[PROP_TITLE] =
     g_param_spec_string ("title",
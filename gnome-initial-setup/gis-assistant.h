@@ -46,14 +46,23 @@ struct _GisAssistantClass
   GtkBoxClass parent_class;
 };
 
+typedef void (*GisPreparePageFunc) (GisDriver *driver);
+
 GType gis_assistant_get_type (void);
 
 void      gis_assistant_add_page          (GisAssistant *assistant,
                                            GisPage      *page);
+void      gis_assistant_add_page_factory  (GisAssistant       *assistant,
+                                           const gchar        *page_id,
+                                           GisPreparePageFunc  prepare_page_func,
+                                           GisDriver          *driver);
+void      gis_assistant_clear_page_factories (GisAssistant *assistant);
+gboolean  gis_assistant_build_next_page   (GisAssistant *assistant);
 
 void      gis_assistant_next_page         (GisAssistant *assistant);
 void      gis_assistant_previous_page     (GisAssistant *assistant);
 GisPage * gis_assistant_get_current_page  (GisAssistant *assistant);
+gboolean  gis_assistant_is_last_page      (GisAssistant *assistant);
 GisPage * gis_assistant_get_page_by_id    (GisAssistant *assistant,
                                            const char   *id);
 GList   * gis_assistant_get_all_pages     (GisAssistant *assistant);
@@ -0,0 +1,125 @@
+#!/bin/sh
+#
+# Goes through every page with the answers in gis-bench.answers, on a
+# virtual display and a private D-Bus, and writes the timings that
+# gnome-initial-setup --benchmark reports to OUTPUT as JSON.
+#
+# Usage: gis-bench.sh GNOME-INITIAL-SETUP ANSWERS OUTPUT
+#
+# The display is Xvfb if xvfb-run is installed, or else GTK's broadway
+# backend. System services, localed included, are stood in for by
+# python-dbusmock, when it is installed; without it, pages that need
+# them will fail or time out, which the output records. Waiting for
+# the mocks needs gdbus from GLib 2.72 or later.
+#
+# Set GIS_TRACE to also get a trace of the run, GIS_FRAME_STATS to get
+# its frame times, and GIS_MEMORY_STATS to get the memory each page
+# takes and gives back.
+
+set -e
+
+if [ $# -ne 3 ]; then
+    echo "Usage: $0 GNOME-INITIAL-SETUP ANSWERS OUTPUT" >&2
+    exit 2
+fi
+
+binary=$1
+answers=$2
+output=$3
+
+# Run on a bus of our own, which also stands in for the system bus
+if [ -z "$GIS_BENCH_IN_SESSION" ]; then
+    exec dbus-run-session -- env GIS_BENCH_IN_SESSION=1 "$0" "$@"
+fi
+export DBUS_SYSTEM_BUS_ADDRESS="$DBUS_SESSION_BUS_ADDRESS"
+
+workdir=$(mktemp -d)
+pids=
+cleanup () {
+    for pid in $pids; do
+        kill "$pid" 2>/dev/null || :
+    done
+    rm -rf "$workdir"
+}
+trap cleanup EXIT
+
+# Keep the run away from the real user's settings
+export HOME="$workdir/home"
+export XDG_CONFIG_HOME="$HOME/.config"
+export XDG_DATA_HOME="$HOME/.local/share"
+export XDG_CACHE_HOME="$HOME/.cache"
+export XDG_RUNTIME_DIR="$workdir/runtime"
+export GSETTINGS_BACKEND=memory
+mkdir -p "$XDG_CONFIG_HOME" "$XDG_DATA_HOME" "$XDG_CACHE_HOME"
+mkdir -m 700 "$XDG_RUNTIME_DIR"
+
+# Waits for a system service to claim its bus name
+wait_for_name () {
+    gdbus wait --system --timeout 10 "$1"
+}
+
+# dbusmock has no template for localed, so the SetLocale and
+# SetX11Keyboard calls the pages queue up would fail when they are
+# committed, and with them the whole run. Stand in for it with a bare
+# mock object that accepts them.
+mock_localed () {
+    python3 -m dbusmock --system org.freedesktop.locale1 \
+        /org/freedesktop/locale1 org.freedesktop.locale1 >/dev/null 2>&1 &
+    pids="$pids $!"
+    wait_for_name org.freedesktop.locale1
+
+    localed="--system --dest org.freedesktop.locale1 --object-path /org/freedesktop/locale1"
+    gdbus call $localed --method org.freedesktop.DBus.Mock.AddProperties \
+        org.freedesktop.locale1 \
+        "{'Locale': <['LANG=en_US.UTF-8']>, 'X11Layout': <'us'>, 'X11Model': <''>,
+          'X11Variant': <''>, 'X11Options': <''>, 'VConsoleKeymap': <'us'>,
+          'VConsoleKeymapToggle': <''>}" >/dev/null
+    gdbus call $localed --method org.freedesktop.DBus.Mock.AddMethods \
+        org.freedesktop.locale1 \
+        "[('SetLocale', 'asb', '', ''),
+          ('SetX11Keyboard', 'ssssbb', '', ''),
+          ('SetVConsoleKeyboard', 'ssbb', '', '')]" >/dev/null
+}
+
+# dbusmock templates, with the names they claim
+templates="polkitd:org.freedesktop.PolicyKit1
+timedated:org.freedesktop.timedate1
+logind:org.freedesktop.login1
+networkmanager:org.freedesktop.NetworkManager
+accounts_service:org.freedesktop.Accounts"
+
+if python3 -c 'import dbusmock' 2>/dev/null; then
+    for mock in $templates; do
+        python3 -m dbusmock --template "${mock%%:*}" >/dev/null 2>&1 &
+        pids="$pids $!"
+    done
+    for mock in $templates; do
+        wait_for_name "${mock#*:}"
+    done
+    mock_localed
+else
+    echo "python-dbusmock not found; system services will be missing" >&2
+fi
+
+set -- "$binary" --answer-file="$answers" --answer-summary="$output" --benchmark
+
+if command -v xvfb-run >/dev/null; then
+    xvfb-run -a -s "-screen 0 1280x800x24" "$@"
+elif command -v broadwayd >/dev/null; then
+    broadwayd :5 >/dev/null 2>&1 &
+    pids="$pids $!"
+    # Wait for it to listen, for at most 10 seconds
+    tries=100
+    until ls "$XDG_RUNTIME_DIR"/broadway*.socket >/dev/null 2>&1; do
+        tries=$((tries - 1))
+        if [ $tries -eq 0 ]; then
+            echo "broadwayd did not start" >&2
+            exit 1
+        fi
+        sleep 0.1
+    done
+    GDK_BACKEND=broadway BROADWAY_DISPLAY=:5 "$@"
+else
+    echo "Neither xvfb-run nor broadwayd found" >&2
+    exit 1
+fi
@@ -69,6 +69,11 @@ static GParamSpec *obj_props[PROP_LAST];
 struct _GisDriverPrivate {
   GtkWindow *main_window;
   GisAssistant *assistant;
+  GisVendorConfig *vendor_config;
+  GisSettingsTransaction *settings_transaction;
+  GisPermissionCache *permission_cache;
+  GisProxyPool *proxy_pool;
+  GisAnswerFile *answer_file;
 
   ActUser *user_account;
   gchar *user_password;
@@ -120,6 +125,10 @@ gis_driver_finalize (GObject *object)
   g_free (priv->user_password);
 
   g_clear_object (&priv->user_account);
+  g_clear_object (&priv->vendor_config);
+  g_clear_object (&priv->settings_transaction);
+  g_clear_object (&priv->permission_cache);
+  g_clear_object (&priv->proxy_pool);
 
   G_OBJECT_CLASS (gis_driver_parent_class)->finalize (object);
 }
@@ -159,6 +168,17 @@ rebuild_pages (GisDriver *driver)
   g_signal_emit (G_OBJECT (driver), signals[REBUILD_PAGES], 0);
 }
 
+static void
+vendor_config_changed (GisVendorConfig *config,
+                       GisDriver       *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+
+  /* Pages not built yet will be built from the new config anyway */
+  if (priv->assistant != NULL)
+    rebuild_pages (driver);
+}
+
 GisAssistant *
 gis_driver_get_assistant (GisDriver *driver)
 {
@@ -166,6 +186,55 @@ gis_driver_get_assistant (GisDriver *driver)
   return priv->assistant;
 }
 
+GisVendorConfig *
+gis_driver_get_vendor_config (GisDriver *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  return priv->vendor_config;
+}
+
+/**
+ * gis_driver_get_settings_transaction:
+ * @driver: a #GisDriver
+ *
+ * Returns: (transfer none): where pages queue the system settings they
+ *   change, to be applied together once setup is done
+ */
+GisSettingsTransaction *
+gis_driver_get_settings_transaction (GisDriver *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  return priv->settings_transaction;
+}
+
+/**
+ * gis_driver_get_permission_cache:
+ * @driver: a #GisDriver
+ *
+ * Returns: (transfer none): where pages get their polkit permissions
+ *   from, without blocking
+ */
+GisPermissionCache *
+gis_driver_get_permission_cache (GisDriver *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  return priv->permission_cache;
+}
+
+/**
+ * gis_driver_get_proxy_pool:
+ * @driver: a #GisDriver
+ *
+ * Returns: (transfer none): where pages get their system bus proxies
+ *   from, so that they are shared and survive the pages being rebuilt
+ */
+GisProxyPool *
+gis_driver_get_proxy_pool (GisDriver *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  return priv->proxy_pool;
+}
+
 void
 gis_driver_set_user_language (GisDriver *driver, const gchar *lang_id)
 {
@@ -261,8 +330,8 @@ gis_driver_real_locale_changed (GisDriver *driver)
   GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
   GtkTextDirection direction;
 
-  rebuild_pages (driver);
-
+  /* Pages retranslate themselves in place; the set of pages does not
+   * depend on the locale, so there is no need to rebuild them. */
   direction = gtk_get_locale_direction ();
   gtk_widget_set_default_direction (direction);
   gis_assistant_locale_changed (priv->assistant);
@@ -363,7 +432,13 @@ gis_driver_activate (GApplication *app)
 
   G_APPLICATION_CLASS (gis_driver_parent_class)->activate (app);
 
-  gtk_window_present (GTK_WINDOW (priv->main_window));
+  /* Unattended setup goes through the pages without showing them,
+   * unless it is there to time them */
+  if (priv->answer_file == NULL || gis_answer_file_is_benchmark (priv->answer_file))
+    gtk_window_present (GTK_WINDOW (priv->main_window));
+
+  if (priv->answer_file != NULL)
+    gis_answer_file_run (priv->answer_file, driver);
 }
 
 static gboolean
@@ -474,6 +549,20 @@ gis_driver_startup (GApplication *app)
 
   G_APPLICATION_CLASS (gis_driver_parent_class)->startup (app);
 
+  if (priv->mode == GIS_DRIVER_MODE_NEW_USER)
+    {
+      /* The language and keyboard pages change system settings in this
+       * mode; find out whether we may while the window is being built. */
+      gis_permission_cache_prefetch (priv->permission_cache, "org.freedesktop.locale1.set-locale");
+      gis_permission_cache_prefetch (priv->permission_cache, "org.freedesktop.locale1.set-keyboard");
+    }
+
+  /* The keyboard page reads the system layouts from localed */
+  gis_proxy_pool_prefetch (priv->proxy_pool,
+                           "org.freedesktop.locale1",
+                           "/org/freedesktop/locale1",
+                           "org.freedesktop.locale1");
+
   priv->main_window = g_object_new (GTK_TYPE_APPLICATION_WINDOW,
                                     "application", app,
                                     "type", GTK_WINDOW_TOPLEVEL,
@@ -485,6 +574,7 @@ gis_driver_startup (GApplication *app)
                     "realize",
                     G_CALLBACK (window_realize_cb),
                     (gpointer)app);
+  gis_frame_stats_watch (GTK_WIDGET (priv->main_window));
 
   priv->assistant = g_object_new (GIS_TYPE_ASSISTANT, NULL);
   gtk_container_add (GTK_CONTAINER (priv->main_window), GTK_WIDGET (priv->assistant));
@@ -512,6 +602,15 @@ gis_driver_init (GisDriver *driver)
 
   g_signal_connect (screen, "size-changed",
                     G_CALLBACK (screen_size_changed), driver);
+
+  /* Which pages to show may change with the vendor configuration */
+  priv->vendor_config = gis_vendor_config_new (VENDOR_CONF_FILE, TRUE);
+  g_signal_connect (priv->vendor_config, "changed",
+                    G_CALLBACK (vendor_config_changed), driver);
+
+  priv->settings_transaction = gis_settings_transaction_new ();
+  priv->permission_cache = gis_permission_cache_new ();
+  priv->proxy_pool = gis_proxy_pool_new ();
 }
 
 static void
@@ -574,6 +673,28 @@ gis_driver_save_data (GisDriver *driver)
   gis_assistant_save_data (priv->assistant);
 }
 
+/**
+ * gis_driver_set_answer_file:
+ *
+ * Makes @driver go through the pages with the answers in @answer_file,
+ * instead of showing them. Must be called before the driver is run;
+ * @answer_file must outlive it.
+ */
+void
+gis_driver_set_answer_file (GisDriver     *driver,
+                            GisAnswerFile *answer_file)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  priv->answer_file = answer_file;
+}
+
+gboolean
+gis_driver_is_unattended (GisDriver *driver)
+{
+  GisDriverPrivate *priv = gis_driver_get_instance_private (driver);
+  return priv->answer_file != NULL;
+}
+
 GisDriver *
 gis_driver_new (GisDriverMode mode)
 {
@@ -24,6 +24,10 @@
 
 #include "gis-assistant.h"
 #include "gis-page.h"
+#include "gis-vendor-config.h"
+#include "gis-settings-transaction.h"
+#include "gis-permission-cache.h"
+#include "gis-proxy-pool.h"
 #include <act/act-user-manager.h>
 
 G_BEGIN_DECLS
@@ -65,6 +69,10 @@ typedef enum {
 GType gis_driver_get_type (void);
 
 GisAssistant *gis_driver_get_assistant (GisDriver *driver);
+GisVendorConfig *gis_driver_get_vendor_config (GisDriver *driver);
+GisSettingsTransaction *gis_driver_get_settings_transaction (GisDriver *driver);
+GisPermissionCache *gis_driver_get_permission_cache (GisDriver *driver);
+GisProxyPool *gis_driver_get_proxy_pool (GisDriver *driver);
 void gis_driver_locale_changed (GisDriver *driver);
 
 void gis_driver_set_user_permissions (GisDriver   *driver,
@@ -104,6 +112,10 @@ void gis_driver_hide_window (GisDriver *driver);
 
 void gis_driver_save_data (GisDriver *driver);
 
+void gis_driver_set_answer_file (GisDriver     *driver,
+                                 GisAnswerFile *answer_file);
+gboolean gis_driver_is_unattended (GisDriver *driver);
+
 GisDriver *gis_driver_new (GisDriverMode mode);
 
 G_END_DECLS
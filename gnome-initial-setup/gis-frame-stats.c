@@ -0,0 +1,337 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Measures how smoothly the main window draws, so that page
+ * transitions and animations can be tuned for slow hardware.
+ *
+ * It is off unless GIS_FRAME_STATS is set to the file to write to:
+ *
+ *   GIS_FRAME_STATS=/tmp/gis-frames.json gnome-initial-setup
+ *
+ * The time between consecutive frames of the window's frame clock is
+ * recorded against the page being shown or, while the assistant's
+ * stack is sliding from one page to the next, against that
+ * transition. On exit the median, 95th and 99th percentile and
+ * longest frame times are written out for each, with the number of
+ * frames that missed a refresh.
+ *
+ * The frame clock stops when nothing needs drawing, so outside of
+ * transitions a gap longer than IDLE_GAP is taken to be the window
+ * sitting idle rather than a frame that took that long.
+ */
+
+#include "config.h"
+
+#include <math.h>
+
+#include <json-glib/json-glib.h>
+
+#include "gis-frame-stats.h"
+
+#define IDLE_GAP (250 * G_TIME_SPAN_MILLISECOND)
+
+typedef struct {
+  gchar *name;
+  /* frame intervals, in microseconds */
+  GArray *intervals;
+  guint dropped;
+} FrameBucket;
+
+static gchar *stats_file;
+/* name → FrameBucket */
+static GHashTable *pages;
+static GHashTable *transitions;
+
+static GdkFrameClock *frame_clock;
+static gulong after_paint_id;
+static gint64 last_frame_time;
+static gint64 refresh_interval;
+
+static const gchar *current_page;
+static const gchar *previous_page;
+static gboolean transition_running;
+
+static void
+frame_bucket_free (FrameBucket *bucket)
+{
+  g_free (bucket->name);
+  g_array_unref (bucket->intervals);
+  g_slice_free (FrameBucket, bucket);
+}
+
+static FrameBucket *
+ensure_bucket (GHashTable *table,
+               gchar      *name)
+{
+  FrameBucket *bucket;
+
+  bucket = g_hash_table_lookup (table, name);
+  if (bucket != NULL)
+    {
+      g_free (name);
+      return bucket;
+    }
+
+  bucket = g_slice_new0 (FrameBucket);
+  bucket->name = name;
+  bucket->intervals = g_array_new (FALSE, FALSE, sizeof (gint64));
+  g_hash_table_insert (table, bucket->name, bucket);
+
+  return bucket;
+}
+
+static void
+after_paint (GdkFrameClock *clock,
+             gpointer       user_data)
+{
+  FrameBucket *bucket;
+  gint64 frame_time, interval;
+
+  frame_time = gdk_frame_clock_get_frame_time (clock);
+  interval = last_frame_time != 0 ? frame_time - last_frame_time : 0;
+  last_frame_time = frame_time;
+
+  gdk_frame_clock_get_refresh_info (clock, frame_time, &refresh_interval, NULL);
+
+  if (interval <= 0 || current_page == NULL)
+    return;
+
+  if (transition_running)
+    bucket = ensure_bucket (transitions,
+                            g_strdup_printf ("%s → %s",
+                                             previous_page != NULL ? previous_page : "none",
+                                             current_page));
+  else if (interval < IDLE_GAP)
+    bucket = ensure_bucket (pages, g_strdup (current_page));
+  else
+    return;
+
+  g_array_append_val (bucket->intervals, interval);
+
+  /* Anything over half a refresh late has missed it */
+  if (refresh_interval > 0)
+    {
+      gint64 missed = (interval + refresh_interval / 2) / refresh_interval - 1;
+
+      if (missed > 0)
+        bucket->dropped += missed;
+    }
+}
+
+static void
+window_realized (GtkWidget *window,
+                 gpointer   user_data)
+{
+  if (frame_clock != NULL)
+    return;
+
+  frame_clock = g_object_ref (gtk_widget_get_frame_clock (window));
+  after_paint_id = g_signal_connect (frame_clock, "after-paint",
+                                     G_CALLBACK (after_paint), NULL);
+}
+
+void
+gis_frame_stats_init (void)
+{
+  const gchar *path;
+
+  path = g_getenv ("GIS_FRAME_STATS");
+  if (path == NULL || *path == '\0' || stats_file != NULL)
+    return;
+
+  stats_file = g_strdup (path);
+  pages = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                 NULL, (GDestroyNotify) frame_bucket_free);
+  transitions = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       NULL, (GDestroyNotify) frame_bucket_free);
+}
+
+/**
+ * gis_frame_stats_watch:
+ * @window: the main window
+ *
+ * Starts measuring the frames of @window, once it is realized.
+ */
+void
+gis_frame_stats_watch (GtkWidget *window)
+{
+  if (stats_file == NULL)
+    return;
+
+  if (gtk_widget_get_realized (window))
+    window_realized (window, NULL);
+  else
+    g_signal_connect (window, "realize", G_CALLBACK (window_realized), NULL);
+}
+
+void
+gis_frame_stats_set_page (const gchar *page_id)
+{
+  if (page_id == current_page)
+    return;
+
+  previous_page = current_page;
+  current_page = page_id;
+}
+
+/**
+ * gis_frame_stats_set_transition:
+ * @running: whether the stack is sliding between pages
+ *
+ * Frames drawn from when @running is set until it is unset are put
+ * down to going from the previous page to the current one.
+ */
+void
+gis_frame_stats_set_transition (gboolean running)
+{
+  if (transition_running == running)
+    return;
+
+  transition_running = running;
+
+  /* The frame clock was most likely idle before this; the first frame
+   * of the transition isn't late, just the first. */
+  if (running)
+    last_frame_time = 0;
+}
+
+static gint
+compare_intervals (gconstpointer a,
+                   gconstpointer b)
+{
+  gint64 interval_a = *(const gint64 *) a;
+  gint64 interval_b = *(const gint64 *) b;
+
+  return interval_a < interval_b ? -1 : interval_a > interval_b;
+}
+
+/* Nearest rank, on sorted intervals */
+static gdouble
+percentile_ms (GArray *intervals,
+               gdouble percent)
+{
+  guint rank;
+
+  rank = (guint) ceil (percent / 100.0 * intervals->len);
+  if (rank > 0)
+    rank--;
+
+  return g_array_index (intervals, gint64, rank) / 1000.0;
+}
+
+static void
+add_bucket (JsonBuilder *builder,
+            FrameBucket *bucket)
+{
+  GArray *intervals = bucket->intervals;
+
+  g_array_sort (intervals, compare_intervals);
+
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "name");
+  json_builder_add_string_value (builder, bucket->name);
+  json_builder_set_member_name (builder, "frames");
+  json_builder_add_int_value (builder, intervals->len);
+  json_builder_set_member_name (builder, "dropped_frames");
+  json_builder_add_int_value (builder, bucket->dropped);
+  json_builder_set_member_name (builder, "p50_ms");
+  json_builder_add_double_value (builder, percentile_ms (intervals, 50));
+  json_builder_set_member_name (builder, "p95_ms");
+  json_builder_add_double_value (builder, percentile_ms (intervals, 95));
+  json_builder_set_member_name (builder, "p99_ms");
+  json_builder_add_double_value (builder, percentile_ms (intervals, 99));
+  json_builder_set_member_name (builder, "max_ms");
+  json_builder_add_double_value (builder, percentile_ms (intervals, 100));
+  json_builder_end_object (builder);
+}
+
+static gint
+compare_buckets (gconstpointer a,
+                 gconstpointer b)
+{
+  const FrameBucket *bucket_a = a;
+  const FrameBucket *bucket_b = b;
+
+  return g_strcmp0 (bucket_a->name, bucket_b->name);
+}
+
+static void
+add_buckets (JsonBuilder *builder,
+             const gchar *name,
+             GHashTable  *table)
+{
+  GList *buckets, *l;
+
+  buckets = g_list_sort (g_hash_table_get_values (table), compare_buckets);
+
+  json_builder_set_member_name (builder, name);
+  json_builder_begin_array (builder);
+  for (l = buckets; l != NULL; l = l->next)
+    add_bucket (builder, l->data);
+  json_builder_end_array (builder);
+
+  g_list_free (buckets);
+}
+
+void
+gis_frame_stats_shutdown (void)
+{
+  JsonBuilder *builder;
+  JsonGenerator *generator;
+  JsonNode *root;
+  GError *error = NULL;
+
+  if (stats_file == NULL)
+    return;
+
+  if (frame_clock != NULL)
+    {
+      g_signal_handler_disconnect (frame_clock, after_paint_id);
+      g_clear_object (&frame_clock);
+    }
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "refresh_interval_ms");
+  json_builder_add_double_value (builder, refresh_interval / 1000.0);
+  add_buckets (builder, "pages", pages);
+  add_buckets (builder, "transitions", transitions);
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+
+  if (!json_generator_to_file (generator, stats_file, &error))
+    {
+      g_warning ("Could not write frame statistics to %s: %s", stats_file, error->message);
+      g_error_free (error);
+    }
+
+  g_object_unref (generator);
+  json_node_unref (root);
+  g_object_unref (builder);
+
+  g_clear_pointer (&pages, g_hash_table_destroy);
+  g_clear_pointer (&transitions, g_hash_table_destroy);
+  g_clear_pointer (&stats_file, g_free);
+  current_page = previous_page = NULL;
+  transition_running = FALSE;
+  last_frame_time = 0;
+}
@@ -0,0 +1,35 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_FRAME_STATS_H__
+#define __GIS_FRAME_STATS_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+void gis_frame_stats_init           (void);
+void gis_frame_stats_shutdown       (void);
+
+void gis_frame_stats_watch          (GtkWidget   *window);
+void gis_frame_stats_set_page       (const gchar *page_id);
+void gis_frame_stats_set_transition (gboolean     running);
+
+G_END_DECLS
+
+#endif /* __GIS_FRAME_STATS_H__ */
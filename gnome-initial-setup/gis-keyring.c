@@ -26,6 +26,7 @@
 #include <gio/gio.h>
 
 #include "gis-keyring.h"
+#include "gis-trace.h"
 
 #include <libsecret/secret.h>
 
@@ -37,8 +38,51 @@
  * To achieve this, install a prompter for gnome-keyring that
  * never shows any UI, and create a keyring, if one does not
  * exist yet.
+ *
+ * Starting the daemon takes a while, so this happens in the
+ * background while the UI comes up. Password changes queued in the
+ * meantime are held back until the keyring is ready.
  */
 
+typedef enum {
+	KEYRING_NOT_STARTED,
+	KEYRING_STARTING,
+	KEYRING_READY,
+} KeyringState;
+
+static KeyringState keyring_state = KEYRING_NOT_STARTED;
+static gint64 keyring_start_time;
+static gint64 keyring_trace_time;
+
+static void start_next_update (void);
+static void wake_waiters (void);
+
+static void
+keyring_ready (void)
+{
+	keyring_state = KEYRING_READY;
+	gis_trace_end (keyring_trace_time, "startup", "gnome-keyring-daemon --unlock");
+	g_debug ("gnome-keyring-daemon ready after %" G_GINT64_FORMAT " ms",
+	         (g_get_monotonic_time () - keyring_start_time) / 1000);
+
+	start_next_update ();
+}
+
+static void
+keyring_daemon_unlocked (GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      user_data)
+{
+	GError *error = NULL;
+
+	if (!g_subprocess_communicate_utf8_finish (G_SUBPROCESS (source), result, NULL, NULL, &error)) {
+		g_warning ("Failed to communicate with gnome-keyring-daemon: %s", error->message);
+		g_error_free (error);
+	}
+
+	keyring_ready ();
+}
+
 void
 gis_ensure_login_keyring ()
 {
@@ -46,20 +90,25 @@ gis_ensure_login_keyring ()
 	GSubprocessLauncher *launcher = NULL;
 	GError *error = NULL;
 
+	if (keyring_state != KEYRING_NOT_STARTED)
+		return;
+
+	keyring_state = KEYRING_STARTING;
+	keyring_start_time = g_get_monotonic_time ();
+	keyring_trace_time = gis_trace_begin ();
+
 	g_debug ("launching gnome-keyring-daemon --unlock");
 	launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDIN_PIPE | G_SUBPROCESS_FLAGS_STDOUT_PIPE | G_SUBPROCESS_FLAGS_STDERR_SILENCE);
 	subprocess = g_subprocess_launcher_spawn (launcher, &error, "gnome-keyring-daemon", "--unlock", NULL);
 	if (subprocess == NULL) {
 		g_warning ("Failed to spawn gnome-keyring-daemon --unlock: %s", error->message);
 		g_error_free (error);
+		keyring_ready ();
 		goto out;
 	}
 
-	if (!g_subprocess_communicate_utf8 (subprocess, DUMMY_PWD, NULL, NULL, NULL, &error)) {
-		g_warning ("Failed to communicate with gnome-keyring-daemon: %s", error->message);
-		g_error_free (error);
-		goto out;
-	}
+	g_subprocess_communicate_utf8_async (subprocess, DUMMY_PWD, NULL,
+	                                     keyring_daemon_unlocked, NULL);
 
 out:
 	if (subprocess)
@@ -68,59 +117,336 @@ out:
 		g_object_unref (launcher);
 }
 
-void
-gis_update_login_keyring_password (const gchar *new_)
+gboolean
+gis_login_keyring_is_ready (void)
 {
-	GDBusConnection *bus = NULL;
-	SecretService *service = NULL;
-	SecretValue *old_secret = NULL;
-	SecretValue *new_secret = NULL;
-	GError *error = NULL;
-	
-	service = secret_service_get_sync (SECRET_SERVICE_OPEN_SESSION, NULL, &error);
-	if (service == NULL) {
-		g_warning ("Failed to get secret service: %s", error->message);
-		g_error_free (error);
-		goto out;
+	return keyring_state != KEYRING_STARTING;
+}
+
+/* The password the login keyring is currently locked with, or NULL
+ * while it still has DUMMY_PWD. Only touched from the main thread. */
+static gchar *keyring_password;
+
+/* Password changes are applied one at a time, in order, since each
+ * one needs to know the password set by the previous one. */
+static GQueue pending_updates = G_QUEUE_INIT;
+static gboolean update_running;
+
+typedef struct {
+	gchar *new_password;
+	SecretService *service;
+	gint64 start_time;
+} PasswordUpdate;
+
+static void
+clear_password (gchar *password)
+{
+	if (password) {
+		memset (password, 0, strlen (password));
+		g_free (password);
+	}
+}
+
+static void
+password_update_free (PasswordUpdate *update)
+{
+	clear_password (update->new_password);
+	if (update->service)
+		g_object_unref (update->service);
+	g_slice_free (PasswordUpdate, update);
+}
+
+static void
+finish_update (GTask  *task,
+               GError *error)
+{
+	PasswordUpdate *update = g_task_get_task_data (task);
+
+	if (error == NULL) {
+		clear_password (keyring_password);
+		keyring_password = g_strdup (update->new_password);
+
+		g_debug ("Changed login keyring password in %" G_GINT64_FORMAT " ms",
+		         (g_get_monotonic_time () - update->start_time) / 1000);
+		g_task_return_boolean (task, TRUE);
+	} else {
+		g_task_return_error (task, error);
 	}
 
-	bus = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, &error);
+	g_object_unref (task);
+
+	update_running = FALSE;
+	start_next_update ();
+}
+
+static void
+change_password_done (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+	GTask *task = user_data;
+	GVariant *ret;
+	GError *error = NULL;
+
+	ret = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &error);
+	if (ret)
+		g_variant_unref (ret);
+
+	finish_update (task, error);
+}
+
+static void
+got_session_bus (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+	GTask *task = user_data;
+	PasswordUpdate *update = g_task_get_task_data (task);
+	GDBusConnection *bus;
+	SecretValue *old_secret;
+	SecretValue *new_secret;
+	const gchar *old;
+	GError *error = NULL;
+
+	bus = g_bus_get_finish (result, &error);
 	if (bus == NULL) {
-		g_warning ("Failed to get session bus: %s", error->message);
-		g_error_free (error);
-		goto out;
+		g_prefix_error (&error, "Failed to get session bus: ");
+		finish_update (task, error);
+		return;
 	}
 
-	old_secret = secret_value_new (DUMMY_PWD, strlen (DUMMY_PWD), "text/plain");
-	new_secret = secret_value_new (new_, strlen (new_), "text/plain");
-
-	g_dbus_connection_call_sync (bus,
-                                     "org.gnome.keyring",
-                                     "/org/freedesktop/secrets",
-                                     "org.gnome.keyring.InternalUnsupportedGuiltRiddenInterface",
-                                     "ChangeWithMasterPassword",
-                                     g_variant_new ("(o@(oayays)@(oayays))",
-                                                    "/org/freedesktop/secrets/collection/login",
-                                                    secret_service_encode_dbus_secret (service, old_secret),
-                                                    secret_service_encode_dbus_secret (service, new_secret)),
-                                     NULL,
-                                     0,
-                                     G_MAXINT,
-                                     NULL, &error);
-
-        if (error != NULL) {
-          g_warning ("Failed to change keyring password: %s", error->message);
-          g_error_free (error);
-        }
+	old = keyring_password ? keyring_password : DUMMY_PWD;
+	old_secret = secret_value_new (old, strlen (old), "text/plain");
+	new_secret = secret_value_new (update->new_password, strlen (update->new_password), "text/plain");
 
-out:
+	/* Once sent, the change is not cancellable: we would not know
+	 * which password the keyring ended up with. */
+	g_dbus_connection_call (bus,
+	                        "org.gnome.keyring",
+	                        "/org/freedesktop/secrets",
+	                        "org.gnome.keyring.InternalUnsupportedGuiltRiddenInterface",
+	                        "ChangeWithMasterPassword",
+	                        g_variant_new ("(o@(oayays)@(oayays))",
+	                                       "/org/freedesktop/secrets/collection/login",
+	                                       secret_service_encode_dbus_secret (update->service, old_secret),
+	                                       secret_service_encode_dbus_secret (update->service, new_secret)),
+	                        NULL,
+	                        0,
+	                        G_MAXINT,
+	                        NULL,
+	                        change_password_done,
+	                        task);
+
+	secret_value_unref (old_secret);
+	secret_value_unref (new_secret);
+	g_object_unref (bus);
+}
+
+static void
+got_secret_service (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+	GTask *task = user_data;
+	PasswordUpdate *update = g_task_get_task_data (task);
+	GError *error = NULL;
+
+	update->service = secret_service_get_finish (result, &error);
+	if (update->service == NULL) {
+		g_prefix_error (&error, "Failed to get secret service: ");
+		finish_update (task, error);
+		return;
+	}
+
+	g_bus_get (G_BUS_TYPE_SESSION, NULL, got_session_bus, task);
+}
 
-	if (service)
-		g_object_unref (service);
-	if (bus)
-		g_object_unref (bus);
-	if (old_secret)
-		secret_value_unref (old_secret);
-	if (new_secret)
-		secret_value_unref (new_secret);
+static void
+start_next_update (void)
+{
+	GTask *task;
+	PasswordUpdate *update;
+	GError *error = NULL;
+
+	if (!gis_login_keyring_is_ready ())
+		return;
+
+	while (!update_running && (task = g_queue_pop_head (&pending_updates)) != NULL) {
+		if (g_task_return_error_if_cancelled (task)) {
+			g_object_unref (task);
+			continue;
+		}
+
+		update = g_task_get_task_data (task);
+
+		/* A later update in the queue makes this one redundant */
+		if (!g_queue_is_empty (&pending_updates)) {
+			g_set_error_literal (&error, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+			                     "Superseded by a later password change");
+			g_task_return_error (task, error);
+			error = NULL;
+			g_object_unref (task);
+			continue;
+		}
+
+		if (g_strcmp0 (update->new_password,
+		               keyring_password ? keyring_password : DUMMY_PWD) == 0) {
+			g_task_return_boolean (task, TRUE);
+			g_object_unref (task);
+			continue;
+		}
+
+		update_running = TRUE;
+		update->start_time = g_get_monotonic_time ();
+		secret_service_get (SECRET_SERVICE_OPEN_SESSION, NULL, got_secret_service, task);
+	}
+
+	wake_waiters ();
+}
+
+void
+gis_update_login_keyring_password_async (const gchar         *new_,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data)
+{
+	GTask *task;
+	PasswordUpdate *update;
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gis_update_login_keyring_password_async);
+
+	update = g_slice_new0 (PasswordUpdate);
+	update->new_password = g_strdup (new_);
+	g_task_set_task_data (task, update, (GDestroyNotify) password_update_free);
+
+	g_queue_push_tail (&pending_updates, task);
+	start_next_update ();
+}
+
+gboolean
+gis_update_login_keyring_password_finish (GAsyncResult  *result,
+                                          GError       **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/* GTasks from gis_wait_for_login_keyring_password_async() */
+static GQueue waiters = G_QUEUE_INIT;
+
+typedef struct {
+	guint timeout_id;
+	gint64 start_time;
+} PasswordWait;
+
+static void
+password_wait_free (PasswordWait *wait)
+{
+	if (wait->timeout_id != 0)
+		g_source_remove (wait->timeout_id);
+	g_slice_free (PasswordWait, wait);
+}
+
+static gboolean
+keyring_busy (void)
+{
+	return !gis_login_keyring_is_ready () ||
+	       update_running ||
+	       !g_queue_is_empty (&pending_updates);
+}
+
+static void
+wake_waiters (void)
+{
+	GTask *task;
+	PasswordWait *wait;
+
+	if (keyring_busy ())
+		return;
+
+	while ((task = g_queue_pop_head (&waiters)) != NULL) {
+		wait = g_task_get_task_data (task);
+		g_debug ("Waited %" G_GINT64_FORMAT " ms for the login keyring password change",
+		         (g_get_monotonic_time () - wait->start_time) / 1000);
+		g_task_return_boolean (task, TRUE);
+		g_object_unref (task);
+	}
+}
+
+static gboolean
+wait_timed_out (gpointer user_data)
+{
+	GTask *task = user_data;
+	PasswordWait *wait = g_task_get_task_data (task);
+
+	wait->timeout_id = 0;
+	g_queue_remove (&waiters, task);
+
+	g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+	                         "Timed out waiting for the login keyring password change");
+	g_object_unref (task);
+
+	return G_SOURCE_REMOVE;
+}
+
+/* Waits, without blocking, until the keyring is set up and all queued
+ * password changes have been applied. Fails with G_IO_ERROR_TIMED_OUT
+ * if that takes more than @timeout_ms. */
+void
+gis_wait_for_login_keyring_password_async (guint                timeout_ms,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data)
+{
+	GTask *task;
+	PasswordWait *wait;
+
+	task = g_task_new (NULL, cancellable, callback, user_data);
+	g_task_set_source_tag (task, gis_wait_for_login_keyring_password_async);
+
+	if (!keyring_busy ()) {
+		g_task_return_boolean (task, TRUE);
+		g_object_unref (task);
+		return;
+	}
+
+	wait = g_slice_new0 (PasswordWait);
+	wait->start_time = g_get_monotonic_time ();
+	wait->timeout_id = g_timeout_add (timeout_ms, wait_timed_out, task);
+	g_task_set_task_data (task, wait, (GDestroyNotify) password_wait_free);
+
+	g_queue_push_tail (&waiters, task);
+}
+
+gboolean
+gis_wait_for_login_keyring_password_finish (GAsyncResult  *result,
+                                            GError       **error)
+{
+	g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+	return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+update_done (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+	GError *error = NULL;
+
+	if (!gis_update_login_keyring_password_finish (result, &error)) {
+		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+			g_warning ("Failed to change keyring password: %s", error->message);
+		g_error_free (error);
+	}
+}
+
+/* Queues the change without waiting for it; use
+ * gis_wait_for_login_keyring_password_async() before relying on it. */
+void
+gis_update_login_keyring_password (const gchar *new_)
+{
+	gis_update_login_keyring_password_async (new_, NULL, update_done, NULL);
 }
@@ -24,12 +24,27 @@
 #define __GIS_KEYRING_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
 G_BEGIN_DECLS
 
 void	gis_ensure_login_keyring	  ();
+gboolean gis_login_keyring_is_ready	  (void);
 void	gis_update_login_keyring_password (const gchar *new_);
 
+void	gis_update_login_keyring_password_async  (const gchar         *new_,
+						  GCancellable        *cancellable,
+						  GAsyncReadyCallback  callback,
+						  gpointer             user_data);
+gboolean gis_update_login_keyring_password_finish (GAsyncResult  *result,
+						  GError       **error);
+void	gis_wait_for_login_keyring_password_async  (guint                timeout_ms,
+						    GCancellable        *cancellable,
+						    GAsyncReadyCallback  callback,
+						    gpointer             user_data);
+gboolean gis_wait_for_login_keyring_password_finish (GAsyncResult  *result,
+						    GError       **error);
+
 G_END_DECLS
 
 #endif /* __GIS_KEYRING_H__ */
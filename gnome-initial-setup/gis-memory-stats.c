@@ -0,0 +1,249 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Accounts for the memory each page takes, so that what pages keep
+ * after the user has gone past them can be kept down.
+ *
+ * It is off unless GIS_MEMORY_STATS is set to the file to write to:
+ *
+ *   GIS_MEMORY_STATS=/tmp/gis-memory.json gnome-initial-setup
+ *
+ * The resident set size of the process is taken before and after a
+ * page is built, and before and after it releases and restores its
+ * resources. On exit, what each page grew the process by or gave back
+ * is written out, with the peak and final resident set sizes.
+ *
+ * Other work may be going on in the main loop at the same time, and
+ * memory handed back to malloc is not always handed back to the
+ * system, so the numbers are indicative rather than exact.
+ */
+
+#include "config.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <json-glib/json-glib.h>
+
+#include "gis-memory-stats.h"
+
+typedef struct {
+  gchar *name;
+  /* in bytes */
+  gint64 built;
+  gint64 released;
+  gint64 restored;
+  guint releases;
+  guint restores;
+} PageMemory;
+
+static gchar *stats_file;
+/* PageMemory, in the order the pages were built */
+static GPtrArray *pages;
+
+static void
+page_memory_free (PageMemory *page)
+{
+  g_free (page->name);
+  g_slice_free (PageMemory, page);
+}
+
+static PageMemory *
+ensure_page (const gchar *name)
+{
+  PageMemory *page;
+  guint i;
+
+  for (i = 0; i < pages->len; i++)
+    {
+      page = g_ptr_array_index (pages, i);
+      if (g_strcmp0 (page->name, name) == 0)
+        return page;
+    }
+
+  page = g_slice_new0 (PageMemory);
+  page->name = g_strdup (name);
+  g_ptr_array_add (pages, page);
+
+  return page;
+}
+
+static gint64
+get_rss (void)
+{
+  gchar *contents;
+  gchar **fields;
+  gint64 rss = 0;
+
+  /* Sizes in pages: total, resident, ... */
+  if (!g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    return 0;
+
+  fields = g_strsplit (contents, " ", 3);
+  if (fields[0] != NULL && fields[1] != NULL)
+    rss = g_ascii_strtoll (fields[1], NULL, 10) * sysconf (_SC_PAGESIZE);
+
+  g_strfreev (fields);
+  g_free (contents);
+
+  return rss;
+}
+
+void
+gis_memory_stats_init (void)
+{
+  const gchar *path;
+
+  path = g_getenv ("GIS_MEMORY_STATS");
+  if (path == NULL || *path == '\0' || stats_file != NULL)
+    return;
+
+  stats_file = g_strdup (path);
+  pages = g_ptr_array_new_with_free_func ((GDestroyNotify) page_memory_free);
+}
+
+/**
+ * gis_memory_stats_begin:
+ *
+ * Returns: the resident set size, to pass to gis_memory_stats_end(),
+ *   or 0 if memory accounting is off
+ */
+gint64
+gis_memory_stats_begin (void)
+{
+  if (stats_file == NULL)
+    return 0;
+
+  return get_rss ();
+}
+
+/**
+ * gis_memory_stats_end:
+ * @begin_rss: what gis_memory_stats_begin() returned
+ * @page_id: the ID of the page
+ * @event: what the page did since gis_memory_stats_begin()
+ *
+ * Puts the change in the resident set size since @begin_rss down to
+ * @page_id having done @event.
+ */
+void
+gis_memory_stats_end (gint64               begin_rss,
+                      const gchar         *page_id,
+                      GisMemoryStatsEvent  event)
+{
+  PageMemory *page;
+  gint64 end_rss;
+
+  if (stats_file == NULL || begin_rss == 0)
+    return;
+
+  end_rss = get_rss ();
+  if (end_rss == 0)
+    return;
+
+  page = ensure_page (page_id);
+
+  switch (event)
+    {
+    case GIS_MEMORY_STATS_BUILD:
+      page->built += end_rss - begin_rss;
+      break;
+    case GIS_MEMORY_STATS_RELEASE:
+      page->released += begin_rss - end_rss;
+      page->releases++;
+      break;
+    case GIS_MEMORY_STATS_RESTORE:
+      page->restored += end_rss - begin_rss;
+      page->restores++;
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+add_page (JsonBuilder *builder,
+          PageMemory  *page)
+{
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "name");
+  json_builder_add_string_value (builder, page->name);
+  json_builder_set_member_name (builder, "built_kb");
+  json_builder_add_int_value (builder, page->built / 1024);
+  json_builder_set_member_name (builder, "released_kb");
+  json_builder_add_int_value (builder, page->released / 1024);
+  json_builder_set_member_name (builder, "releases");
+  json_builder_add_int_value (builder, page->releases);
+  json_builder_set_member_name (builder, "restored_kb");
+  json_builder_add_int_value (builder, page->restored / 1024);
+  json_builder_set_member_name (builder, "restores");
+  json_builder_add_int_value (builder, page->restores);
+  json_builder_end_object (builder);
+}
+
+void
+gis_memory_stats_shutdown (void)
+{
+  JsonBuilder *builder;
+  JsonGenerator *generator;
+  JsonNode *root;
+  struct rusage usage;
+  GError *error = NULL;
+  guint i;
+
+  if (stats_file == NULL)
+    return;
+
+  builder = json_builder_new ();
+  json_builder_begin_object (builder);
+
+  /* ru_maxrss is in kilobytes already */
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    {
+      json_builder_set_member_name (builder, "peak_rss_kb");
+      json_builder_add_int_value (builder, usage.ru_maxrss);
+    }
+  json_builder_set_member_name (builder, "final_rss_kb");
+  json_builder_add_int_value (builder, get_rss () / 1024);
+
+  json_builder_set_member_name (builder, "pages");
+  json_builder_begin_array (builder);
+  for (i = 0; i < pages->len; i++)
+    add_page (builder, g_ptr_array_index (pages, i));
+  json_builder_end_array (builder);
+
+  json_builder_end_object (builder);
+
+  root = json_builder_get_root (builder);
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, TRUE);
+  json_generator_set_root (generator, root);
+
+  if (!json_generator_to_file (generator, stats_file, &error))
+    {
+      g_warning ("Could not write memory statistics to %s: %s", stats_file, error->message);
+      g_error_free (error);
+    }
+
+  g_object_unref (generator);
+  json_node_unref (root);
+  g_object_unref (builder);
+
+  g_clear_pointer (&pages, g_ptr_array_unref);
+  g_clear_pointer (&stats_file, g_free);
+}
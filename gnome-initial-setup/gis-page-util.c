@@ -30,7 +30,6 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
-#include <polkit/polkit.h>
 #include <sys/types.h>
 #include <zint.h>
 
@@ -290,13 +289,15 @@ get_product_id (void)
 }
 
 static void
-system_poweroff (gpointer data)
+poweroff_permission_ready (GObject      *source,
+                           GAsyncResult *res,
+                           gpointer      data)
 {
   GDBusConnection *bus;
   GError *error = NULL;
   GPermission *permission;
 
-  permission = polkit_permission_new_sync ("org.freedesktop.login1.power-off", NULL, NULL, &error);
+  permission = gis_permission_cache_get_finish (GIS_PERMISSION_CACHE (source), res, &error);
   if (error) {
     g_warning ("Failed getting permission to power off: %s", error->message);
     g_error_free (error);
@@ -329,6 +330,18 @@ system_poweroff (gpointer data)
   g_object_unref (bus);
 }
 
+static void
+system_poweroff (gpointer data)
+{
+  GisDriver *driver = data;
+
+  gis_permission_cache_get_async (gis_driver_get_permission_cache (driver),
+                                  "org.freedesktop.login1.power-off",
+                                  NULL,
+                                  poweroff_permission_ready,
+                                  NULL);
+}
+
 static void
 system_testmode (GtkButton *button, gpointer data)
 {
@@ -426,7 +439,9 @@ gis_page_util_show_factory_dialog (GisPage *page)
   g_free (sd_text);
 
   g_signal_connect_swapped (poweroff_button, "clicked",
-                            G_CALLBACK (system_poweroff), NULL);
+                            G_CALLBACK (system_poweroff), driver);
+  gis_permission_cache_prefetch (gis_driver_get_permission_cache (driver),
+                                 "org.freedesktop.login1.power-off");
   g_signal_connect (testmode_button, "clicked",
                     G_CALLBACK (system_testmode), factory_dialog);
 
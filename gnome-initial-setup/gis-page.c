@@ -36,10 +36,15 @@ struct _GisPagePrivate
   GisPageApplyCallback apply_cb;
   gpointer apply_data;
 
+  gint64 construct_start_time;
+  gint64 construct_time;
+  gint64 apply_trace_time;
+
   guint complete : 1;
   guint skippable : 1;
   guint needs_accept : 1;
-  guint padding : 5;
+  guint released : 1;
+  guint padding : 4;
 };
 typedef struct _GisPagePrivate GisPagePrivate;
 
@@ -189,6 +194,26 @@ gis_page_constructed (GObject *object)
 
 }
 
+static void
+gis_page_parent_set (GtkWidget *widget,
+                     GtkWidget *previous_parent)
+{
+  GisPage *page = GIS_PAGE (widget);
+  GisPagePrivate *priv = gis_page_get_instance_private (page);
+
+  /* Pages are added to the assistant as soon as they are constructed */
+  if (priv->construct_start_time != 0)
+    {
+      priv->construct_time = g_get_monotonic_time () - priv->construct_start_time;
+      gis_trace_end (priv->construct_start_time, "page", "%s constructed",
+                     GIS_PAGE_GET_CLASS (page)->page_id);
+      priv->construct_start_time = 0;
+    }
+
+  if (GTK_WIDGET_CLASS (gis_page_parent_class)->parent_set)
+    GTK_WIDGET_CLASS (gis_page_parent_class)->parent_set (widget, previous_parent);
+}
+
 static gboolean
 gis_page_real_apply (GisPage      *page,
                      GCancellable *cancellable)
@@ -200,6 +225,7 @@ static void
 gis_page_class_init (GisPageClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
 
   object_class->constructed = gis_page_constructed;
   object_class->dispose = gis_page_dispose;
@@ -207,6 +233,8 @@ gis_page_class_init (GisPageClass *klass)
   object_class->get_property = gis_page_get_property;
   object_class->set_property = gis_page_set_property;
 
+  widget_class->parent_set = gis_page_parent_set;
+
   klass->apply = gis_page_real_apply;
 
   obj_props[PROP_DRIVER] =
@@ -244,6 +272,10 @@ gis_page_class_init (GisPageClass *klass)
 static void
 gis_page_init (GisPage *page)
 {
+  GisPagePrivate *priv = gis_page_get_instance_private (page);
+
+  priv->construct_start_time = g_get_monotonic_time ();
+
   gtk_widget_set_margin_start (GTK_WIDGET (page), 12);
   gtk_widget_set_margin_top (GTK_WIDGET (page), 12);
   gtk_widget_set_margin_bottom (GTK_WIDGET (page), 12);
@@ -357,7 +389,7 @@ void
 gis_page_locale_changed (GisPage *page)
 {
   if (GIS_PAGE_GET_CLASS (page)->locale_changed)
-    return GIS_PAGE_GET_CLASS (page)->locale_changed (page);
+    GIS_PAGE_GET_CLASS (page)->locale_changed (page);
 }
 
 void
@@ -377,6 +409,7 @@ gis_page_apply_begin (GisPage                *page,
   priv->apply_data = user_data;
   priv->apply_cancel = g_cancellable_new ();
   priv->applying = TRUE;
+  priv->apply_trace_time = gis_trace_begin ();
 
   if (!klass->apply (page, priv->apply_cancel))
     {
@@ -405,6 +438,8 @@ gis_page_apply_complete (GisPage *page,
 
   g_clear_object (&priv->apply_cancel);
   priv->applying = FALSE;
+  gis_trace_end (priv->apply_trace_time, "page", "%s apply",
+                 GIS_PAGE_GET_CLASS (page)->page_id);
   g_object_notify_by_pspec (G_OBJECT (page), obj_props[PROP_APPLYING]);
 
   if (callback)
@@ -418,6 +453,20 @@ gis_page_get_applying (GisPage *page)
   return priv->applying;
 }
 
+/**
+ * gis_page_get_construct_time:
+ * @page: a #GisPage
+ *
+ * Returns: how long @page took to be constructed and added to the
+ *   assistant, in microseconds, or 0 if it has not been added yet
+ */
+gint64
+gis_page_get_construct_time (GisPage *page)
+{
+  GisPagePrivate *priv = gis_page_get_instance_private (page);
+  return priv->construct_time;
+}
+
 void
 gis_page_apply_cancel (GisPage *page)
 {
@@ -428,13 +477,127 @@ gis_page_apply_cancel (GisPage *page)
 void
 gis_page_save_data (GisPage *page)
 {
+  gint64 trace_time;
+
   if (GIS_PAGE_GET_CLASS (page)->save_data)
-    GIS_PAGE_GET_CLASS (page)->save_data (page);
+    {
+      trace_time = gis_trace_begin ();
+      GIS_PAGE_GET_CLASS (page)->save_data (page);
+      gis_trace_end (trace_time, "page", "%s save_data",
+                     GIS_PAGE_GET_CLASS (page)->page_id);
+    }
 }
 
 void
 gis_page_shown (GisPage *page)
 {
+  gint64 trace_time;
+
   if (GIS_PAGE_GET_CLASS (page)->shown)
-    GIS_PAGE_GET_CLASS (page)->shown (page);
+    {
+      trace_time = gis_trace_begin ();
+      GIS_PAGE_GET_CLASS (page)->shown (page);
+      gis_trace_end (trace_time, "page", "%s shown",
+                     GIS_PAGE_GET_CLASS (page)->page_id);
+    }
+}
+
+/**
+ * gis_page_apply_answers:
+ * @page: a #GisPage
+ * @answers: the answer file
+ * @error: return location for a #GError
+ *
+ * Fills in @page from the group of @answers named after its page ID,
+ * as if the user had done so. Pages without such a group are left
+ * as they are.
+ *
+ * Returns: %FALSE if the answers could not be used
+ */
+gboolean
+gis_page_apply_answers (GisPage   *page,
+                        GKeyFile  *answers,
+                        GError   **error)
+{
+  GisPageClass *klass = GIS_PAGE_GET_CLASS (page);
+  gint64 trace_time;
+  gboolean ret;
+
+  if (!g_key_file_has_group (answers, klass->page_id))
+    return TRUE;
+
+  if (klass->apply_answers == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                   "Page %s does not take answers", klass->page_id);
+      return FALSE;
+    }
+
+  trace_time = gis_trace_begin ();
+  ret = klass->apply_answers (page, answers, klass->page_id, error);
+  gis_trace_end (trace_time, "page", "%s apply_answers", klass->page_id);
+
+  return ret;
+}
+
+/**
+ * gis_page_release_resources:
+ * @page: a #GisPage
+ *
+ * Lets @page drop what it only needs while it is shown, such as large
+ * images and long lists, once the user has gone on past it and it is
+ * done applying. Does nothing if it has already done so.
+ *
+ * Returns: %TRUE if @page released anything
+ */
+gboolean
+gis_page_release_resources (GisPage *page)
+{
+  GisPageClass *klass = GIS_PAGE_GET_CLASS (page);
+  GisPagePrivate *priv = gis_page_get_instance_private (page);
+  gint64 trace_time, rss;
+
+  g_return_val_if_fail (!priv->applying, FALSE);
+
+  if (priv->released || klass->release_resources == NULL)
+    return FALSE;
+
+  trace_time = gis_trace_begin ();
+  rss = gis_memory_stats_begin ();
+
+  klass->release_resources (page);
+  priv->released = TRUE;
+
+  gis_memory_stats_end (rss, klass->page_id, GIS_MEMORY_STATS_RELEASE);
+  gis_trace_end (trace_time, "page", "%s release_resources", klass->page_id);
+
+  return TRUE;
+}
+
+/**
+ * gis_page_restore_resources:
+ * @page: a #GisPage
+ *
+ * Gets back what gis_page_release_resources() dropped, before @page is
+ * shown again.
+ */
+void
+gis_page_restore_resources (GisPage *page)
+{
+  GisPageClass *klass = GIS_PAGE_GET_CLASS (page);
+  GisPagePrivate *priv = gis_page_get_instance_private (page);
+  gint64 trace_time, rss;
+
+  if (!priv->released)
+    return;
+
+  trace_time = gis_trace_begin ();
+  rss = gis_memory_stats_begin ();
+
+  if (klass->restore_resources != NULL)
+    klass->restore_resources (page);
+  priv->released = FALSE;
+
+  gis_memory_stats_end (rss, klass->page_id, GIS_MEMORY_STATS_RESTORE);
+  gis_trace_end (trace_time, "page", "%s restore_resources", klass->page_id);
 }
@@ -57,12 +57,25 @@ struct _GisPageClass
   GtkBinClass parent_class;
   char *page_id;
 
+  /* Set if nothing on later pages depends on apply having finished, so
+   * that the assistant can move on while it runs. */
+  gboolean apply_in_background;
+
   void         (*locale_changed) (GisPage *page);
   GtkAccelGroup * (*get_accel_group) (GisPage *page);
   gboolean     (*apply) (GisPage *page,
                          GCancellable *cancellable);
   void         (*save_data) (GisPage *page);
   void         (*shown) (GisPage *page);
+  gboolean     (*apply_answers) (GisPage      *page,
+                                 GKeyFile     *answers,
+                                 const gchar  *group,
+                                 GError      **error);
+
+  /* Drop what is only needed while the page is shown, once the user
+   * has gone on past it, and get it back if they come back to it. */
+  void         (*release_resources) (GisPage *page);
+  void         (*restore_resources) (GisPage *page);
 };
 
 GType gis_page_get_type (void);
@@ -86,8 +99,12 @@ void         gis_page_apply_begin (GisPage *page, GisPageApplyCallback callback,
 void         gis_page_apply_cancel (GisPage *page);
 void         gis_page_apply_complete (GisPage *page, gboolean valid);
 gboolean     gis_page_get_applying (GisPage *page);
+gint64       gis_page_get_construct_time (GisPage *page);
 void         gis_page_save_data (GisPage *page);
 void         gis_page_shown (GisPage *page);
+gboolean     gis_page_apply_answers (GisPage *page, GKeyFile *answers, GError **error);
+gboolean     gis_page_release_resources (GisPage *page);
+void         gis_page_restore_resources (GisPage *page);
 
 G_END_DECLS
 
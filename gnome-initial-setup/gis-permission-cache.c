@@ -0,0 +1,176 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Looks up polkit permissions without blocking, once per action.
+ *
+ * The driver prefetches the actions the pages are known to need when
+ * it starts, so the lookups run in parallel with building the first
+ * pages; by the time a page asks, the answer is usually there already.
+ * Everybody who asks for the same action gets the same GPermission,
+ * which keeps itself up to date as the authorization changes.
+ */
+
+#include "config.h"
+
+#include <polkit/polkit.h>
+
+#include "gis-permission-cache.h"
+#include "gis-shared-result.h"
+
+struct _GisPermissionCachePrivate
+{
+  /* action ID to GisSharedResult */
+  GHashTable *entries;
+};
+typedef struct _GisPermissionCachePrivate GisPermissionCachePrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GisPermissionCache, gis_permission_cache, G_TYPE_OBJECT);
+
+static void
+permission_ready (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  GisSharedResult *entry = user_data;
+  GPermission *permission;
+  GError *error = NULL;
+
+  permission = polkit_permission_new_finish (result, &error);
+  if (permission == NULL)
+    g_warning ("Could not look up permission for %s: %s",
+               gis_shared_result_get_name (entry), error->message);
+
+  gis_shared_result_resolve (entry, permission, error);
+}
+
+static GisSharedResult *
+ensure_entry (GisPermissionCache *cache,
+              const gchar        *action_id)
+{
+  GisPermissionCachePrivate *priv = gis_permission_cache_get_instance_private (cache);
+  GisSharedResult *entry;
+
+  entry = g_hash_table_lookup (priv->entries, action_id);
+  if (entry != NULL)
+    return entry;
+
+  entry = gis_shared_result_new (G_OBJECT (cache), action_id);
+  g_hash_table_insert (priv->entries, g_strdup (action_id), entry);
+
+  polkit_permission_new (action_id, NULL, NULL,
+                         permission_ready, entry);
+
+  return entry;
+}
+
+/**
+ * gis_permission_cache_prefetch:
+ * @cache: a #GisPermissionCache
+ * @action_id: the polkit action
+ *
+ * Starts looking up the permission for @action_id, if that hasn't
+ * been done already, so that a later gis_permission_cache_get_async()
+ * need not wait.
+ */
+void
+gis_permission_cache_prefetch (GisPermissionCache *cache,
+                               const gchar        *action_id)
+{
+  g_return_if_fail (GIS_IS_PERMISSION_CACHE (cache));
+
+  ensure_entry (cache, action_id);
+}
+
+/**
+ * gis_permission_cache_get_async:
+ * @cache: a #GisPermissionCache
+ * @action_id: the polkit action
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called once the permission is known
+ * @user_data: data for @callback
+ *
+ * Gets the permission for @action_id for this process, looking it up
+ * first if it hasn't been yet.
+ */
+void
+gis_permission_cache_get_async (GisPermissionCache  *cache,
+                                const gchar         *action_id,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (GIS_IS_PERMISSION_CACHE (cache));
+
+  task = g_task_new (cache, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gis_permission_cache_get_async);
+
+  gis_shared_result_return (ensure_entry (cache, action_id), task);
+  g_object_unref (task);
+}
+
+/**
+ * gis_permission_cache_get_finish:
+ *
+ * Returns: (transfer full): the permission, or %NULL if it could not
+ *   be looked up
+ */
+GPermission *
+gis_permission_cache_get_finish (GisPermissionCache  *cache,
+                                 GAsyncResult        *result,
+                                 GError             **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, cache), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+gis_permission_cache_finalize (GObject *object)
+{
+  GisPermissionCache *cache = GIS_PERMISSION_CACHE (object);
+  GisPermissionCachePrivate *priv = gis_permission_cache_get_instance_private (cache);
+
+  g_hash_table_unref (priv->entries);
+
+  G_OBJECT_CLASS (gis_permission_cache_parent_class)->finalize (object);
+}
+
+static void
+gis_permission_cache_class_init (GisPermissionCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gis_permission_cache_finalize;
+}
+
+static void
+gis_permission_cache_init (GisPermissionCache *cache)
+{
+  GisPermissionCachePrivate *priv = gis_permission_cache_get_instance_private (cache);
+
+  priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify) gis_shared_result_free);
+}
+
+GisPermissionCache *
+gis_permission_cache_new (void)
+{
+  return g_object_new (GIS_TYPE_PERMISSION_CACHE, NULL);
+}
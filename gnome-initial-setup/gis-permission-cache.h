@@ -0,0 +1,64 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_PERMISSION_CACHE_H__
+#define __GIS_PERMISSION_CACHE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GIS_TYPE_PERMISSION_CACHE               (gis_permission_cache_get_type ())
+#define GIS_PERMISSION_CACHE(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIS_TYPE_PERMISSION_CACHE, GisPermissionCache))
+#define GIS_PERMISSION_CACHE_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass),  GIS_TYPE_PERMISSION_CACHE, GisPermissionCacheClass))
+#define GIS_IS_PERMISSION_CACHE(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIS_TYPE_PERMISSION_CACHE))
+#define GIS_IS_PERMISSION_CACHE_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIS_TYPE_PERMISSION_CACHE))
+#define GIS_PERMISSION_CACHE_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIS_TYPE_PERMISSION_CACHE, GisPermissionCacheClass))
+
+typedef struct _GisPermissionCache        GisPermissionCache;
+typedef struct _GisPermissionCacheClass   GisPermissionCacheClass;
+
+struct _GisPermissionCache
+{
+  GObject parent;
+};
+
+struct _GisPermissionCacheClass
+{
+  GObjectClass parent_class;
+};
+
+GType gis_permission_cache_get_type (void);
+
+GisPermissionCache *gis_permission_cache_new (void);
+
+void         gis_permission_cache_prefetch   (GisPermissionCache  *cache,
+                                              const gchar         *action_id);
+
+void         gis_permission_cache_get_async  (GisPermissionCache  *cache,
+                                              const gchar         *action_id,
+                                              GCancellable        *cancellable,
+                                              GAsyncReadyCallback  callback,
+                                              gpointer             user_data);
+GPermission *gis_permission_cache_get_finish (GisPermissionCache  *cache,
+                                              GAsyncResult        *result,
+                                              GError             **error);
+
+G_END_DECLS
+
+#endif /* __GIS_PERMISSION_CACHE_H__ */
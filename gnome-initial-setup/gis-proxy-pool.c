@@ -0,0 +1,196 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Proxies for system bus services, made once and shared.
+ *
+ * Several pages talk to the same service, and pages are only built
+ * when the user gets near them; asking the pool instead of making a
+ * proxy in each page means the pages share one proxy, and its cache of
+ * the service's properties, whenever they are built. Proxies are only
+ * ever made asynchronously.
+ */
+
+#include "config.h"
+
+#include "gis-proxy-pool.h"
+#include "gis-shared-result.h"
+
+struct _GisProxyPoolPrivate
+{
+  /* "bus name object path interface" to GisSharedResult */
+  GHashTable *entries;
+};
+typedef struct _GisProxyPoolPrivate GisProxyPoolPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GisProxyPool, gis_proxy_pool, G_TYPE_OBJECT);
+
+static void
+proxy_ready (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  GisSharedResult *entry = user_data;
+  GDBusProxy *proxy;
+  GError *error = NULL;
+
+  proxy = g_dbus_proxy_new_for_bus_finish (result, &error);
+  if (proxy == NULL)
+    g_warning ("Could not make a proxy for %s: %s",
+               gis_shared_result_get_name (entry), error->message);
+
+  gis_shared_result_resolve (entry, proxy, error);
+}
+
+static GisSharedResult *
+ensure_entry (GisProxyPool *pool,
+              const gchar  *bus_name,
+              const gchar  *object_path,
+              const gchar  *interface_name)
+{
+  GisProxyPoolPrivate *priv = gis_proxy_pool_get_instance_private (pool);
+  GisSharedResult *entry;
+  gchar *key;
+
+  key = g_strjoin (" ", bus_name, object_path, interface_name, NULL);
+  entry = g_hash_table_lookup (priv->entries, key);
+  if (entry != NULL)
+    {
+      g_free (key);
+      return entry;
+    }
+
+  entry = gis_shared_result_new (G_OBJECT (pool), key);
+  g_hash_table_insert (priv->entries, key, entry);
+
+  /* Keep the cached properties complete, since that is what the pages
+   * read */
+  g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
+                            G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
+                            NULL,
+                            bus_name,
+                            object_path,
+                            interface_name,
+                            NULL,
+                            proxy_ready, entry);
+
+  return entry;
+}
+
+/**
+ * gis_proxy_pool_prefetch:
+ * @pool: a #GisProxyPool
+ * @bus_name: the system bus service
+ * @object_path: the object to make a proxy for
+ * @interface_name: the interface of the proxy
+ *
+ * Starts making the proxy, if that hasn't been done already, so that
+ * a later gis_proxy_pool_get_async() need not wait.
+ */
+void
+gis_proxy_pool_prefetch (GisProxyPool *pool,
+                         const gchar  *bus_name,
+                         const gchar  *object_path,
+                         const gchar  *interface_name)
+{
+  g_return_if_fail (GIS_IS_PROXY_POOL (pool));
+
+  ensure_entry (pool, bus_name, object_path, interface_name);
+}
+
+/**
+ * gis_proxy_pool_get_async:
+ * @pool: a #GisProxyPool
+ * @bus_name: the system bus service
+ * @object_path: the object to make a proxy for
+ * @interface_name: the interface of the proxy
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called once the proxy is ready
+ * @user_data: data for @callback
+ *
+ * Gets the shared proxy for @interface_name on @object_path, making it
+ * first if nobody has asked for it yet.
+ */
+void
+gis_proxy_pool_get_async (GisProxyPool        *pool,
+                          const gchar         *bus_name,
+                          const gchar         *object_path,
+                          const gchar         *interface_name,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+  GTask *task;
+
+  g_return_if_fail (GIS_IS_PROXY_POOL (pool));
+
+  task = g_task_new (pool, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gis_proxy_pool_get_async);
+
+  gis_shared_result_return (ensure_entry (pool, bus_name, object_path, interface_name), task);
+  g_object_unref (task);
+}
+
+/**
+ * gis_proxy_pool_get_finish:
+ *
+ * Returns: (transfer full): the proxy, or %NULL if it could not be
+ *   made
+ */
+GDBusProxy *
+gis_proxy_pool_get_finish (GisProxyPool  *pool,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, pool), NULL);
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+gis_proxy_pool_finalize (GObject *object)
+{
+  GisProxyPool *pool = GIS_PROXY_POOL (object);
+  GisProxyPoolPrivate *priv = gis_proxy_pool_get_instance_private (pool);
+
+  g_hash_table_unref (priv->entries);
+
+  G_OBJECT_CLASS (gis_proxy_pool_parent_class)->finalize (object);
+}
+
+static void
+gis_proxy_pool_class_init (GisProxyPoolClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gis_proxy_pool_finalize;
+}
+
+static void
+gis_proxy_pool_init (GisProxyPool *pool)
+{
+  GisProxyPoolPrivate *priv = gis_proxy_pool_get_instance_private (pool);
+
+  priv->entries = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free, (GDestroyNotify) gis_shared_result_free);
+}
+
+GisProxyPool *
+gis_proxy_pool_new (void)
+{
+  return g_object_new (GIS_TYPE_PROXY_POOL, NULL);
+}
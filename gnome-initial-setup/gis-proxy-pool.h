@@ -0,0 +1,68 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_PROXY_POOL_H__
+#define __GIS_PROXY_POOL_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GIS_TYPE_PROXY_POOL               (gis_proxy_pool_get_type ())
+#define GIS_PROXY_POOL(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIS_TYPE_PROXY_POOL, GisProxyPool))
+#define GIS_PROXY_POOL_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass),  GIS_TYPE_PROXY_POOL, GisProxyPoolClass))
+#define GIS_IS_PROXY_POOL(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIS_TYPE_PROXY_POOL))
+#define GIS_IS_PROXY_POOL_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIS_TYPE_PROXY_POOL))
+#define GIS_PROXY_POOL_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIS_TYPE_PROXY_POOL, GisProxyPoolClass))
+
+typedef struct _GisProxyPool        GisProxyPool;
+typedef struct _GisProxyPoolClass   GisProxyPoolClass;
+
+struct _GisProxyPool
+{
+  GObject parent;
+};
+
+struct _GisProxyPoolClass
+{
+  GObjectClass parent_class;
+};
+
+GType gis_proxy_pool_get_type (void);
+
+GisProxyPool *gis_proxy_pool_new (void);
+
+void        gis_proxy_pool_prefetch   (GisProxyPool        *pool,
+                                       const gchar         *bus_name,
+                                       const gchar         *object_path,
+                                       const gchar         *interface_name);
+
+void        gis_proxy_pool_get_async  (GisProxyPool        *pool,
+                                       const gchar         *bus_name,
+                                       const gchar         *object_path,
+                                       const gchar         *interface_name,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data);
+GDBusProxy *gis_proxy_pool_get_finish (GisProxyPool        *pool,
+                                       GAsyncResult        *result,
+                                       GError             **error);
+
+G_END_DECLS
+
+#endif /* __GIS_PROXY_POOL_H__ */
@@ -0,0 +1,474 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Collects the system-wide settings chosen on the pages (the system
+ * locale, keyboard layout and timezone) and applies them all at once,
+ * when setup is done.
+ *
+ * Each setting is a single method call on a system bus service, named
+ * by a key. Choosing a setting again replaces the call that is still
+ * pending for its key, so browsing through languages or timezones costs
+ * nothing until commit. On commit all pending calls are made in
+ * parallel, and the result of each is kept by key.
+ */
+
+#include "config.h"
+
+#include "gis-settings-transaction.h"
+
+typedef enum {
+  ITEM_PENDING,
+  ITEM_IN_FLIGHT,
+  ITEM_DONE,
+} ItemState;
+
+typedef struct {
+  GisSettingsTransaction *transaction;
+  gchar *key;
+  gchar *bus_name;
+  gchar *object_path;
+  gchar *interface_name;
+  gchar *method_name;
+  GVariant *parameters;
+
+  ItemState state;
+  GError *error;
+} Item;
+
+struct _GisSettingsTransactionPrivate
+{
+  /* in the order they were set */
+  GPtrArray *items;
+  guint in_flight;
+
+  GDBusConnection *connection;
+  gboolean getting_connection;
+
+  /* commits waiting for the calls in flight */
+  GList *tasks;
+};
+typedef struct _GisSettingsTransactionPrivate GisSettingsTransactionPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GisSettingsTransaction, gis_settings_transaction, G_TYPE_OBJECT);
+
+static void
+item_free (Item *item)
+{
+  g_free (item->key);
+  g_free (item->bus_name);
+  g_free (item->object_path);
+  g_free (item->interface_name);
+  g_free (item->method_name);
+  g_variant_unref (item->parameters);
+  g_clear_error (&item->error);
+  g_slice_free (Item, item);
+}
+
+/* Drops what is pending or done for @key; a call in flight finishes,
+ * and is dropped once it does, in favour of the newer one. */
+static void
+remove_items (GisSettingsTransaction *transaction,
+              const gchar            *key)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i = 0;
+
+  while (i < priv->items->len)
+    {
+      Item *item = g_ptr_array_index (priv->items, i);
+
+      if (item->state != ITEM_IN_FLIGHT && g_str_equal (item->key, key))
+        g_ptr_array_remove_index (priv->items, i);
+      else
+        i++;
+    }
+}
+
+static Item *
+find_item (GisSettingsTransaction *transaction,
+           const gchar            *key)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i;
+
+  /* The newest one is the one that counts */
+  for (i = priv->items->len; i > 0; i--)
+    {
+      Item *item = g_ptr_array_index (priv->items, i - 1);
+
+      if (g_str_equal (item->key, key))
+        return item;
+    }
+
+  return NULL;
+}
+
+/**
+ * gis_settings_transaction_set_call:
+ * @transaction: a #GisSettingsTransaction
+ * @key: what the call sets, such as "locale"
+ * @bus_name: the system bus service to call
+ * @object_path: the object to call the method on
+ * @interface_name: the interface of the method
+ * @method_name: the method
+ * @parameters: (transfer floating): the arguments of the method
+ *
+ * Queues a method call to be made on commit, replacing any earlier
+ * call for @key that has not been made yet.
+ */
+void
+gis_settings_transaction_set_call (GisSettingsTransaction *transaction,
+                                   const gchar            *key,
+                                   const gchar            *bus_name,
+                                   const gchar            *object_path,
+                                   const gchar            *interface_name,
+                                   const gchar            *method_name,
+                                   GVariant               *parameters)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  Item *item;
+
+  g_return_if_fail (GIS_IS_SETTINGS_TRANSACTION (transaction));
+
+  remove_items (transaction, key);
+
+  item = g_slice_new0 (Item);
+  item->transaction = transaction;
+  item->key = g_strdup (key);
+  item->bus_name = g_strdup (bus_name);
+  item->object_path = g_strdup (object_path);
+  item->interface_name = g_strdup (interface_name);
+  item->method_name = g_strdup (method_name);
+  item->parameters = g_variant_ref_sink (parameters);
+  item->state = ITEM_PENDING;
+
+  g_ptr_array_add (priv->items, item);
+}
+
+static gboolean
+has_failures (GisSettingsTransaction *transaction,
+              GError                **error)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i, n_failed = 0;
+  Item *first = NULL;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      Item *item = g_ptr_array_index (priv->items, i);
+
+      if (item->state == ITEM_DONE && item->error != NULL)
+        {
+          if (first == NULL)
+            first = item;
+          n_failed++;
+        }
+    }
+
+  if (first == NULL)
+    return FALSE;
+
+  g_set_error (error, first->error->domain, first->error->code,
+               "Could not set %s (%u settings failed): %s",
+               first->key, n_failed, first->error->message);
+  return TRUE;
+}
+
+static void
+complete_tasks (GisSettingsTransaction *transaction)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  GList *tasks, *l;
+
+  if (priv->in_flight > 0 || priv->getting_connection)
+    return;
+
+  tasks = priv->tasks;
+  priv->tasks = NULL;
+
+  for (l = tasks; l != NULL; l = l->next)
+    {
+      GTask *task = l->data;
+      GError *error = NULL;
+
+      if (has_failures (transaction, &error))
+        g_task_return_error (task, error);
+      else
+        g_task_return_boolean (task, TRUE);
+      g_object_unref (task);
+    }
+
+  g_list_free (tasks);
+}
+
+static void
+call_done (GObject      *source,
+           GAsyncResult *result,
+           gpointer      user_data)
+{
+  Item *item = user_data;
+  GisSettingsTransaction *transaction = item->transaction;
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  GVariant *retval;
+
+  retval = g_dbus_connection_call_finish (G_DBUS_CONNECTION (source), result, &item->error);
+  if (retval != NULL)
+    g_variant_unref (retval);
+  else
+    g_warning ("Could not set %s: %s", item->key, item->error->message);
+
+  item->state = ITEM_DONE;
+  priv->in_flight--;
+
+  /* It may have been replaced while it was in flight */
+  if (find_item (transaction, item->key) != item)
+    g_ptr_array_remove (priv->items, item);
+
+  complete_tasks (transaction);
+  g_object_unref (transaction);
+}
+
+static void
+start_pending_calls (GisSettingsTransaction *transaction)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      Item *item = g_ptr_array_index (priv->items, i);
+
+      if (item->state != ITEM_PENDING)
+        continue;
+
+      item->state = ITEM_IN_FLIGHT;
+      priv->in_flight++;
+
+      /* The calls are independent of each other, so they all go out
+       * at once and the replies come back in whatever order. */
+      g_dbus_connection_call (priv->connection,
+                              item->bus_name,
+                              item->object_path,
+                              item->interface_name,
+                              item->method_name,
+                              item->parameters,
+                              NULL,
+                              G_DBUS_CALL_FLAGS_NONE,
+                              -1, NULL,
+                              call_done, item);
+      g_object_ref (transaction);
+    }
+}
+
+static void
+fail_pending_calls (GisSettingsTransaction *transaction,
+                    const GError           *error)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      Item *item = g_ptr_array_index (priv->items, i);
+
+      if (item->state != ITEM_PENDING)
+        continue;
+
+      item->state = ITEM_DONE;
+      item->error = g_error_copy (error);
+    }
+}
+
+static void
+got_connection (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+  GisSettingsTransaction *transaction = user_data;
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  GError *error = NULL;
+
+  priv->getting_connection = FALSE;
+  priv->connection = g_bus_get_finish (result, &error);
+
+  if (priv->connection != NULL)
+    {
+      start_pending_calls (transaction);
+    }
+  else
+    {
+      g_warning ("Could not apply the system settings: %s", error->message);
+      fail_pending_calls (transaction, error);
+      g_error_free (error);
+    }
+
+  complete_tasks (transaction);
+  g_object_unref (transaction);
+}
+
+/**
+ * gis_settings_transaction_commit_async:
+ * @transaction: a #GisSettingsTransaction
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: called once every call has finished
+ * @user_data: data for @callback
+ *
+ * Makes all the pending calls, and waits for them and for any others
+ * still in flight from an earlier commit.
+ */
+void
+gis_settings_transaction_commit_async (GisSettingsTransaction *transaction,
+                                       GCancellable           *cancellable,
+                                       GAsyncReadyCallback     callback,
+                                       gpointer                user_data)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  GTask *task;
+
+  g_return_if_fail (GIS_IS_SETTINGS_TRANSACTION (transaction));
+
+  task = g_task_new (transaction, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gis_settings_transaction_commit_async);
+  priv->tasks = g_list_append (priv->tasks, task);
+
+  if (priv->connection != NULL)
+    {
+      start_pending_calls (transaction);
+      complete_tasks (transaction);
+    }
+  else if (!priv->getting_connection)
+    {
+      priv->getting_connection = TRUE;
+      g_bus_get (G_BUS_TYPE_SYSTEM, NULL, got_connection, g_object_ref (transaction));
+    }
+}
+
+/**
+ * gis_settings_transaction_commit_finish:
+ *
+ * Returns: %TRUE if every setting was applied; otherwise, @error is
+ *   about the first one that was not, and
+ *   gis_settings_transaction_foreach_result() has the rest
+ */
+gboolean
+gis_settings_transaction_commit_finish (GisSettingsTransaction *transaction,
+                                        GAsyncResult           *result,
+                                        GError                **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, transaction), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/**
+ * gis_settings_transaction_get_result:
+ * @transaction: a #GisSettingsTransaction
+ * @key: the key the call was set with
+ * @error: return location for the error from the call
+ *
+ * Returns: %TRUE if the last call set for @key was made and succeeded
+ */
+gboolean
+gis_settings_transaction_get_result (GisSettingsTransaction *transaction,
+                                     const gchar            *key,
+                                     GError                **error)
+{
+  Item *item;
+
+  item = find_item (transaction, key);
+  if (item == NULL)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                   "Nothing was set for %s", key);
+      return FALSE;
+    }
+
+  if (item->state != ITEM_DONE)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_PENDING,
+                   "%s has not been applied yet", key);
+      return FALSE;
+    }
+
+  if (item->error != NULL)
+    {
+      g_propagate_error (error, g_error_copy (item->error));
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gis_settings_transaction_foreach_result:
+ * @transaction: a #GisSettingsTransaction
+ * @func: called with the key and the error, or %NULL, of each call
+ *   that has been made
+ * @user_data: data for @func
+ */
+void
+gis_settings_transaction_foreach_result (GisSettingsTransaction *transaction,
+                                         GisSettingsResultFunc   func,
+                                         gpointer                user_data)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+  guint i;
+
+  for (i = 0; i < priv->items->len; i++)
+    {
+      Item *item = g_ptr_array_index (priv->items, i);
+
+      if (item->state == ITEM_DONE)
+        func (item->key, item->error, user_data);
+    }
+}
+
+static void
+gis_settings_transaction_finalize (GObject *object)
+{
+  GisSettingsTransaction *transaction = GIS_SETTINGS_TRANSACTION (object);
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+
+  /* Calls and tasks in flight hold a reference */
+  g_ptr_array_unref (priv->items);
+  g_clear_object (&priv->connection);
+
+  G_OBJECT_CLASS (gis_settings_transaction_parent_class)->finalize (object);
+}
+
+static void
+gis_settings_transaction_class_init (GisSettingsTransactionClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->finalize = gis_settings_transaction_finalize;
+}
+
+static void
+gis_settings_transaction_init (GisSettingsTransaction *transaction)
+{
+  GisSettingsTransactionPrivate *priv = gis_settings_transaction_get_instance_private (transaction);
+
+  priv->items = g_ptr_array_new_with_free_func ((GDestroyNotify) item_free);
+}
+
+GisSettingsTransaction *
+gis_settings_transaction_new (void)
+{
+  return g_object_new (GIS_TYPE_SETTINGS_TRANSACTION, NULL);
+}
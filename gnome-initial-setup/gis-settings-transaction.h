@@ -0,0 +1,79 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_SETTINGS_TRANSACTION_H__
+#define __GIS_SETTINGS_TRANSACTION_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GIS_TYPE_SETTINGS_TRANSACTION               (gis_settings_transaction_get_type ())
+#define GIS_SETTINGS_TRANSACTION(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIS_TYPE_SETTINGS_TRANSACTION, GisSettingsTransaction))
+#define GIS_SETTINGS_TRANSACTION_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass),  GIS_TYPE_SETTINGS_TRANSACTION, GisSettingsTransactionClass))
+#define GIS_IS_SETTINGS_TRANSACTION(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIS_TYPE_SETTINGS_TRANSACTION))
+#define GIS_IS_SETTINGS_TRANSACTION_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIS_TYPE_SETTINGS_TRANSACTION))
+#define GIS_SETTINGS_TRANSACTION_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIS_TYPE_SETTINGS_TRANSACTION, GisSettingsTransactionClass))
+
+typedef struct _GisSettingsTransaction        GisSettingsTransaction;
+typedef struct _GisSettingsTransactionClass   GisSettingsTransactionClass;
+
+struct _GisSettingsTransaction
+{
+  GObject parent;
+};
+
+struct _GisSettingsTransactionClass
+{
+  GObjectClass parent_class;
+};
+
+typedef void (*GisSettingsResultFunc) (const gchar  *key,
+                                       const GError *error,
+                                       gpointer      user_data);
+
+GType gis_settings_transaction_get_type (void);
+
+GisSettingsTransaction *gis_settings_transaction_new (void);
+
+void     gis_settings_transaction_set_call       (GisSettingsTransaction *transaction,
+                                                  const gchar            *key,
+                                                  const gchar            *bus_name,
+                                                  const gchar            *object_path,
+                                                  const gchar            *interface_name,
+                                                  const gchar            *method_name,
+                                                  GVariant               *parameters);
+
+void     gis_settings_transaction_commit_async   (GisSettingsTransaction *transaction,
+                                                  GCancellable           *cancellable,
+                                                  GAsyncReadyCallback     callback,
+                                                  gpointer                user_data);
+gboolean gis_settings_transaction_commit_finish  (GisSettingsTransaction *transaction,
+                                                  GAsyncResult           *result,
+                                                  GError                **error);
+
+gboolean gis_settings_transaction_get_result     (GisSettingsTransaction *transaction,
+                                                  const gchar            *key,
+                                                  GError                **error);
+void     gis_settings_transaction_foreach_result (GisSettingsTransaction *transaction,
+                                                  GisSettingsResultFunc   func,
+                                                  gpointer                user_data);
+
+G_END_DECLS
+
+#endif /* __GIS_SETTINGS_TRANSACTION_H__ */
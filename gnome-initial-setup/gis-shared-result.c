@@ -0,0 +1,134 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* An object that is made once and handed to everybody who asks.
+ *
+ * The first request starts making it; tasks that come in before it is
+ * ready wait for it, and those that come in later get it straight
+ * away. GisPermissionCache and GisProxyPool keep one of these for each
+ * thing they look up.
+ *
+ * Since the object is shared, no single caller's cancellable may stop
+ * it being made: cancelling only stops that caller from getting it. The
+ * owner is kept alive until the object is ready, so that whatever makes
+ * it can always call gis_shared_result_resolve().
+ */
+
+#include "config.h"
+
+#include "gis-shared-result.h"
+
+struct _GisSharedResult
+{
+  GObject *owner;
+  gchar *name;
+
+  gboolean resolving;
+  GObject *object;
+  GError *error;
+
+  /* waiting for the object */
+  GList *tasks;
+};
+
+/* A new result waits for gis_shared_result_resolve(), and holds a
+ * reference on @owner until then. */
+GisSharedResult *
+gis_shared_result_new (GObject     *owner,
+                       const gchar *name)
+{
+  GisSharedResult *result;
+
+  result = g_slice_new0 (GisSharedResult);
+  result->owner = g_object_ref (owner);
+  result->name = g_strdup (name);
+  result->resolving = TRUE;
+
+  return result;
+}
+
+void
+gis_shared_result_free (GisSharedResult *result)
+{
+  g_free (result->name);
+  g_clear_object (&result->object);
+  g_clear_error (&result->error);
+  g_slice_free (GisSharedResult, result);
+}
+
+const gchar *
+gis_shared_result_get_name (GisSharedResult *result)
+{
+  return result->name;
+}
+
+static void
+return_now (GisSharedResult *result,
+            GTask           *task)
+{
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
+  if (result->object != NULL)
+    g_task_return_pointer (task, g_object_ref (result->object), g_object_unref);
+  else
+    g_task_return_error (task, g_error_copy (result->error));
+}
+
+/* Returns the object from @task once it is ready */
+void
+gis_shared_result_return (GisSharedResult *result,
+                          GTask           *task)
+{
+  if (result->resolving)
+    result->tasks = g_list_append (result->tasks, g_object_ref (task));
+  else
+    return_now (result, task);
+}
+
+/* Takes @object, or @error if it could not be made, and returns it
+ * from every waiting task. The result may be freed by the time this
+ * returns, as the owner loses its reference. */
+void
+gis_shared_result_resolve (GisSharedResult *result,
+                           gpointer         object,
+                           GError          *error)
+{
+  GObject *owner = result->owner;
+  GList *tasks, *l;
+
+  g_return_if_fail (result->resolving);
+  g_return_if_fail ((object == NULL) != (error == NULL));
+
+  result->resolving = FALSE;
+  result->owner = NULL;
+  result->object = object;
+  result->error = error;
+
+  tasks = result->tasks;
+  result->tasks = NULL;
+
+  for (l = tasks; l != NULL; l = l->next)
+    {
+      return_now (result, l->data);
+      g_object_unref (l->data);
+    }
+
+  g_list_free (tasks);
+  g_object_unref (owner);
+}
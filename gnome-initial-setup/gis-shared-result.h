@@ -0,0 +1,42 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_SHARED_RESULT_H__
+#define __GIS_SHARED_RESULT_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GisSharedResult GisSharedResult;
+
+GisSharedResult *gis_shared_result_new      (GObject         *owner,
+                                             const gchar     *name);
+void             gis_shared_result_free     (GisSharedResult *result);
+
+const gchar     *gis_shared_result_get_name (GisSharedResult *result);
+
+void             gis_shared_result_return   (GisSharedResult *result,
+                                             GTask           *task);
+void             gis_shared_result_resolve  (GisSharedResult *result,
+                                             gpointer         object,
+                                             GError          *error);
+
+G_END_DECLS
+
+#endif /* __GIS_SHARED_RESULT_H__ */
@@ -0,0 +1,343 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Records spans of time spent during startup and in pages, and writes
+ * them out in the Chrome trace event format, which can be loaded in
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * Tracing is off unless GIS_TRACE is set to the file to write to:
+ *
+ *   GIS_TRACE=/tmp/gis-trace.json gnome-initial-setup
+ *
+ * Besides the spans recorded with gis_trace_begin() / gis_trace_end(),
+ * every D-Bus method call made on the shared system and session bus
+ * connections is recorded from the moment it is sent until its reply
+ * arrives.
+ */
+
+#include "config.h"
+
+#include <stdarg.h>
+#include <unistd.h>
+
+#include <gio/gio.h>
+
+#include "gis-trace.h"
+
+typedef struct {
+  gchar *name;
+  const gchar *category;
+  gint64 begin_time;
+  gint64 duration;
+  guint thread_id;
+} TraceEvent;
+
+typedef struct {
+  GDBusConnection *connection;
+  guint filter_id;
+  /* serial → TraceEvent, for calls awaiting a reply */
+  GHashTable *pending;
+} BusTrace;
+
+static gchar *trace_file;
+static GArray *trace_events;
+static gint64 trace_epoch;
+static BusTrace bus_traces[2];
+G_LOCK_DEFINE_STATIC (trace);
+
+static guint next_thread_id = 1;
+static GPrivate thread_id_key;
+
+static guint
+current_thread_id (void)
+{
+  guint id = GPOINTER_TO_UINT (g_private_get (&thread_id_key));
+
+  if (id == 0)
+    {
+      id = g_atomic_int_add (&next_thread_id, 1);
+      g_private_set (&thread_id_key, GUINT_TO_POINTER (id));
+    }
+
+  return id;
+}
+
+static void
+trace_event_clear (TraceEvent *event)
+{
+  g_free (event->name);
+}
+
+static void
+add_event (gchar       *name,
+           const gchar *category,
+           gint64       begin_time,
+           gint64       end_time)
+{
+  TraceEvent event;
+
+  event.name = name;
+  event.category = category;
+  event.begin_time = begin_time;
+  event.duration = end_time - begin_time;
+  event.thread_id = current_thread_id ();
+
+  G_LOCK (trace);
+  if (trace_events != NULL)
+    {
+      g_array_append_val (trace_events, event);
+      name = NULL;
+    }
+  G_UNLOCK (trace);
+
+  g_free (name);
+}
+
+static void
+pending_call_free (TraceEvent *event)
+{
+  trace_event_clear (event);
+  g_slice_free (TraceEvent, event);
+}
+
+static GDBusMessage *
+bus_filter (GDBusConnection *connection,
+            GDBusMessage    *message,
+            gboolean         incoming,
+            gpointer         user_data)
+{
+  BusTrace *bus_trace = user_data;
+  TraceEvent *event;
+  guint32 serial;
+
+  switch (g_dbus_message_get_message_type (message))
+    {
+    case G_DBUS_MESSAGE_TYPE_METHOD_CALL:
+      if (incoming)
+        break;
+
+      event = g_slice_new0 (TraceEvent);
+      event->name = g_strdup_printf ("%s.%s → %s",
+                                     g_dbus_message_get_interface (message) ?: "",
+                                     g_dbus_message_get_member (message),
+                                     g_dbus_message_get_destination (message) ?: "");
+      event->begin_time = g_get_monotonic_time ();
+
+      /* Filters may still run for a moment after being removed */
+      G_LOCK (trace);
+      if (bus_trace->pending != NULL)
+        {
+          g_hash_table_insert (bus_trace->pending,
+                               GUINT_TO_POINTER (g_dbus_message_get_serial (message)),
+                               event);
+          event = NULL;
+        }
+      G_UNLOCK (trace);
+
+      if (event != NULL)
+        pending_call_free (event);
+      break;
+
+    case G_DBUS_MESSAGE_TYPE_METHOD_RETURN:
+    case G_DBUS_MESSAGE_TYPE_ERROR:
+      if (!incoming)
+        break;
+
+      serial = g_dbus_message_get_reply_serial (message);
+
+      event = NULL;
+      G_LOCK (trace);
+      if (bus_trace->pending != NULL)
+        {
+          event = g_hash_table_lookup (bus_trace->pending, GUINT_TO_POINTER (serial));
+          if (event != NULL)
+            g_hash_table_steal (bus_trace->pending, GUINT_TO_POINTER (serial));
+        }
+      G_UNLOCK (trace);
+
+      if (event != NULL)
+        {
+          add_event (event->name, "dbus", event->begin_time, g_get_monotonic_time ());
+          g_slice_free (TraceEvent, event);
+        }
+      break;
+
+    default:
+      break;
+    }
+
+  return message;
+}
+
+static void
+trace_bus (BusTrace *bus_trace,
+           GBusType  bus_type)
+{
+  GError *error = NULL;
+
+  bus_trace->connection = g_bus_get_sync (bus_type, NULL, &error);
+  if (bus_trace->connection == NULL)
+    {
+      g_warning ("Not tracing D-Bus calls: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  bus_trace->pending = g_hash_table_new_full (NULL, NULL, NULL,
+                                              (GDestroyNotify) pending_call_free);
+  bus_trace->filter_id = g_dbus_connection_add_filter (bus_trace->connection,
+                                                       bus_filter, bus_trace, NULL);
+}
+
+static void
+untrace_bus (BusTrace *bus_trace)
+{
+  if (bus_trace->connection == NULL)
+    return;
+
+  g_dbus_connection_remove_filter (bus_trace->connection, bus_trace->filter_id);
+  g_clear_object (&bus_trace->connection);
+
+  G_LOCK (trace);
+  g_clear_pointer (&bus_trace->pending, g_hash_table_destroy);
+  G_UNLOCK (trace);
+}
+
+void
+gis_trace_init (void)
+{
+  const gchar *path;
+
+  path = g_getenv ("GIS_TRACE");
+  if (path == NULL || *path == '\0' || trace_file != NULL)
+    return;
+
+  trace_file = g_strdup (path);
+  trace_epoch = g_get_monotonic_time ();
+  trace_events = g_array_new (FALSE, FALSE, sizeof (TraceEvent));
+  g_array_set_clear_func (trace_events, (GDestroyNotify) trace_event_clear);
+
+  trace_bus (&bus_traces[0], G_BUS_TYPE_SYSTEM);
+  trace_bus (&bus_traces[1], G_BUS_TYPE_SESSION);
+}
+
+gboolean
+gis_trace_is_enabled (void)
+{
+  return trace_file != NULL;
+}
+
+/**
+ * gis_trace_begin:
+ *
+ * Returns: the time to pass to gis_trace_end() once the span is over,
+ *   or 0 if tracing is disabled
+ */
+gint64
+gis_trace_begin (void)
+{
+  if (trace_file == NULL)
+    return 0;
+
+  return g_get_monotonic_time ();
+}
+
+void
+gis_trace_end (gint64       begin_time,
+               const gchar *category,
+               const gchar *format,
+               ...)
+{
+  va_list args;
+  gchar *name;
+
+  if (trace_file == NULL || begin_time == 0)
+    return;
+
+  va_start (args, format);
+  name = g_strdup_vprintf (format, args);
+  va_end (args);
+
+  add_event (name, category, begin_time, g_get_monotonic_time ());
+}
+
+static void
+append_json_string (GString     *str,
+                    const gchar *s)
+{
+  g_string_append_c (str, '"');
+  for (; *s != '\0'; s++)
+    {
+      if (*s == '"' || *s == '\\')
+        g_string_append_printf (str, "\\%c", *s);
+      else if ((guchar) *s < 0x20)
+        g_string_append_printf (str, "\\u%04x", *s);
+      else
+        g_string_append_c (str, *s);
+    }
+  g_string_append_c (str, '"');
+}
+
+void
+gis_trace_shutdown (void)
+{
+  GString *json;
+  GError *error = NULL;
+  guint i;
+
+  if (trace_file == NULL)
+    return;
+
+  untrace_bus (&bus_traces[0]);
+  untrace_bus (&bus_traces[1]);
+
+  json = g_string_new ("{\"traceEvents\":[\n");
+
+  G_LOCK (trace);
+  for (i = 0; i < trace_events->len; i++)
+    {
+      TraceEvent *event = &g_array_index (trace_events, TraceEvent, i);
+
+      g_string_append (json, "{\"name\":");
+      append_json_string (json, event->name);
+      g_string_append (json, ",\"cat\":");
+      append_json_string (json, event->category);
+      g_string_append_printf (json,
+                              ",\"ph\":\"X\",\"ts\":%" G_GINT64_FORMAT
+                              ",\"dur\":%" G_GINT64_FORMAT
+                              ",\"pid\":%d,\"tid\":%u}%s\n",
+                              event->begin_time - trace_epoch,
+                              event->duration,
+                              (int) getpid (),
+                              event->thread_id,
+                              i + 1 < trace_events->len ? "," : "");
+    }
+  g_clear_pointer (&trace_events, g_array_unref);
+  G_UNLOCK (trace);
+
+  g_string_append (json, "]}\n");
+
+  if (!g_file_set_contents (trace_file, json->str, json->len, &error))
+    {
+      g_warning ("Could not write trace to %s: %s", trace_file, error->message);
+      g_error_free (error);
+    }
+
+  g_string_free (json, TRUE);
+  g_clear_pointer (&trace_file, g_free);
+}
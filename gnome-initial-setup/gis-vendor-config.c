@@ -0,0 +1,425 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* VENDOR_CONF_FILE points to a keyfile containing vendor customization
+ * options. It is parsed once, when the driver starts, and again only
+ * if it changes on disk. The following groups and keys are supported:
+ *
+ *   [pages]
+ *   - skip (optional): list of pages to be skipped.
+ *
+ *   [Welcome]
+ *   - title (required): short string to show as title.
+ *   - description (optional): string containing long text, likely to be wrapped.
+ *   - logo (optional): absolute path to the file with a logo for the brand.
+ *
+ *   [Network]
+ *   - ssid (required): name of the wireless network to join.
+ *   - security (optional): one of "none", "wep" or "wpa-psk".
+ *   - psk (optional): the passphrase or key for the network.
+ *   - timeout (optional): seconds to wait for the connection before
+ *     falling back to the network page.
+ *
+ * For example, this is how this file would look on a vendor image:
+ *
+ *   [pages]
+ *   skip=language
+ *
+ *   [Welcome]
+ *   title=A title to be shown at the top
+ *   description=A long description that will be shown at the bottom of this
+ *     page, right below the branded logo (if any), explaining what the
+ *     branded edition is about.
+ *   logo=/path/to/the/image/with/the/logo.png
+ *
+ *   [Network]
+ *   ssid=FactoryLine
+ *   security=wpa-psk
+ *   psk=secret
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "gis-vendor-config.h"
+
+#define VENDOR_PAGES_GROUP "pages"
+#define VENDOR_PAGES_SKIP_KEY "skip"
+
+#define VENDOR_WELCOME_GROUP "Welcome"
+#define VENDOR_WELCOME_TITLE_KEY "title"
+#define VENDOR_WELCOME_DESC_KEY "description"
+#define VENDOR_WELCOME_LOGO_KEY "logo"
+
+#define VENDOR_NETWORK_GROUP "Network"
+#define VENDOR_NETWORK_SSID_KEY "ssid"
+#define VENDOR_NETWORK_SECURITY_KEY "security"
+#define VENDOR_NETWORK_PSK_KEY "psk"
+#define VENDOR_NETWORK_TIMEOUT_KEY "timeout"
+
+enum {
+  CHANGED,
+  LAST_SIGNAL,
+};
+
+static guint signals[LAST_SIGNAL];
+
+struct _GisVendorConfigPrivate {
+  gchar *path;
+  GKeyFile *keyfile;
+  /* what keyfile was loaded from, to tell real changes apart */
+  gchar *data;
+  GFileMonitor *monitor;
+
+  gchar **skip_pages;
+
+  gchar *welcome_title;
+  gchar *welcome_description;
+  gchar *welcome_logo;
+
+  gchar *network_ssid;
+  gchar *network_security;
+  gchar *network_psk;
+  gint network_timeout;
+};
+typedef struct _GisVendorConfigPrivate GisVendorConfigPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GisVendorConfig, gis_vendor_config, G_TYPE_OBJECT)
+
+static void
+clear_values (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+
+  g_clear_pointer (&priv->skip_pages, g_strfreev);
+
+  g_clear_pointer (&priv->welcome_title, g_free);
+  g_clear_pointer (&priv->welcome_description, g_free);
+  g_clear_pointer (&priv->welcome_logo, g_free);
+
+  g_clear_pointer (&priv->network_ssid, g_free);
+  g_clear_pointer (&priv->network_security, g_free);
+  g_clear_pointer (&priv->network_psk, g_free);
+  priv->network_timeout = 0;
+}
+
+static gchar *
+get_nonempty_string (GKeyFile    *keyfile,
+                     const gchar *group,
+                     const gchar *key)
+{
+  gchar *value;
+
+  value = g_key_file_get_string (keyfile, group, key, NULL);
+  if (value != NULL && *value == '\0')
+    g_clear_pointer (&value, g_free);
+
+  return value;
+}
+
+static void
+read_values (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  GKeyFile *keyfile = priv->keyfile;
+
+  clear_values (config);
+
+  priv->skip_pages = g_key_file_get_string_list (keyfile, VENDOR_PAGES_GROUP,
+                                                 VENDOR_PAGES_SKIP_KEY, NULL, NULL);
+
+  if (g_key_file_has_group (keyfile, VENDOR_WELCOME_GROUP))
+    {
+      priv->welcome_title = get_nonempty_string (keyfile, VENDOR_WELCOME_GROUP,
+                                                 VENDOR_WELCOME_TITLE_KEY);
+      if (priv->welcome_title == NULL)
+        g_warning ("Could not read title for 'Welcome' branding page from %s",
+                   priv->path);
+
+      priv->welcome_description = get_nonempty_string (keyfile, VENDOR_WELCOME_GROUP,
+                                                       VENDOR_WELCOME_DESC_KEY);
+      priv->welcome_logo = get_nonempty_string (keyfile, VENDOR_WELCOME_GROUP,
+                                                VENDOR_WELCOME_LOGO_KEY);
+    }
+
+  priv->network_ssid = get_nonempty_string (keyfile, VENDOR_NETWORK_GROUP,
+                                            VENDOR_NETWORK_SSID_KEY);
+  priv->network_security = get_nonempty_string (keyfile, VENDOR_NETWORK_GROUP,
+                                                VENDOR_NETWORK_SECURITY_KEY);
+  priv->network_psk = g_key_file_get_string (keyfile, VENDOR_NETWORK_GROUP,
+                                             VENDOR_NETWORK_PSK_KEY, NULL);
+  priv->network_timeout = MAX (0, g_key_file_get_integer (keyfile, VENDOR_NETWORK_GROUP,
+                                                          VENDOR_NETWORK_TIMEOUT_KEY, NULL));
+}
+
+/* Returns whether the contents differ from what was loaded before */
+static gboolean
+load (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  GKeyFile *keyfile;
+  gchar *data = NULL;
+  GError *error = NULL;
+
+  keyfile = g_key_file_new ();
+  if (!g_key_file_load_from_file (keyfile, priv->path, G_KEY_FILE_NONE, &error))
+    {
+      if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        g_warning ("Could not read file %s: %s", priv->path, error->message);
+
+      g_error_free (error);
+    }
+  else
+    {
+      data = g_key_file_to_data (keyfile, NULL, NULL);
+    }
+
+  if (priv->keyfile != NULL && g_strcmp0 (data, priv->data) == 0)
+    {
+      g_key_file_free (keyfile);
+      g_free (data);
+      return FALSE;
+    }
+
+  g_clear_pointer (&priv->keyfile, g_key_file_free);
+  priv->keyfile = keyfile;
+  g_free (priv->data);
+  priv->data = data;
+
+  read_values (config);
+
+  return TRUE;
+}
+
+static void
+file_changed (GFileMonitor      *monitor,
+              GFile             *file,
+              GFile             *other_file,
+              GFileMonitorEvent  event_type,
+              GisVendorConfig   *config)
+{
+  switch (event_type)
+    {
+    case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+      if (load (config))
+        {
+          g_debug ("Reloaded %s", gis_vendor_config_get_instance_private (config)->path);
+          g_signal_emit (config, signals[CHANGED], 0);
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+static void
+start_monitor (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  GFile *file;
+  GError *error = NULL;
+
+  file = g_file_new_for_path (priv->path);
+  priv->monitor = g_file_monitor_file (file, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+  g_object_unref (file);
+
+  if (priv->monitor == NULL)
+    {
+      g_warning ("Could not monitor %s: %s", priv->path, error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_signal_connect (priv->monitor, "changed",
+                    G_CALLBACK (file_changed), config);
+}
+
+static void
+gis_vendor_config_dispose (GObject *object)
+{
+  GisVendorConfig *config = GIS_VENDOR_CONFIG (object);
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+
+  if (priv->monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->monitor, file_changed, config);
+      g_file_monitor_cancel (priv->monitor);
+      g_clear_object (&priv->monitor);
+    }
+
+  G_OBJECT_CLASS (gis_vendor_config_parent_class)->dispose (object);
+}
+
+static void
+gis_vendor_config_finalize (GObject *object)
+{
+  GisVendorConfig *config = GIS_VENDOR_CONFIG (object);
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+
+  clear_values (config);
+  g_clear_pointer (&priv->keyfile, g_key_file_free);
+  g_free (priv->data);
+  g_free (priv->path);
+
+  G_OBJECT_CLASS (gis_vendor_config_parent_class)->finalize (object);
+}
+
+static void
+gis_vendor_config_class_init (GisVendorConfigClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = gis_vendor_config_dispose;
+  object_class->finalize = gis_vendor_config_finalize;
+
+  signals[CHANGED] =
+    g_signal_new ("changed",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_FIRST,
+                  G_STRUCT_OFFSET (GisVendorConfigClass, changed),
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 0);
+}
+
+static void
+gis_vendor_config_init (GisVendorConfig *config)
+{
+}
+
+/**
+ * gis_vendor_config_new:
+ * @path: the keyfile to read
+ * @monitor: whether to reload the file, and emit #GisVendorConfig::changed,
+ *   when it changes on disk
+ *
+ * Returns: (transfer full): the configuration read from @path. A missing
+ *   file is the same as an empty one.
+ */
+GisVendorConfig *
+gis_vendor_config_new (const gchar *path,
+                       gboolean     monitor)
+{
+  GisVendorConfig *config;
+  GisVendorConfigPrivate *priv;
+
+  config = g_object_new (GIS_TYPE_VENDOR_CONFIG, NULL);
+  priv = gis_vendor_config_get_instance_private (config);
+  priv->path = g_strdup (path);
+
+  load (config);
+
+  if (monitor)
+    start_monitor (config);
+
+  return config;
+}
+
+const gchar * const *
+gis_vendor_config_get_skip_pages (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return (const gchar * const *) priv->skip_pages;
+}
+
+gboolean
+gis_vendor_config_skips_page (GisVendorConfig *config,
+                              const gchar     *page_id)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+
+  return priv->skip_pages != NULL &&
+         g_strv_contains ((const gchar * const *) priv->skip_pages, page_id);
+}
+
+const gchar *
+gis_vendor_config_get_welcome_title (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->welcome_title;
+}
+
+const gchar *
+gis_vendor_config_get_welcome_description (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->welcome_description;
+}
+
+const gchar *
+gis_vendor_config_get_welcome_logo (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->welcome_logo;
+}
+
+const gchar *
+gis_vendor_config_get_network_ssid (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->network_ssid;
+}
+
+const gchar *
+gis_vendor_config_get_network_security (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->network_security;
+}
+
+const gchar *
+gis_vendor_config_get_network_psk (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->network_psk;
+}
+
+/**
+ * gis_vendor_config_get_network_timeout:
+ *
+ * Returns: the number of seconds to wait for the vendor network, or 0
+ *   if not set
+ */
+gint
+gis_vendor_config_get_network_timeout (GisVendorConfig *config)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return priv->network_timeout;
+}
+
+/**
+ * gis_vendor_config_get_string:
+ *
+ * Looks up a key with no typed accessor of its own.
+ *
+ * Returns: (transfer full) (nullable): the value of @key in @group
+ */
+gchar *
+gis_vendor_config_get_string (GisVendorConfig *config,
+                              const gchar     *group,
+                              const gchar     *key)
+{
+  GisVendorConfigPrivate *priv = gis_vendor_config_get_instance_private (config);
+  return g_key_file_get_string (priv->keyfile, group, key, NULL);
+}
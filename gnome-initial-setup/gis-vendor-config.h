@@ -0,0 +1,76 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_VENDOR_CONFIG_H__
+#define __GIS_VENDOR_CONFIG_H__
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GIS_TYPE_VENDOR_CONFIG               (gis_vendor_config_get_type ())
+#define GIS_VENDOR_CONFIG(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIS_TYPE_VENDOR_CONFIG, GisVendorConfig))
+#define GIS_VENDOR_CONFIG_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass),  GIS_TYPE_VENDOR_CONFIG, GisVendorConfigClass))
+#define GIS_IS_VENDOR_CONFIG(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIS_TYPE_VENDOR_CONFIG))
+#define GIS_IS_VENDOR_CONFIG_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIS_TYPE_VENDOR_CONFIG))
+#define GIS_VENDOR_CONFIG_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIS_TYPE_VENDOR_CONFIG, GisVendorConfigClass))
+
+typedef struct _GisVendorConfig        GisVendorConfig;
+typedef struct _GisVendorConfigClass   GisVendorConfigClass;
+
+struct _GisVendorConfig
+{
+  GObject parent;
+};
+
+struct _GisVendorConfigClass
+{
+  GObjectClass parent_class;
+
+  void (* changed) (GisVendorConfig *config);
+};
+
+GType gis_vendor_config_get_type (void);
+
+GisVendorConfig *gis_vendor_config_new (const gchar *path,
+                                        gboolean     monitor);
+
+/* [pages] */
+const gchar * const *gis_vendor_config_get_skip_pages (GisVendorConfig *config);
+gboolean gis_vendor_config_skips_page (GisVendorConfig *config,
+                                       const gchar     *page_id);
+
+/* [Welcome] */
+const gchar *gis_vendor_config_get_welcome_title       (GisVendorConfig *config);
+const gchar *gis_vendor_config_get_welcome_description (GisVendorConfig *config);
+const gchar *gis_vendor_config_get_welcome_logo        (GisVendorConfig *config);
+
+/* [Network] */
+const gchar *gis_vendor_config_get_network_ssid     (GisVendorConfig *config);
+const gchar *gis_vendor_config_get_network_security (GisVendorConfig *config);
+const gchar *gis_vendor_config_get_network_psk      (GisVendorConfig *config);
+gint         gis_vendor_config_get_network_timeout  (GisVendorConfig *config);
+
+/* Any other group */
+gchar *gis_vendor_config_get_string (GisVendorConfig *config,
+                                     const gchar     *group,
+                                     const gchar     *key);
+
+G_END_DECLS
+
+#endif /* __GIS_VENDOR_CONFIG_H__ */
@@ -0,0 +1,404 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Finds out what keeps the main loop from getting back to drawing.
+ *
+ * The watchdog is off unless GIS_WATCHDOG is set to the number of
+ * milliseconds a main loop iteration may take:
+ *
+ *   GIS_WATCHDOG=16 gnome-initial-setup
+ *
+ * Each iteration is timed from the main context's poll returning to it
+ * being called again. While an iteration is over the limit, a thread
+ * of our own interrupts the main thread once to take a backtrace and
+ * the name of the source being dispatched, so that the stall can be
+ * put down to the code that is blocking: a synchronous D-Bus call, a
+ * getpwnam(), and so on. Every stall is logged as it ends, with the
+ * page that was showing, and recorded in the trace if GIS_TRACE is
+ * also set. On exit, the stalls are summed up by where they happened,
+ * the worst first.
+ *
+ * The binary isn't linked with -rdynamic, so its own frames come out
+ * as offsets; addr2line -f -e gnome-initial-setup turns them into
+ * function names.
+ */
+
+#include "config.h"
+
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gis-trace.h"
+#include "gis-watchdog.h"
+
+#define DEFAULT_THRESHOLD_MS 16
+#define MAX_FRAMES 32
+/* The signal handler and the signal trampoline */
+#define SKIPPED_FRAMES 2
+#define SAMPLE_SIGNAL (SIGRTMIN + 3)
+
+typedef struct {
+  gchar *where;
+  guint count;
+  gint64 total;
+  gint64 max;
+} Stall;
+
+/* In microseconds; 0 while the watchdog is off */
+static gint64 threshold;
+static GPollFunc default_poll;
+static pthread_t main_thread;
+static const gchar *current_page;
+/* where → Stall */
+static GHashTable *stalls;
+
+static GThread *watchdog_thread;
+static GMutex watchdog_lock;
+static GCond watchdog_cond;
+/* These are protected by watchdog_lock */
+static gboolean watchdog_running;
+static gint64 iteration_start;
+static guint iteration_serial;
+static guint requested_serial;
+
+/* Written by the signal handler, on the main thread */
+static volatile sig_atomic_t sample_serial;
+static volatile sig_atomic_t sample_n_frames;
+static void *sample_frames[MAX_FRAMES];
+static gchar sample_source[64];
+
+static void
+stall_free (Stall *stall)
+{
+  g_free (stall->where);
+  g_slice_free (Stall, stall);
+}
+
+static void
+take_sample (int signum)
+{
+  GSource *source;
+  const gchar *name = NULL;
+  gsize i;
+
+  sample_n_frames = backtrace (sample_frames, MAX_FRAMES);
+
+  /* This only reads thread-local state, and a source that the main
+   * context holds a reference on while it is being dispatched */
+  source = g_main_current_source ();
+  if (source != NULL)
+    name = g_source_get_name (source);
+  for (i = 0; name != NULL && name[i] != '\0' && i < sizeof sample_source - 1; i++)
+    sample_source[i] = name[i];
+  sample_source[i] = '\0';
+
+  sample_serial = requested_serial;
+}
+
+/* The innermost frame of our own, rather than of the libraries, is
+ * where the blocking call was made. */
+static gchar *
+find_caller (gchar **symbols,
+             gint    n_symbols)
+{
+  static const gchar * const libraries[] = {
+    "libglib-2.0", "libgobject-2.0", "libgio-2.0", "libgtk-3", "libgdk-3",
+    "libc.so", "libc-", "libpthread", NULL
+  };
+  gint i, j;
+
+  for (i = SKIPPED_FRAMES; i < n_symbols; i++)
+    {
+      gboolean in_library = FALSE;
+      gchar *address;
+
+      for (j = 0; libraries[j] != NULL && !in_library; j++)
+        in_library = strstr (symbols[i], libraries[j]) != NULL;
+      if (in_library)
+        continue;
+
+      /* Leave out the absolute address, which tells stalls apart
+       * across runs for no reason */
+      address = strstr (symbols[i], " [");
+      return g_strndup (symbols[i], address != NULL ? address - symbols[i] : strlen (symbols[i]));
+    }
+
+  return NULL;
+}
+
+static void
+report_stall (gint64   start,
+              gint64   duration,
+              gboolean sampled)
+{
+  const gchar *page = current_page != NULL ? current_page : "no page";
+  gchar **symbols = NULL;
+  gint n_symbols = 0;
+  gchar *caller = NULL;
+  const gchar *source = NULL;
+  GString *message;
+  Stall *stall;
+  gchar *where;
+  gint i;
+
+  if (sampled)
+    {
+      n_symbols = sample_n_frames;
+      symbols = backtrace_symbols (sample_frames, n_symbols);
+      if (symbols != NULL)
+        caller = find_caller (symbols, n_symbols);
+      if (sample_source[0] != '\0')
+        source = sample_source;
+    }
+
+  where = g_strdup_printf ("%s: %s", page,
+                           caller != NULL ? caller :
+                           source != NULL ? source : "unknown");
+
+  message = g_string_new (NULL);
+  g_string_append_printf (message, "Main loop blocked for %.1f ms on page %s",
+                          duration / 1000.0, page);
+  if (source != NULL)
+    g_string_append_printf (message, ", dispatching %s", source);
+  for (i = SKIPPED_FRAMES; symbols != NULL && i < n_symbols; i++)
+    g_string_append_printf (message, "\n  %s", symbols[i]);
+  g_message ("%s", message->str);
+  g_string_free (message, TRUE);
+
+  gis_trace_end (start, "stall", "%s", where);
+
+  stall = g_hash_table_lookup (stalls, where);
+  if (stall == NULL)
+    {
+      stall = g_slice_new0 (Stall);
+      stall->where = where;
+      g_hash_table_insert (stalls, stall->where, stall);
+    }
+  else
+    {
+      g_free (where);
+    }
+
+  stall->count++;
+  stall->total += duration;
+  stall->max = MAX (stall->max, duration);
+
+  g_free (caller);
+  free (symbols);
+}
+
+static void
+begin_iteration (void)
+{
+  g_mutex_lock (&watchdog_lock);
+  iteration_start = g_get_monotonic_time ();
+  iteration_serial++;
+  g_mutex_unlock (&watchdog_lock);
+}
+
+static void
+end_iteration (void)
+{
+  gint64 start, duration;
+  guint serial;
+
+  g_mutex_lock (&watchdog_lock);
+  start = iteration_start;
+  serial = iteration_serial;
+  iteration_start = 0;
+  g_mutex_unlock (&watchdog_lock);
+
+  if (start == 0)
+    return;
+
+  duration = g_get_monotonic_time () - start;
+  if (duration >= threshold)
+    report_stall (start, duration, (guint) sample_serial == serial);
+}
+
+static gint
+watchdog_poll (GPollFD *fds,
+               guint    nfds,
+               gint     timeout)
+{
+  gint ret;
+
+  if (!pthread_equal (pthread_self (), main_thread))
+    return default_poll (fds, nfds, timeout);
+
+  end_iteration ();
+  ret = default_poll (fds, nfds, timeout);
+  begin_iteration ();
+
+  return ret;
+}
+
+static gpointer
+watchdog_thread_func (gpointer data)
+{
+  g_mutex_lock (&watchdog_lock);
+
+  while (watchdog_running)
+    {
+      gint64 now = g_get_monotonic_time ();
+
+      /* One sample per iteration, taken once it is over the limit */
+      if (iteration_start != 0 &&
+          requested_serial != iteration_serial &&
+          now - iteration_start >= threshold)
+        {
+          requested_serial = iteration_serial;
+          pthread_kill (main_thread, SAMPLE_SIGNAL);
+        }
+
+      g_cond_wait_until (&watchdog_cond, &watchdog_lock, now + threshold / 4);
+    }
+
+  g_mutex_unlock (&watchdog_lock);
+
+  return NULL;
+}
+
+void
+gis_watchdog_init (void)
+{
+  const gchar *value;
+  struct sigaction action;
+  gint64 threshold_ms;
+  void *frame;
+
+  value = g_getenv ("GIS_WATCHDOG");
+  if (value == NULL || *value == '\0' || threshold != 0)
+    return;
+
+  threshold_ms = g_ascii_strtoll (value, NULL, 10);
+  if (threshold_ms <= 0)
+    threshold_ms = DEFAULT_THRESHOLD_MS;
+  threshold = threshold_ms * 1000;
+
+  /* backtrace() loads libgcc the first time, which mustn't happen in
+   * the signal handler */
+  backtrace (&frame, 1);
+
+  memset (&action, 0, sizeof action);
+  action.sa_handler = take_sample;
+  action.sa_flags = SA_RESTART;
+  sigemptyset (&action.sa_mask);
+  sigaction (SAMPLE_SIGNAL, &action, NULL);
+
+  main_thread = pthread_self ();
+  stalls = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                  NULL, (GDestroyNotify) stall_free);
+
+  default_poll = g_main_context_get_poll_func (NULL);
+  g_main_context_set_poll_func (NULL, watchdog_poll);
+
+  watchdog_running = TRUE;
+  watchdog_thread = g_thread_new ("gis-watchdog", watchdog_thread_func, NULL);
+}
+
+/**
+ * gis_watchdog_set_page:
+ * @page_id: (nullable): the ID of the page being shown
+ *
+ * Tells the watchdog which page stalls are to be put down to.
+ */
+void
+gis_watchdog_set_page (const gchar *page_id)
+{
+  current_page = page_id;
+}
+
+static gint
+compare_stalls (gconstpointer a,
+                gconstpointer b)
+{
+  const Stall *stall_a = *(const Stall **) a;
+  const Stall *stall_b = *(const Stall **) b;
+
+  if (stall_a->total != stall_b->total)
+    return stall_a->total > stall_b->total ? -1 : 1;
+
+  return g_strcmp0 (stall_a->where, stall_b->where);
+}
+
+static void
+print_summary (void)
+{
+  GPtrArray *sorted;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  if (g_hash_table_size (stalls) == 0)
+    {
+      g_printerr ("No main loop stalls over %" G_GINT64_FORMAT " ms\n",
+                  threshold / 1000);
+      return;
+    }
+
+  sorted = g_ptr_array_new ();
+  g_hash_table_iter_init (&iter, stalls);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    g_ptr_array_add (sorted, value);
+  g_ptr_array_sort (sorted, compare_stalls);
+
+  g_printerr ("Main loop stalls over %" G_GINT64_FORMAT " ms, by time blocked:\n",
+              threshold / 1000);
+  g_printerr ("%10s %6s %10s  %s\n", "total ms", "count", "max ms", "where");
+  for (i = 0; i < sorted->len; i++)
+    {
+      Stall *stall = g_ptr_array_index (sorted, i);
+
+      g_printerr ("%10.1f %6u %10.1f  %s\n",
+                  stall->total / 1000.0, stall->count, stall->max / 1000.0,
+                  stall->where);
+    }
+
+  g_ptr_array_unref (sorted);
+}
+
+void
+gis_watchdog_shutdown (void)
+{
+  if (threshold == 0)
+    return;
+
+  g_main_context_set_poll_func (NULL, default_poll);
+
+  g_mutex_lock (&watchdog_lock);
+  watchdog_running = FALSE;
+  iteration_start = 0;
+  g_cond_signal (&watchdog_cond);
+  g_mutex_unlock (&watchdog_lock);
+
+  g_thread_join (watchdog_thread);
+  watchdog_thread = NULL;
+
+  /* A sample may still be on its way */
+  signal (SAMPLE_SIGNAL, SIG_IGN);
+
+  print_summary ();
+
+  g_clear_pointer (&stalls, g_hash_table_destroy);
+  current_page = NULL;
+  threshold = 0;
+}
@@ -0,0 +1,33 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_WATCHDOG_H__
+#define __GIS_WATCHDOG_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void gis_watchdog_init     (void);
+void gis_watchdog_shutdown (void);
+
+void gis_watchdog_set_page (const gchar *page_id);
+
+G_END_DECLS
+
+#endif /* __GIS_WATCHDOG_H__ */
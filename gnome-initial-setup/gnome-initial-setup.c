@@ -54,95 +54,53 @@
 #include "pages/password/gis-password-page.h"
 #include "pages/summary/gis-summary-page.h"
 
-#define VENDOR_PAGES_GROUP "pages"
-#define VENDOR_PAGES_SKIP_KEY "skip"
-
 static gboolean force_existing_user_mode;
+static gchar *answer_file_path;
+static gchar *answer_summary_path;
+static gboolean benchmark;
+static gboolean evince_initialized;
 
 typedef void (*PreparePage) (GisDriver *driver);
 
 typedef struct {
+  /* as used in the vendor configuration's list of pages to skip */
+  const gchar *name;
+  /* the GisPageClass page_id of the page it makes */
   const gchar *page_id;
   PreparePage prepare_page_func;
   gboolean new_user_only;
 } PageData;
 
-#define PAGE(name, new_user_only) { #name, gis_prepare_ ## name ## _page, new_user_only }
+#define PAGE(name, page_id, new_user_only) { #name, page_id, gis_prepare_ ## name ## _page, new_user_only }
 
 static PageData page_table[] = {
-  PAGE (branding_welcome, TRUE),
-  PAGE (language, FALSE),
-  PAGE (live_chooser, TRUE),
-  /* PAGE (region,   FALSE), */
-  PAGE (keyboard, FALSE),
-  PAGE (display, TRUE),
-  PAGE (eula,     FALSE),
-  PAGE (endless_eula, TRUE),
-  PAGE (network,  FALSE),
-  /* PAGE (privacy,  FALSE), */
-  PAGE (timezone, TRUE),
-  PAGE (software, TRUE),
-  PAGE (goa,      FALSE),
-  PAGE (account,  TRUE),
-  PAGE (password, TRUE),
-  PAGE (summary,  FALSE),
+  PAGE (branding_welcome, "branding-welcome", TRUE),
+  PAGE (language, "language", FALSE),
+  PAGE (live_chooser, "live-chooser", TRUE),
+  /* PAGE (region,   "region", FALSE), */
+  PAGE (keyboard, "keyboard", FALSE),
+  PAGE (display,  "display",  TRUE),
+  PAGE (eula,     "eula",     FALSE),
+  PAGE (endless_eula, "endless-eula", TRUE),
+  PAGE (network,  "network",  FALSE),
+  /* PAGE (privacy,  "privacy", FALSE), */
+  PAGE (timezone, "timezone", TRUE),
+  PAGE (software, "software", TRUE),
+  PAGE (goa,      "goa",      FALSE),
+  PAGE (account,  "account",  TRUE),
+  PAGE (password, "password", TRUE),
+  PAGE (summary,  "summary",  FALSE),
   { NULL },
 };
 
 #undef PAGE
 
 static gboolean
-should_skip_page (GisDriver    *driver,
-                  const gchar  *page_id,
-                  gchar       **skip_pages)
+should_skip_page (GisDriver   *driver,
+                  const gchar *page_id)
 {
-  guint i = 0;
-
   /* check through our skip pages list for pages we don't want */
-  if (skip_pages) {
-    while (skip_pages[i]) {
-      if (g_strcmp0 (skip_pages[i], page_id) == 0)
-        return TRUE;
-      i++;
-    }
-  }
-  return FALSE;
-}
-
-static gchar **
-pages_to_skip_from_file (void)
-{
-  GKeyFile *skip_pages_file;
-  gchar **skip_pages = NULL;
-  GError *error = NULL;
-
-  /* VENDOR_CONF_FILE points to a keyfile containing vendor customization
-   * options. This code will look for options under the "pages" group, and
-   * supports the following keys:
-   *   - skip (optional): list of pages to be skipped.
-   *
-   * This is how this file would look on a vendor image:
-   *
-   *   [pages]
-   *   skip=language
-   */
-  skip_pages_file = g_key_file_new ();
-  if (!g_key_file_load_from_file (skip_pages_file, VENDOR_CONF_FILE,
-                                  G_KEY_FILE_NONE, &error)) {
-    if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-      g_warning ("Could not read file %s: %s", VENDOR_CONF_FILE, error->message);
-
-    g_error_free (error);
-    goto out;
-  }
-
-  skip_pages = g_key_file_get_string_list (skip_pages_file, VENDOR_PAGES_GROUP,
-                                           VENDOR_PAGES_SKIP_KEY, NULL, NULL);
-
- out:
-  g_key_file_free (skip_pages_file);
-
-  return skip_pages;
+  return gis_vendor_config_skips_page (gis_driver_get_vendor_config (driver), page_id);
 }
 
 static void
@@ -164,44 +122,96 @@ destroy_pages_after (GisAssistant *assistant,
   }
 }
 
+/* Evince is only needed by the Endless EULA page, so it is
+ * initialised on first use instead of at startup. Cheese and Clutter
+ * are still initialised in main(), since they have to set things up
+ * before and around gtk_init(). */
+void
+gis_ensure_evince (void)
+{
+  gint64 trace_time;
+
+  if (evince_initialized)
+    return;
+
+  trace_time = gis_trace_begin ();
+  ev_init ();
+  gis_trace_end (trace_time, "startup", "ev_init");
+
+  evince_initialized = TRUE;
+}
+
+static gboolean
+init_evince_idle (gpointer user_data)
+{
+  gis_ensure_evince ();
+  return G_SOURCE_REMOVE;
+}
+
 static void
 rebuild_pages_cb (GisDriver *driver)
 {
   PageData *page_data;
   GisAssistant *assistant;
   GisPage *current_page;
-  gchar **skip_pages;
   gboolean is_new_user;
+  gint64 trace_time;
+
+  trace_time = gis_trace_begin ();
 
   assistant = gis_driver_get_assistant (driver);
   current_page = gis_assistant_get_current_page (assistant);
 
-  skip_pages = pages_to_skip_from_file ();
-
   page_data = page_table;
 
+  gis_assistant_clear_page_factories (assistant);
+
   if (current_page != NULL) {
     destroy_pages_after (assistant, current_page);
 
-    for (page_data = page_table; page_data->page_id != NULL; ++page_data)
+    for (page_data = page_table; page_data->name != NULL; ++page_data)
       if (g_str_equal (page_data->page_id, GIS_PAGE_GET_CLASS (current_page)->page_id))
         break;
 
-    ++page_data;
+    /* Carry on from the page after the current one. If the current
+     * page is not in the table, there is nothing to add after it. */
+    if (page_data->name != NULL)
+      ++page_data;
   }
 
+  /* Pages are only constructed when navigation gets to them */
   is_new_user = (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER);
-  for (; page_data->page_id != NULL; ++page_data) {
+  for (; page_data->name != NULL; ++page_data) {
     if (page_data->new_user_only && !is_new_user)
       continue;
 
-    if (should_skip_page (driver, page_data->page_id, skip_pages))
+    if (should_skip_page (driver, page_data->name))
       continue;
 
-    page_data->prepare_page_func (driver);
+    gis_assistant_add_page_factory (assistant, page_data->page_id,
+                                    page_data->prepare_page_func, driver);
+
+    /* Join the vendor network from the start, rather than when the
+     * page gets built */
+    if (g_str_equal (page_data->name, "network"))
+      gis_network_page_start_auto_join (driver);
+
+    /* Let the password checks load while the user is busy with the
+     * earlier pages */
+    if (g_str_equal (page_data->name, "password"))
+      gis_password_page_warm_up ();
+
+    /* Get Evince ready once we are idle, if a page needs it */
+    if (g_str_equal (page_data->name, "endless_eula") && !evince_initialized)
+      g_idle_add_full (G_PRIORITY_LOW, init_evince_idle, NULL, NULL);
   }
 
-  g_strfreev (skip_pages);
+  /* ...except for the one to start with */
+  while (gis_assistant_get_current_page (assistant) == NULL &&
+         gis_assistant_build_next_page (assistant))
+    ;
+
+  gis_trace_end (trace_time, "startup", "rebuild_pages");
 }
 
 static gboolean
@@ -251,15 +261,31 @@ main (int argc, char *argv[])
   int status;
   GOptionContext *context;
   GisDriverMode mode;
+  GisAnswerFile *answer_file = NULL;
+  GError *error = NULL;
+  gint64 start_time, trace_time;
 
   GOptionEntry entries[] = {
     { "existing-user", 0, 0, G_OPTION_ARG_NONE, &force_existing_user_mode,
       _("Force existing user mode"), NULL },
+    { "answer-file", 0, 0, G_OPTION_ARG_FILENAME, &answer_file_path,
+      _("Set up unattended, with the answers in FILE"), _("FILE") },
+    { "answer-summary", 0, 0, G_OPTION_ARG_FILENAME, &answer_summary_path,
+      _("Write the result of unattended setup to FILE"), _("FILE") },
+    { "benchmark", 0, 0, G_OPTION_ARG_NONE, &benchmark,
+      _("Show the pages during unattended setup, and time them"), NULL },
     { NULL }
   };
 
+  start_time = g_get_monotonic_time ();
+
   g_unsetenv ("GIO_USE_VFS");
 
+  gis_trace_init ();
+  gis_watchdog_init ();
+  gis_frame_stats_init ();
+  gis_memory_stats_init ();
+
   context = g_option_context_new (_("- GNOME initial setup"));
   g_option_context_add_main_entries (context, entries, NULL);
 
@@ -276,37 +302,76 @@ main (int argc, char *argv[])
     return EXIT_SUCCESS;
   }
 
+  mode = get_mode ();
+
+  if (answer_file_path != NULL) {
+    answer_file = gis_answer_file_new (answer_file_path, answer_summary_path, &error);
+    if (answer_file == NULL) {
+      g_printerr ("Could not load answers from %s: %s\n", answer_file_path, error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+    if (benchmark)
+      gis_answer_file_set_benchmark (answer_file, start_time);
+  } else if (benchmark) {
+    g_printerr ("--benchmark needs --answer-file\n");
+    return EXIT_FAILURE;
+  }
+
+  /* When we are running as the gnome-initial-setup user we
+   * dont have a normal user session and need to initialize
+   * the keyring manually so that we can pass the credentials
+   * along to the new user in the handoff. This only starts the
+   * daemon; it finishes starting up while we bring up the UI.
+   */
+  if (mode == GIS_DRIVER_MODE_NEW_USER) {
+    trace_time = gis_trace_begin ();
+    gis_ensure_login_keyring ();
+    gis_trace_end (trace_time, "startup", "gis_ensure_login_keyring");
+  }
+
 #ifdef HAVE_CHEESE
+  trace_time = gis_trace_begin ();
   cheese_gtk_init (NULL, NULL);
+  gis_trace_end (trace_time, "startup", "cheese_gtk_init");
 #endif
 
+  trace_time = gis_trace_begin ();
   gtk_init (&argc, &argv);
-  ev_init ();
+  gis_trace_end (trace_time, "startup", "gtk_init");
 
 #if HAVE_CLUTTER
+  trace_time = gis_trace_begin ();
   if (gtk_clutter_init (NULL, NULL) != CLUTTER_INIT_SUCCESS) {
     g_critical ("Clutter-GTK init failed");
     exit (1);
   }
+  gis_trace_end (trace_time, "startup", "gtk_clutter_init");
 #endif
 
-  mode = get_mode ();
-
-  /* When we are running as the gnome-initial-setup user we
-   * dont have a normal user session and need to initialize
-   * the keyring manually so that we can pass the credentials
-   * along to the new user in the handoff.
-   */
-  if (mode == GIS_DRIVER_MODE_NEW_USER)
-    gis_ensure_login_keyring ();
-
   driver = gis_driver_new (mode);
   g_signal_connect (driver, "rebuild-pages", G_CALLBACK (rebuild_pages_cb), NULL);
+  if (answer_file != NULL)
+    gis_driver_set_answer_file (driver, answer_file);
   status = g_application_run (G_APPLICATION (driver), argc, argv);
 
   g_object_unref (driver);
   g_option_context_free (context);
-  ev_shutdown ();
+
+  if (answer_file != NULL) {
+    if (status == EXIT_SUCCESS && !gis_answer_file_succeeded (answer_file))
+      status = EXIT_FAILURE;
+    gis_answer_file_free (answer_file);
+  }
+
+  if (evince_initialized)
+    ev_shutdown ();
+
+  gis_memory_stats_shutdown ();
+  gis_frame_stats_shutdown ();
+  gis_watchdog_shutdown ();
+  gis_trace_shutdown ();
 
   return status;
 }
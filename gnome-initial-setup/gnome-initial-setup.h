@@ -29,13 +29,24 @@
 typedef struct _GisDriver    GisDriver;
 typedef struct _GisAssistant GisAssistant;
 typedef struct _GisPage      GisPage;
+typedef struct _GisAnswerFile GisAnswerFile;
 
 #include "gis-driver.h"
 #include "gis-assistant.h"
 #include "gis-page.h"
 #include "gis-pkexec.h"
 #include "gis-keyring.h"
+#include "gis-trace.h"
+#include "gis-watchdog.h"
+#include "gis-frame-stats.h"
+#include "gis-memory-stats.h"
+#include "gis-vendor-config.h"
+#include "gis-settings-transaction.h"
+#include "gis-permission-cache.h"
+#include "gis-proxy-pool.h"
+#include "gis-answer-file.h"
 
 void gis_add_setup_done_file (void);
+void gis_ensure_evince (void);
 
 #endif /* __GNOME_INITIAL_SETUP_H__ */
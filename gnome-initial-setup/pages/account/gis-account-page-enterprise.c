@@ -46,6 +46,12 @@ static void        on_realm_joined     (GObject *source,
 struct _GisAccountPageEnterprisePrivate
 {
   GtkWidget *image;
+  GtkWidget *title;
+  GtkWidget *subtitle;
+  GtkWidget *domain_label;
+  GtkWidget *login_label;
+  GtkWidget *password_label;
+  GtkWidget *domain_hint;
   GtkWidget *login;
   GtkWidget *password;
   GtkWidget *domain;
@@ -53,6 +59,13 @@ struct _GisAccountPageEnterprisePrivate
   GtkTreeModel *realms_model;
 
   GtkWidget *join_dialog;
+  GtkWidget *join_button;
+  GtkWidget *join_title;
+  GtkWidget *join_description;
+  GtkWidget *join_domain_label;
+  GtkWidget *join_computer_label;
+  GtkWidget *join_name_label;
+  GtkWidget *join_password_label;
   GtkWidget *join_name;
   GtkWidget *join_password;
   GtkWidget *join_domain;
@@ -816,8 +829,21 @@ gis_account_page_enterprise_class_init (GisAccountPageEnterpriseClass *klass)
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, domain_entry);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, realms_model);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, image);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, subtitle);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, domain_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, login_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, password_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, domain_hint);
 
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_dialog);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_button);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_description);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_domain_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_computer_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_name_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_password_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_name);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_password);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageEnterprise, join_domain);
@@ -837,6 +863,27 @@ gis_account_page_enterprise_init (GisAccountPageEnterprise *page)
   gtk_widget_init_template (GTK_WIDGET (page));
 }
 
+void
+gis_account_page_enterprise_locale_changed (GisAccountPageEnterprise *page)
+{
+  GisAccountPageEnterprisePrivate *priv = gis_account_page_enterprise_get_instance_private (page);
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Enterprise Login"));
+  gtk_label_set_label (GTK_LABEL (priv->subtitle), _("Enterprise login allows an existing centrally managed user account to be used on this device."));
+  gtk_label_set_label (GTK_LABEL (priv->domain_label), _("_Domain"));
+  gtk_label_set_label (GTK_LABEL (priv->login_label), _("_Username"));
+  gtk_label_set_label (GTK_LABEL (priv->password_label), _("_Password"));
+  gtk_label_set_label (GTK_LABEL (priv->domain_hint), _("Enterprise domain or realm name"));
+
+  gtk_button_set_label (GTK_BUTTON (priv->join_button), _("C_ontinue"));
+  gtk_label_set_label (GTK_LABEL (priv->join_title), _("Domain Administrator Login"));
+  gtk_label_set_label (GTK_LABEL (priv->join_description), _("In order to use enterprise logins, this computer needs to be enrolled in a domain. Please have your network administrator type the domain password here, and choose a unique computer name for your computer."));
+  gtk_label_set_label (GTK_LABEL (priv->join_domain_label), _("_Domain"));
+  gtk_label_set_label (GTK_LABEL (priv->join_computer_label), _("_Computer"));
+  gtk_label_set_label (GTK_LABEL (priv->join_name_label), _("Administrator _Name"));
+  gtk_label_set_label (GTK_LABEL (priv->join_password_label), _("Administrator Password"));
+}
+
 void
 gis_account_page_enterprise_shown (GisAccountPageEnterprise *page)
 {
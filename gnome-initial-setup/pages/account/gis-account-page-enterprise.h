@@ -57,6 +57,7 @@ gboolean gis_account_page_enterprise_apply (GisAccountPageEnterprise *enterprise
                                             GisPageApplyCallback      callback,
                                             gpointer                  data);
 void     gis_account_page_enterprise_shown (GisAccountPageEnterprise *enterprise);
+void     gis_account_page_enterprise_locale_changed (GisAccountPageEnterprise *enterprise);
 
 G_END_DECLS
 
@@ -29,6 +29,7 @@
 #include <gio/gio.h>
 
 #include <string.h>
+#include <glib/gstdio.h>
 #include <act/act-user-manager.h>
 #include "um-utils.h"
 #include "um-photo-dialog.h"
@@ -36,11 +37,13 @@
 #define GOA_API_IS_SUBJECT_TO_CHANGE
 #include <goa/goa.h>
 
-#include <rest/oauth-proxy.h>
-#include <json-glib/json-glib.h>
+#include "gis-profile-fetcher.h"
 
 #define VALIDATION_TIMEOUT 600
 
+/* Size of the user icons AccountsService hands out to the shell and GDM */
+#define AVATAR_PIXEL_SIZE 96
+
 #define SHARED_ACCOUNT_USERNAME "shared"
 #define SHARED_ACCOUNT_FULLNAME "Shared Account"
 
@@ -48,26 +51,41 @@ struct _GisAccountPageLocalPrivate
 {
   GtkWidget *avatar_button;
   GtkWidget *avatar_image;
+  GtkWidget *title;
   GtkWidget *subtitle;
+  GtkWidget *fullname_label;
   GtkWidget *fullname_entry;
+  GtkWidget *username_label;
   GtkWidget *username_combo;
   GtkWidget *username_explanation;
+  GtkWidget *password_label;
   GtkWidget *password_switch;
   gboolean passwordless;
+  /* The name was filled in from an online account */
+  gboolean prefilled;
   UmPhotoDialog *photo_dialog;
 
   gint timeout_id;
 
+  GCancellable *choices_cancellable;
+  GCancellable *username_cancellable;
+
   GdkPixbuf *avatar_pixbuf;
   gchar *avatar_filename;
+  GCancellable *avatar_cancellable;
+  gchar *avatar_encoded_path;
 
   ActUser *act_user;
   ActUserManager *act_client;
 
   GoaClient *goa_client;
+  GCancellable *goa_cancellable;
+  GisProfileFetcher *profile_fetcher;
 
   gboolean valid_name;
   gboolean valid_username;
+  /* Enter was pressed while the username was still being checked */
+  gboolean confirm_requested;
   ActUserAccountType account_type;
 };
 typedef struct _GisAccountPageLocalPrivate GisAccountPageLocalPrivate;
@@ -90,151 +108,260 @@ validation_changed (GisAccountPageLocal *page)
   g_signal_emit (page, signals[VALIDATION_CHANGED], 0);
 }
 
-static gboolean
-get_profile_sync (const gchar        *access_token,
-                  gchar             **out_name,
-                  gchar             **out_picture,
-                  GCancellable       *cancellable,
-                  GError            **error)
-{
-  GError *identity_error;
-  RestProxy *proxy;
-  RestProxyCall *call;
-  JsonParser *parser;
-  JsonObject *json_object;
-  gboolean ret;
-
-  ret = FALSE;
-
-  identity_error = NULL;
-  proxy = NULL;
-  call = NULL;
-  parser = NULL;
-
-  /* TODO: cancellable */
-
-  proxy = rest_proxy_new ("https://www.googleapis.com/oauth2/v2/userinfo", FALSE);
-  call = rest_proxy_new_call (proxy);
-  rest_proxy_call_set_method (call, "GET");
-  rest_proxy_call_add_param (call, "access_token", access_token);
-
-  if (!rest_proxy_call_sync (call, error))
-    goto out;
+static void
+update_subtitle (GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
 
-  if (rest_proxy_call_get_status_code (call) != 200)
-    {
-      g_set_error (error,
-                   GOA_ERROR,
-                   GOA_ERROR_FAILED,
-                   "Expected status 200 when requesting your identity, instead got status %d (%s)",
-                   rest_proxy_call_get_status_code (call),
-                   rest_proxy_call_get_status_message (call));
-      goto out;
-    }
+  if (priv->prefilled)
+    gtk_label_set_text (GTK_LABEL (priv->subtitle), _("Please check the name and username. You can choose a picture too."));
+  else
+    gtk_label_set_text (GTK_LABEL (priv->subtitle), _("We need a few details to complete setup."));
+}
 
-  parser = json_parser_new ();
-  if (!json_parser_load_from_data (parser,
-                                   rest_proxy_call_get_payload (call),
-                                   rest_proxy_call_get_payload_length (call),
-                                   &identity_error))
-    {
-      g_warning ("json_parser_load_from_data() failed: %s (%s, %d)",
-                   identity_error->message,
-                   g_quark_to_string (identity_error->domain),
-                   identity_error->code);
-      g_set_error (error,
-                   GOA_ERROR,
-                   GOA_ERROR_FAILED,
-                   "Could not parse response");
-      goto out;
-    }
+static gchar *
+save_avatar_to_tmp_file (GdkPixbuf  *pixbuf,
+                         GError    **error)
+{
+  GFile *file;
+  GFileIOStream *io_stream = NULL;
+  GOutputStream *stream;
+  GdkPixbuf *scaled;
+  gint width, height;
+  gchar *path = NULL;
+
+  width = gdk_pixbuf_get_width (pixbuf);
+  height = gdk_pixbuf_get_height (pixbuf);
+
+  /* Anything bigger than what AccountsService shows is wasted space */
+  if (width > AVATAR_PIXEL_SIZE || height > AVATAR_PIXEL_SIZE) {
+    gdouble scale = (gdouble) AVATAR_PIXEL_SIZE / MAX (width, height);
+
+    scaled = gdk_pixbuf_scale_simple (pixbuf,
+                                      MAX (1, width * scale),
+                                      MAX (1, height * scale),
+                                      GDK_INTERP_BILINEAR);
+  } else {
+    scaled = g_object_ref (pixbuf);
+  }
 
-  ret = TRUE;
+  file = g_file_new_tmp ("usericonXXXXXX", &io_stream, error);
+  if (file == NULL)
+    goto out;
 
-  json_object = json_node_get_object (json_parser_get_root (parser));
-  if (out_name != NULL)
-    *out_name = g_strdup (json_object_get_string_member (json_object, "name"));
+  stream = g_io_stream_get_output_stream (G_IO_STREAM (io_stream));
+  if (!gdk_pixbuf_save_to_stream (scaled, stream, "png", NULL, error, NULL) ||
+      !g_io_stream_close (G_IO_STREAM (io_stream), NULL, error)) {
+    g_file_delete (file, NULL, NULL);
+    goto out;
+  }
 
-  if (out_picture != NULL)
-    *out_picture = g_strdup (json_object_get_string_member (json_object, "picture"));
+  path = g_file_get_path (file);
 
  out:
-  g_clear_error (&identity_error);
-  if (call != NULL)
-    g_object_unref (call);
-  if (proxy != NULL)
-    g_object_unref (proxy);
+  g_clear_object (&io_stream);
+  g_clear_object (&file);
+  g_object_unref (scaled);
 
-  return ret;
+  return path;
 }
 
 static void
-prepopulate_account_page (GisAccountPageLocal *page)
+encode_avatar_thread_func (GTask        *task,
+                           gpointer      source_object,
+                           gpointer      task_data,
+                           GCancellable *cancellable)
+{
+  GdkPixbuf *pixbuf = task_data;
+  GError *error = NULL;
+  gchar *path;
+
+  path = save_avatar_to_tmp_file (pixbuf, &error);
+  if (path == NULL)
+    g_task_return_error (task, error);
+  else
+    g_task_return_pointer (task, path, g_free);
+}
+
+static void
+avatar_encoded (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
 {
+  GisAccountPageLocal *page = GIS_ACCOUNT_PAGE_LOCAL (source);
   GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
-  gchar *name = NULL;
-  gchar *picture = NULL;
-  GdkPixbuf *pixbuf = NULL;
-
-  if (priv->goa_client) {
-    GList *accounts, *l;
-    accounts = goa_client_get_accounts (priv->goa_client);
-    for (l = accounts; l != NULL; l = l->next) {
-      GoaOAuth2Based *oa2;
-      oa2 = goa_object_get_oauth2_based (GOA_OBJECT (l->data));
-      if (oa2) {
-        gchar *token = NULL;
-        GError *error = NULL;
-        if (!goa_oauth2_based_call_get_access_token_sync (oa2, &token, NULL, NULL, &error))
-          {
-            g_warning ("Couldn't get oauth2 token: %s\n", error->message);
-            g_error_free (error);
-          }
-        else if (!get_profile_sync (token, &name, &picture, NULL, &error))
-          {
-            g_warning ("Couldn't get profile information: %s\n", error->message);
-            g_error_free (error);
-          }
-        /* FIXME: collect information from more than one account
-         * and present at least the pictures in the avatar chooser
-         */
-        break;
-      }
-    }
-    g_list_free_full (accounts, (GDestroyNotify) g_object_unref);
+  GError *error = NULL;
+  gchar *path;
+
+  path = g_task_propagate_pointer (G_TASK (result), &error);
+  if (path == NULL) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("failed to save image: %s", error->message);
+    g_error_free (error);
+    return;
   }
 
-  if (name) {
-    gtk_label_set_text (GTK_LABEL (priv->subtitle), _("Please check the name and username. You can choose a picture too."));
-    gtk_entry_set_text (GTK_ENTRY (priv->fullname_entry), name);
+  /* Another avatar was picked meanwhile, or we are done */
+  if (g_cancellable_is_cancelled (g_task_get_cancellable (G_TASK (result)))) {
+    g_unlink (path);
+    g_free (path);
+    return;
   }
 
-  if (picture) {
-    GFile *file;
-    GFileInputStream *stream;
-    GError *error = NULL;
-    file = g_file_new_for_uri (picture);
-    stream = g_file_read (file, NULL, &error);
-    if (!stream)
-      {
-        g_warning ("Failed to read picture: %s\n", error->message);
-        g_error_free (error);
-      }
-    else
-      {
-        pixbuf = gdk_pixbuf_new_from_stream_at_scale (G_INPUT_STREAM (stream), -1, 96, TRUE, NULL, NULL);
-        g_object_unref (stream);
-      }
-    g_object_unref (file);
+  g_clear_object (&priv->avatar_cancellable);
+  priv->avatar_encoded_path = path;
+}
+
+static void
+clear_encoded_avatar (GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+
+  if (priv->avatar_cancellable)
+    g_cancellable_cancel (priv->avatar_cancellable);
+  g_clear_object (&priv->avatar_cancellable);
+
+  if (priv->avatar_encoded_path) {
+    g_unlink (priv->avatar_encoded_path);
+    g_clear_pointer (&priv->avatar_encoded_path, g_free);
   }
+}
 
-  if (pixbuf) {
+/* Scale and encode the avatar as soon as it is chosen, so that creating
+ * the user only has to hand AccountsService a file name. */
+static void
+encode_avatar (GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+  GTask *task;
+
+  clear_encoded_avatar (page);
+
+  if (priv->avatar_pixbuf == NULL)
+    return;
+
+  priv->avatar_cancellable = g_cancellable_new ();
+
+  task = g_task_new (page, priv->avatar_cancellable, avatar_encoded, NULL);
+  /* Always get the file back, even once cancelled, so that it can be
+   * removed again. */
+  g_task_set_check_cancellable (task, FALSE);
+  g_task_set_task_data (task, g_object_ref (priv->avatar_pixbuf), g_object_unref);
+  g_task_run_in_thread (task, encode_avatar_thread_func);
+  g_object_unref (task);
+}
+
+/* Give up on prefilling the page after this many seconds */
+#define PROFILE_FETCH_TIMEOUT 15
+
+static void
+profile_name_ready (GisProfileFetcher   *fetcher,
+                    const gchar         *name,
+                    GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+
+  /* The user may have started typing while we were waiting */
+  if (*gtk_entry_get_text (GTK_ENTRY (priv->fullname_entry)) == '\0') {
+    priv->prefilled = TRUE;
+    update_subtitle (page);
+    gtk_entry_set_text (GTK_ENTRY (priv->fullname_entry), name);
+  }
+}
+
+static void
+profile_picture_ready (GisProfileFetcher   *fetcher,
+                       GdkPixbuf           *pixbuf,
+                       GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+
+  /* Don't replace an avatar the user already picked, or the picture
+   * of another account that got here first */
+  if (priv->avatar_pixbuf == NULL && priv->avatar_filename == NULL) {
     gtk_image_set_from_pixbuf (GTK_IMAGE (priv->avatar_image), pixbuf);
-    priv->avatar_pixbuf = pixbuf;
+    priv->avatar_pixbuf = g_object_ref (pixbuf);
+    encode_avatar (page);
   }
+}
+
+static void
+access_token_ready (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  GisProfileFetcher *fetcher = user_data;
+  gchar *token = NULL;
+  GError *error = NULL;
+
+  if (!goa_oauth2_based_call_get_access_token_finish (GOA_OAUTH2_BASED (source),
+                                                      &token, NULL, result, &error)) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Couldn't get oauth2 token: %s", error->message);
+    g_error_free (error);
+  }
+
+  /* Gives the hold back even without a token */
+  gis_profile_fetcher_fetch (fetcher, token);
+
+  g_free (token);
+  g_object_unref (fetcher);
+}
+
+static void
+cancel_prepopulate (GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+
+  if (priv->profile_fetcher == NULL)
+    return;
+
+  g_signal_handlers_disconnect_by_data (priv->profile_fetcher, page);
+  gis_profile_fetcher_cancel (priv->profile_fetcher);
+  g_clear_object (&priv->profile_fetcher);
+}
+
+static void
+prepopulate_account_page (GisAccountPageLocal *page)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+  GList *accounts, *l;
+
+  cancel_prepopulate (page);
+
+  if (priv->goa_client == NULL)
+    return;
 
-  g_free (name);
-  g_free (picture);
+  priv->profile_fetcher = gis_profile_fetcher_new (PROFILE_FETCH_TIMEOUT);
+  g_signal_connect (priv->profile_fetcher, "name-ready",
+                    G_CALLBACK (profile_name_ready), page);
+  g_signal_connect (priv->profile_fetcher, "picture-ready",
+                    G_CALLBACK (profile_picture_ready), page);
+
+  /* Ask all Google accounts at once; whichever answers first fills in
+   * the name and the avatar. The userinfo endpoint is Google's, so the
+   * tokens of other providers must never be sent there. */
+  accounts = goa_client_get_accounts (priv->goa_client);
+  for (l = accounts; l != NULL; l = l->next) {
+    GoaOAuth2Based *oa2;
+    GoaAccount *account;
+
+    account = goa_object_peek_account (GOA_OBJECT (l->data));
+    if (account == NULL ||
+        g_strcmp0 (goa_account_get_provider_type (account), "google") != 0)
+      continue;
+
+    oa2 = goa_object_get_oauth2_based (GOA_OBJECT (l->data));
+    if (oa2) {
+      gis_profile_fetcher_hold (priv->profile_fetcher);
+      goa_oauth2_based_call_get_access_token (oa2,
+                                              gis_profile_fetcher_get_cancellable (priv->profile_fetcher),
+                                              access_token_ready,
+                                              g_object_ref (priv->profile_fetcher));
+      g_object_unref (oa2);
+    }
+  }
+  g_list_free_full (accounts, (GDestroyNotify) g_object_unref);
 }
 
 static void
@@ -245,21 +372,82 @@ accounts_changed (GoaClient *client, GoaObject *object, gpointer data)
   prepopulate_account_page (page);
 }
 
+static void
+goa_client_ready (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  GisAccountPageLocal *page = user_data;
+  GisAccountPageLocalPrivate *priv;
+  GoaClient *client;
+  GError *error = NULL;
+
+  client = goa_client_new_finish (result, &error);
+  if (client == NULL) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+      g_warning ("Failed to get a GOA client: %s", error->message);
+    g_error_free (error);
+    return;
+  }
+
+  priv = gis_account_page_local_get_instance_private (page);
+  priv->goa_client = client;
+  g_signal_connect (priv->goa_client, "account-added",
+                    G_CALLBACK (accounts_changed), page);
+  g_signal_connect (priv->goa_client, "account-removed",
+                    G_CALLBACK (accounts_changed), page);
+  prepopulate_account_page (page);
+}
+
+static void confirm (GisAccountPageLocal *page);
+
+static void
+username_validated (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  GisAccountPageLocal *page = user_data;
+  GisAccountPageLocalPrivate *priv;
+  GtkWidget *entry;
+  gboolean valid;
+  gchar *tip;
+  GError *error = NULL;
+
+  if (!is_valid_username_finish (result, &valid, &tip, &error)) {
+    /* Superseded by a newer check; the page may be gone already */
+    g_error_free (error);
+    return;
+  }
+
+  priv = gis_account_page_local_get_instance_private (page);
+  g_clear_object (&priv->username_cancellable);
+
+  priv->valid_username = valid;
+  if (priv->valid_username) {
+    entry = gtk_bin_get_child (GTK_BIN (priv->username_combo));
+    set_entry_validation_checkmark (GTK_ENTRY (entry));
+  }
+
+  gtk_label_set_text (GTK_LABEL (priv->username_explanation), tip);
+  g_free (tip);
+
+  validation_changed (page);
+
+  if (priv->confirm_requested)
+    confirm (page);
+}
+
 static gboolean
 validate (GisAccountPageLocal *page)
 {
   GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
-  GtkWidget *entry;
   const gchar *name, *username;
-  gchar *tip;
 
   if (priv->timeout_id != 0) {
     g_source_remove (priv->timeout_id);
     priv->timeout_id = 0;
   }
 
-  entry = gtk_bin_get_child (GTK_BIN (priv->username_combo));
-
   name = gtk_entry_get_text (GTK_ENTRY (priv->fullname_entry));
   username = gtk_combo_box_text_get_active_text (GTK_COMBO_BOX_TEXT (priv->username_combo));
 
@@ -267,12 +455,14 @@ validate (GisAccountPageLocal *page)
   if (priv->valid_name)
     set_entry_validation_checkmark (GTK_ENTRY (priv->fullname_entry));
 
-  priv->valid_username = is_valid_username (username, &tip);
-  if (priv->valid_username)
-    set_entry_validation_checkmark (GTK_ENTRY (entry));
-
-  gtk_label_set_text (GTK_LABEL (priv->username_explanation), tip);
-  g_free (tip);
+  /* Checking whether the username is taken goes through NSS, which can
+   * block for a long time, so it is done in a thread. */
+  if (priv->username_cancellable)
+    g_cancellable_cancel (priv->username_cancellable);
+  g_clear_object (&priv->username_cancellable);
+  priv->username_cancellable = g_cancellable_new ();
+  is_valid_username_async (username, priv->username_cancellable,
+                           username_validated, page);
 
   priv->passwordless = !gtk_switch_get_active (GTK_SWITCH (priv->password_switch));
 
@@ -289,6 +479,38 @@ on_focusout (GisAccountPageLocal *page)
   return FALSE;
 }
 
+static void
+username_choices_ready (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  GisAccountPageLocal *page = user_data;
+  GisAccountPageLocalPrivate *priv;
+  GtkTreeModel *model;
+  const gchar *name;
+  GError *error = NULL;
+
+  if (g_task_had_error (G_TASK (result))) {
+    /* Superseded by a newer name; the page may be gone already */
+    g_task_propagate_pointer (G_TASK (result), &error);
+    g_error_free (error);
+    return;
+  }
+
+  priv = gis_account_page_local_get_instance_private (page);
+  g_clear_object (&priv->choices_cancellable);
+
+  model = gtk_combo_box_get_model (GTK_COMBO_BOX (priv->username_combo));
+  if (!generate_username_choices_finish (result, GTK_LIST_STORE (model), NULL))
+    return;
+
+  name = gtk_entry_get_text (GTK_ENTRY (priv->fullname_entry));
+  if (strlen (name) > 0)
+    gtk_combo_box_set_active (GTK_COMBO_BOX (priv->username_combo), 0);
+
+  /* username_changed() is called consequently due to changes */
+}
+
 static void
 fullname_changed (GtkWidget      *w,
                   GParamSpec     *pspec,
@@ -306,18 +528,22 @@ fullname_changed (GtkWidget      *w,
 
   gtk_list_store_clear (GTK_LIST_STORE (model));
 
-  if (strlen (name) == 0) {
+  if (strlen (name) == 0)
     gtk_entry_set_text (GTK_ENTRY (entry), "");
-    generate_username_choices ("", GTK_LIST_STORE (model));
-  }
-  else {
-    generate_username_choices (name, GTK_LIST_STORE (model));
-    gtk_combo_box_set_active (GTK_COMBO_BOX (priv->username_combo), 0);
-  }
+
+  /* Candidates are checked against NSS in a thread; drop the lookups for
+   * whatever the name was a keystroke ago. */
+  if (priv->choices_cancellable)
+    g_cancellable_cancel (priv->choices_cancellable);
+  g_clear_object (&priv->choices_cancellable);
+  priv->choices_cancellable = g_cancellable_new ();
+  generate_username_choices_async (name, priv->choices_cancellable,
+                                   username_choices_ready, page);
 
   clear_entry_validation_error (GTK_ENTRY (w));
 
   priv->valid_name = FALSE;
+  priv->confirm_requested = FALSE;
 
   /* username_changed() is called consequently due to changes */
 }
@@ -369,13 +595,25 @@ avatar_callback (GdkPixbuf   *pixbuf,
     gtk_image_set_pixel_size (GTK_IMAGE (priv->avatar_image), 96);
     gtk_image_set_from_icon_name (GTK_IMAGE (priv->avatar_image), "avatar-default-symbolic", 1);
   }
+
+  encode_avatar (page);
 }
 
 static void
 confirm (GisAccountPageLocal *page)
 {
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
+
+  priv->confirm_requested = FALSE;
+
   if (gis_account_page_local_validate (page))
     g_signal_emit (page, signals[CONFIRM], 0);
+  else if (priv->username_cancellable != NULL ||
+           priv->choices_cancellable != NULL ||
+           priv->timeout_id != 0)
+    /* The username is not checked yet; username_validated() confirms
+     * once it is, if it turns out valid. */
+    priv->confirm_requested = TRUE;
 }
 
 static void
@@ -411,21 +649,15 @@ gis_account_page_local_constructed (GObject *object)
   /* FIXME: change this for a large deployment scenario; maybe through a GSetting? */
   priv->account_type = ACT_USER_ACCOUNT_TYPE_ADMINISTRATOR;
 
-  gtk_label_set_text (GTK_LABEL (priv->subtitle), _("We need a few details to complete setup."));
+  update_subtitle (page);
   gtk_entry_set_text (GTK_ENTRY (priv->fullname_entry), "");
   gtk_list_store_clear (GTK_LIST_STORE (gtk_combo_box_get_model (GTK_COMBO_BOX (priv->username_combo))));
 
   gtk_image_set_pixel_size (GTK_IMAGE (priv->avatar_image), 96);
   gtk_image_set_from_icon_name (GTK_IMAGE (priv->avatar_image), "avatar-default-symbolic", 1);
 
-  priv->goa_client = goa_client_new_sync (NULL, NULL);
-  if (priv->goa_client) {
-    g_signal_connect (priv->goa_client, "account-added",
-                      G_CALLBACK (accounts_changed), page);
-    g_signal_connect (priv->goa_client, "account-removed",
-                      G_CALLBACK (accounts_changed), page);
-    prepopulate_account_page (page);
-  }
+  priv->goa_cancellable = g_cancellable_new ();
+  goa_client_new (priv->goa_cancellable, goa_client_ready, page);
 
   priv->photo_dialog = um_photo_dialog_new (priv->avatar_button,
                                             avatar_callback,
@@ -440,11 +672,25 @@ gis_account_page_local_dispose (GObject *object)
   GisAccountPageLocal *page = GIS_ACCOUNT_PAGE_LOCAL (object);
   GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
 
+  cancel_prepopulate (page);
+  if (priv->goa_cancellable)
+    g_cancellable_cancel (priv->goa_cancellable);
+  g_clear_object (&priv->goa_cancellable);
+  if (priv->goa_client)
+    g_signal_handlers_disconnect_by_func (priv->goa_client, accounts_changed, page);
   g_clear_object (&priv->goa_client);
+  clear_encoded_avatar (page);
   g_clear_object (&priv->avatar_pixbuf);
   g_clear_pointer (&priv->avatar_filename, g_free);
   g_clear_pointer (&priv->photo_dialog, um_photo_dialog_free);
 
+  if (priv->choices_cancellable)
+    g_cancellable_cancel (priv->choices_cancellable);
+  g_clear_object (&priv->choices_cancellable);
+  if (priv->username_cancellable)
+    g_cancellable_cancel (priv->username_cancellable);
+  g_clear_object (&priv->username_cancellable);
+
   if (priv->timeout_id != 0) {
     g_source_remove (priv->timeout_id);
     priv->timeout_id = 0;
@@ -457,9 +703,6 @@ static void
 set_user_avatar (GisAccountPageLocal *page)
 {
   GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (page);
-  GFile *file = NULL;
-  GFileIOStream *io_stream = NULL;
-  GOutputStream *stream = NULL;
   GError *error = NULL;
 
   if (priv->avatar_filename != NULL) {
@@ -471,23 +714,20 @@ set_user_avatar (GisAccountPageLocal *page)
     return;
   }
 
-  file = g_file_new_tmp ("usericonXXXXXX", &io_stream, &error);
-  if (error != NULL)
-    goto out;
-
-  stream = g_io_stream_get_output_stream (G_IO_STREAM (io_stream));
-  if (!gdk_pixbuf_save_to_stream (priv->avatar_pixbuf, stream, "png", NULL, &error, NULL))
-    goto out;
-
-  act_user_set_icon_file (priv->act_user, g_file_get_path (file));
-
- out:
-  if (error != NULL) {
-    g_warning ("failed to save image: %s", error->message);
-    g_error_free (error);
+  /* Normally this was done in the background already */
+  if (priv->avatar_encoded_path == NULL) {
+    clear_encoded_avatar (page);
+    priv->avatar_encoded_path = save_avatar_to_tmp_file (priv->avatar_pixbuf, &error);
+    if (priv->avatar_encoded_path == NULL) {
+      g_warning ("failed to save image: %s", error->message);
+      g_error_free (error);
+      return;
+    }
   }
-  g_clear_object (&io_stream);
-  g_clear_object (&file);
+
+  /* AccountsService copies the file, so we can get rid of it right away */
+  act_user_set_icon_file (priv->act_user, priv->avatar_encoded_path);
+  clear_encoded_avatar (page);
 }
 
 static void
@@ -536,6 +776,9 @@ local_create_user (GisAccountPageLocal *page)
     return;
   }
 
+  /* The name we cached as free no longer is */
+  clear_username_cache ();
+
   act_user_set_user_name (priv->act_user, username);
   act_user_set_account_type (priv->act_user, priv->account_type);
 
@@ -556,10 +799,14 @@ gis_account_page_local_class_init (GisAccountPageLocalClass *klass)
 
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, avatar_button);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, avatar_image);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, title);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, subtitle);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, fullname_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, fullname_entry);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, username_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, username_combo);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, username_explanation);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, password_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisAccountPageLocal, password_switch);
 
   object_class->constructed = gis_account_page_local_constructed;
@@ -614,6 +861,22 @@ gis_account_page_local_apply (GisAccountPageLocal *local, GisPage *page)
   return FALSE;
 }
 
+void
+gis_account_page_local_locale_changed (GisAccountPageLocal *local)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (local);
+
+  atk_object_set_name (gtk_widget_get_accessible (priv->avatar_button), _("Avatar image"));
+  gtk_label_set_label (GTK_LABEL (priv->title), _("About You"));
+  update_subtitle (local);
+  gtk_label_set_label (GTK_LABEL (priv->fullname_label), _("_Full Name"));
+  gtk_label_set_label (GTK_LABEL (priv->username_label), _("_Username"));
+  gtk_label_set_label (GTK_LABEL (priv->password_label), _("Password protected"));
+
+  /* The username tip comes from the username check */
+  validate (local);
+}
+
 void
 gis_account_page_local_shown (GisAccountPageLocal *local)
 {
@@ -627,3 +890,31 @@ gis_account_page_local_is_passwordless (GisAccountPageLocal *local)
   GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (local);
   return priv->passwordless;
 }
+
+/* Fills in the form from an answer file, without waiting for the
+ * typing delay or letting GOA and the username suggestions overwrite it.
+ */
+void
+gis_account_page_local_set_user (GisAccountPageLocal *local,
+                                 const gchar         *fullname,
+                                 const gchar         *username,
+                                 gboolean             passwordless)
+{
+  GisAccountPageLocalPrivate *priv = gis_account_page_local_get_instance_private (local);
+  GtkWidget *entry;
+
+  cancel_prepopulate (local);
+
+  gtk_entry_set_text (GTK_ENTRY (priv->fullname_entry), fullname);
+
+  if (priv->choices_cancellable)
+    g_cancellable_cancel (priv->choices_cancellable);
+  g_clear_object (&priv->choices_cancellable);
+
+  entry = gtk_bin_get_child (GTK_BIN (priv->username_combo));
+  gtk_entry_set_text (GTK_ENTRY (entry), username);
+
+  gtk_switch_set_active (GTK_SWITCH (priv->password_switch), !passwordless);
+
+  validate (local);
+}
@@ -52,7 +52,12 @@ gboolean gis_account_page_local_validate (GisAccountPageLocal *local);
 gboolean gis_account_page_local_apply (GisAccountPageLocal *local, GisPage *page);
 void gis_account_page_local_create_user (GisAccountPageLocal *local);
 void gis_account_page_local_shown (GisAccountPageLocal *local);
+void gis_account_page_local_locale_changed (GisAccountPageLocal *local);
 gboolean gis_account_page_local_is_passwordless (GisAccountPageLocal *local);
+void gis_account_page_local_set_user (GisAccountPageLocal *local,
+                                      const gchar         *fullname,
+                                      const gchar         *username,
+                                      gboolean             passwordless);
 
 G_END_DECLS
 
@@ -281,7 +281,14 @@ gis_account_page_constructed (GObject *object)
 static void
 gis_account_page_locale_changed (GisPage *page)
 {
+  GisAccountPage *account_page = GIS_ACCOUNT_PAGE (page);
+  GisAccountPagePrivate *priv = gis_account_page_get_instance_private (account_page);
+
   gis_page_set_title (GIS_PAGE (page), _("About You"));
+  gtk_button_set_label (GTK_BUTTON (priv->page_toggle), _("Set Up _Enterprise Login"));
+
+  gis_account_page_local_locale_changed (GIS_ACCOUNT_PAGE_LOCAL (priv->page_local));
+  gis_account_page_enterprise_locale_changed (GIS_ACCOUNT_PAGE_ENTERPRISE (priv->page_enterprise));
 }
 
 static GtkAccelGroup *
@@ -293,6 +300,40 @@ gis_account_page_get_accel_group (GisPage *page)
   return priv->accel_group;
 }
 
+static gboolean
+gis_account_page_apply_answers (GisPage      *page,
+                                GKeyFile     *answers,
+                                const gchar  *group,
+                                GError      **error)
+{
+  GisAccountPagePrivate *priv = gis_account_page_get_instance_private (GIS_ACCOUNT_PAGE (page));
+  gchar *fullname = NULL;
+  gchar *username = NULL;
+  gboolean passwordless;
+  gboolean ret = FALSE;
+
+  fullname = g_key_file_get_string (answers, group, "fullname", error);
+  if (fullname == NULL)
+    goto out;
+
+  username = g_key_file_get_string (answers, group, "username", error);
+  if (username == NULL)
+    goto out;
+
+  /* Missing or malformed means the default, a password */
+  passwordless = g_key_file_get_boolean (answers, group, "passwordless", NULL);
+
+  set_mode (GIS_ACCOUNT_PAGE (page), UM_LOCAL);
+  gis_account_page_local_set_user (GIS_ACCOUNT_PAGE_LOCAL (priv->page_local),
+                                   fullname, username, passwordless);
+  ret = TRUE;
+
+ out:
+  g_free (fullname);
+  g_free (username);
+  return ret;
+}
+
 static void
 gis_account_page_class_init (GisAccountPageClass *klass)
 {
@@ -313,6 +354,7 @@ gis_account_page_class_init (GisAccountPageClass *klass)
   page_class->apply = gis_account_page_apply;
   page_class->save_data = gis_account_page_save_data;
   page_class->shown = gis_account_page_shown;
+  page_class->apply_answers = gis_account_page_apply_answers;
   object_class->constructed = gis_account_page_constructed;
 }
 
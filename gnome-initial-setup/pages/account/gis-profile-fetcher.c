@@ -0,0 +1,426 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Fetches the name and picture of a Google account's owner, for the
+ * account page to fill itself in with.
+ *
+ * Every access token handed in is looked up at the userinfo endpoint;
+ * ::name-ready and ::picture-ready are emitted for each answer. The
+ * whole lot is given up on, and the fetcher cancelled, if it is not
+ * done within the timeout. Disposing of the fetcher cancels it too.
+ */
+
+#include "config.h"
+
+#include "gis-profile-fetcher.h"
+
+#include <rest/rest-proxy.h>
+#include <json-glib/json-glib.h>
+
+/* The userinfo endpoint can be pointed at a local stand-in server with
+ * GIS_GOA_USERINFO_URL for testing. */
+#define DEFAULT_USERINFO_URL "https://www.googleapis.com/oauth2/v2/userinfo"
+
+/* Same as the avatar size on the account page */
+#define PICTURE_PIXEL_SIZE 96
+
+struct _GisProfileFetcherPrivate
+{
+  GCancellable *cancellable;
+  guint timeout;
+  guint timeout_id;
+  /* tokens on their way, and lookups not finished yet */
+  guint pending;
+};
+typedef struct _GisProfileFetcherPrivate GisProfileFetcherPrivate;
+
+G_DEFINE_TYPE_WITH_PRIVATE (GisProfileFetcher, gis_profile_fetcher, G_TYPE_OBJECT);
+
+enum {
+  NAME_READY,
+  PICTURE_READY,
+  LAST_SIGNAL,
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+typedef struct {
+  GisProfileFetcher *fetcher;
+  GCancellable *cancellable;
+  RestProxy *proxy;
+} Fetch;
+
+static void
+release (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  if (--priv->pending == 0 && priv->timeout_id != 0)
+    {
+      g_source_remove (priv->timeout_id);
+      priv->timeout_id = 0;
+    }
+}
+
+static Fetch *
+fetch_new (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+  Fetch *fetch;
+
+  fetch = g_slice_new0 (Fetch);
+  fetch->fetcher = fetcher;
+  fetch->cancellable = g_object_ref (priv->cancellable);
+
+  return fetch;
+}
+
+static void
+fetch_free (Fetch *fetch)
+{
+  /* Once cancelled, the fetcher may not be around anymore */
+  if (!g_cancellable_is_cancelled (fetch->cancellable))
+    release (fetch->fetcher);
+
+  g_clear_object (&fetch->proxy);
+  g_object_unref (fetch->cancellable);
+  g_slice_free (Fetch, fetch);
+}
+
+static void
+fetch_failed (Fetch       *fetch,
+              const gchar *what,
+              GError      *error)
+{
+  if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    g_warning ("%s: %s", what, error->message);
+
+  g_error_free (error);
+  fetch_free (fetch);
+}
+
+static gboolean
+parse_profile (RestProxyCall  *call,
+               gchar         **out_name,
+               gchar         **out_picture,
+               GError        **error)
+{
+  JsonParser *parser;
+  JsonObject *json_object;
+  JsonNode *root;
+  gboolean ret = FALSE;
+
+  if (rest_proxy_call_get_status_code (call) != 200)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                   "Expected status 200 when requesting your identity, instead got status %d (%s)",
+                   rest_proxy_call_get_status_code (call),
+                   rest_proxy_call_get_status_message (call));
+      return FALSE;
+    }
+
+  parser = json_parser_new ();
+  if (!json_parser_load_from_data (parser,
+                                   rest_proxy_call_get_payload (call),
+                                   rest_proxy_call_get_payload_length (call),
+                                   error))
+    goto out;
+
+  root = json_parser_get_root (parser);
+  if (root == NULL || !JSON_NODE_HOLDS_OBJECT (root))
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                   "Could not parse response");
+      goto out;
+    }
+
+  ret = TRUE;
+
+  json_object = json_node_get_object (root);
+  if (json_object_has_member (json_object, "name"))
+    *out_name = g_strdup (json_object_get_string_member (json_object, "name"));
+  if (json_object_has_member (json_object, "picture"))
+    *out_picture = g_strdup (json_object_get_string_member (json_object, "picture"));
+
+ out:
+  g_object_unref (parser);
+
+  return ret;
+}
+
+static void
+picture_ready (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  Fetch *fetch = user_data;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  pixbuf = gdk_pixbuf_new_from_stream_finish (result, &error);
+  if (pixbuf == NULL)
+    {
+      fetch_failed (fetch, "Failed to load picture", error);
+      return;
+    }
+
+  if (!g_cancellable_is_cancelled (fetch->cancellable))
+    g_signal_emit (fetch->fetcher, signals[PICTURE_READY], 0, pixbuf);
+
+  g_object_unref (pixbuf);
+  fetch_free (fetch);
+}
+
+/* The picture is downloaded the same way as the profile, rather than
+ * through GFile, so that it doesn't depend on gvfs being around. */
+static void
+picture_downloaded (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  Fetch *fetch = user_data;
+  RestProxyCall *call = REST_PROXY_CALL (source);
+  GInputStream *stream;
+  GError *error = NULL;
+
+  if (!rest_proxy_call_invoke_finish (call, result, &error))
+    {
+      g_object_unref (call);
+      fetch_failed (fetch, "Failed to download picture", error);
+      return;
+    }
+
+  if (rest_proxy_call_get_status_code (call) != 200)
+    {
+      g_warning ("Failed to download picture: status %d (%s)",
+                 rest_proxy_call_get_status_code (call),
+                 rest_proxy_call_get_status_message (call));
+      g_object_unref (call);
+      fetch_free (fetch);
+      return;
+    }
+
+  stream = g_memory_input_stream_new_from_data (g_memdup (rest_proxy_call_get_payload (call),
+                                                          rest_proxy_call_get_payload_length (call)),
+                                                rest_proxy_call_get_payload_length (call),
+                                                g_free);
+  g_object_unref (call);
+
+  gdk_pixbuf_new_from_stream_at_scale_async (stream, -1, PICTURE_PIXEL_SIZE, TRUE,
+                                             fetch->cancellable, picture_ready, fetch);
+  g_object_unref (stream);
+}
+
+static void
+profile_ready (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+  Fetch *fetch = user_data;
+  RestProxyCall *call = REST_PROXY_CALL (source);
+  gchar *name = NULL;
+  gchar *picture = NULL;
+  GError *error = NULL;
+
+  if (!rest_proxy_call_invoke_finish (call, result, &error) ||
+      !parse_profile (call, &name, &picture, &error))
+    {
+      g_object_unref (call);
+      fetch_failed (fetch, "Couldn't get profile information", error);
+      return;
+    }
+  g_object_unref (call);
+
+  if (g_cancellable_is_cancelled (fetch->cancellable))
+    goto out;
+
+  if (name != NULL && *name != '\0')
+    g_signal_emit (fetch->fetcher, signals[NAME_READY], 0, name);
+
+  if (picture != NULL && *picture != '\0')
+    {
+      g_object_unref (fetch->proxy);
+      fetch->proxy = rest_proxy_new (picture, FALSE);
+      call = rest_proxy_new_call (fetch->proxy);
+      rest_proxy_call_set_method (call, "GET");
+      rest_proxy_call_invoke_async (call, fetch->cancellable, picture_downloaded, fetch);
+
+      fetch = NULL;
+    }
+
+ out:
+  g_free (name);
+  g_free (picture);
+  if (fetch != NULL)
+    fetch_free (fetch);
+}
+
+static gboolean
+fetch_timeout (gpointer user_data)
+{
+  GisProfileFetcher *fetcher = user_data;
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  g_warning ("Timed out fetching online account profiles");
+
+  priv->timeout_id = 0;
+  gis_profile_fetcher_cancel (fetcher);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Announces an access token that is on its way, so that the time it
+ * takes to get it counts towards the timeout. Every hold is given back
+ * by a call to gis_profile_fetcher_fetch().
+ */
+void
+gis_profile_fetcher_hold (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  if (g_cancellable_is_cancelled (priv->cancellable))
+    return;
+
+  if (priv->pending++ == 0 && priv->timeout_id == 0)
+    priv->timeout_id = g_timeout_add_seconds (priv->timeout, fetch_timeout, fetcher);
+}
+
+/* Looks up the owner of @access_token, or just gives back the hold if
+ * the token could not be had and @access_token is %NULL.
+ */
+void
+gis_profile_fetcher_fetch (GisProfileFetcher *fetcher,
+                           const gchar       *access_token)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+  RestProxyCall *call;
+  const gchar *url;
+  Fetch *fetch;
+
+  if (g_cancellable_is_cancelled (priv->cancellable))
+    return;
+
+  if (access_token == NULL)
+    {
+      release (fetcher);
+      return;
+    }
+
+  url = g_getenv ("GIS_GOA_USERINFO_URL");
+  if (url == NULL)
+    url = DEFAULT_USERINFO_URL;
+
+  fetch = fetch_new (fetcher);
+  fetch->proxy = rest_proxy_new (url, FALSE);
+  call = rest_proxy_new_call (fetch->proxy);
+  rest_proxy_call_set_method (call, "GET");
+  rest_proxy_call_add_param (call, "access_token", access_token);
+  rest_proxy_call_invoke_async (call, fetch->cancellable, profile_ready, fetch);
+}
+
+/* Cancelled on the timeout and on dispose; fetchers are not reused */
+GCancellable *
+gis_profile_fetcher_get_cancellable (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  return priv->cancellable;
+}
+
+void
+gis_profile_fetcher_cancel (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  g_cancellable_cancel (priv->cancellable);
+
+  if (priv->timeout_id != 0)
+    {
+      g_source_remove (priv->timeout_id);
+      priv->timeout_id = 0;
+    }
+  priv->pending = 0;
+}
+
+static void
+gis_profile_fetcher_dispose (GObject *object)
+{
+  GisProfileFetcher *fetcher = GIS_PROFILE_FETCHER (object);
+
+  gis_profile_fetcher_cancel (fetcher);
+
+  G_OBJECT_CLASS (gis_profile_fetcher_parent_class)->dispose (object);
+}
+
+static void
+gis_profile_fetcher_finalize (GObject *object)
+{
+  GisProfileFetcher *fetcher = GIS_PROFILE_FETCHER (object);
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  g_object_unref (priv->cancellable);
+
+  G_OBJECT_CLASS (gis_profile_fetcher_parent_class)->finalize (object);
+}
+
+static void
+gis_profile_fetcher_class_init (GisProfileFetcherClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+
+  object_class->dispose = gis_profile_fetcher_dispose;
+  object_class->finalize = gis_profile_fetcher_finalize;
+
+  signals[NAME_READY] =
+    g_signal_new ("name-ready",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, G_TYPE_STRING);
+
+  signals[PICTURE_READY] =
+    g_signal_new ("picture-ready",
+                  G_TYPE_FROM_CLASS (klass),
+                  G_SIGNAL_RUN_LAST,
+                  0,
+                  NULL, NULL, NULL,
+                  G_TYPE_NONE, 1, GDK_TYPE_PIXBUF);
+}
+
+static void
+gis_profile_fetcher_init (GisProfileFetcher *fetcher)
+{
+  GisProfileFetcherPrivate *priv = gis_profile_fetcher_get_instance_private (fetcher);
+
+  priv->cancellable = g_cancellable_new ();
+}
+
+/* @timeout is in seconds, counted from the first hold */
+GisProfileFetcher *
+gis_profile_fetcher_new (guint timeout)
+{
+  GisProfileFetcher *fetcher;
+  GisProfileFetcherPrivate *priv;
+
+  fetcher = g_object_new (GIS_TYPE_PROFILE_FETCHER, NULL);
+  priv = gis_profile_fetcher_get_instance_private (fetcher);
+  priv->timeout = timeout;
+
+  return fetcher;
+}
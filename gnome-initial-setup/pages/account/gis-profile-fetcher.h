@@ -0,0 +1,60 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GIS_PROFILE_FETCHER_H__
+#define __GIS_PROFILE_FETCHER_H__
+
+#include <gio/gio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+#define GIS_TYPE_PROFILE_FETCHER               (gis_profile_fetcher_get_type ())
+#define GIS_PROFILE_FETCHER(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), GIS_TYPE_PROFILE_FETCHER, GisProfileFetcher))
+#define GIS_PROFILE_FETCHER_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass),  GIS_TYPE_PROFILE_FETCHER, GisProfileFetcherClass))
+#define GIS_IS_PROFILE_FETCHER(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), GIS_TYPE_PROFILE_FETCHER))
+#define GIS_IS_PROFILE_FETCHER_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass),  GIS_TYPE_PROFILE_FETCHER))
+#define GIS_PROFILE_FETCHER_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj),  GIS_TYPE_PROFILE_FETCHER, GisProfileFetcherClass))
+
+typedef struct _GisProfileFetcher        GisProfileFetcher;
+typedef struct _GisProfileFetcherClass   GisProfileFetcherClass;
+
+struct _GisProfileFetcher
+{
+  GObject parent;
+};
+
+struct _GisProfileFetcherClass
+{
+  GObjectClass parent_class;
+};
+
+GType gis_profile_fetcher_get_type (void);
+
+GisProfileFetcher *gis_profile_fetcher_new (guint timeout);
+
+GCancellable *gis_profile_fetcher_get_cancellable (GisProfileFetcher *fetcher);
+
+void gis_profile_fetcher_hold   (GisProfileFetcher *fetcher);
+void gis_profile_fetcher_fetch  (GisProfileFetcher *fetcher,
+                                 const gchar       *access_token);
+void gis_profile_fetcher_cancel (GisProfileFetcher *fetcher);
+
+G_END_DECLS
+
+#endif /* __GIS_PROFILE_FETCHER_H__ */
@@ -0,0 +1,318 @@
+/* -*- mode: C; c-file-style: "gnu"; indent-tabs-mode: nil; -*- */
+/*
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs GisProfileFetcher against a local stand-in for the Google
+ * userinfo endpoint, set with GIS_GOA_USERINFO_URL:
+ *
+ *   make -C gnome-initial-setup/pages/account check
+ *
+ * Checks that the name and picture come through, that the fetcher gives
+ * up on a server that never answers once the timeout is over, and that
+ * disposing of it while a lookup is in flight cancels the lookup. The
+ * timeouts are shorter than the page's 15 seconds so that it runs
+ * quickly.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libsoup/soup.h>
+
+#include "gis-profile-fetcher.h"
+
+#define TOKEN "profile-fetch-test"
+/* The server holds on to requests with this token, and never answers */
+#define SLOW_TOKEN "slow"
+
+#define NAME "Test User"
+#define PICTURE_SIZE 192
+
+static gchar *base_uri;
+static gchar *picture_data;
+static gsize picture_length;
+static guint slow_requests;
+
+typedef struct {
+  gchar *name;
+  GdkPixbuf *pixbuf;
+  gboolean got_picture;
+} Results;
+
+static void
+userinfo_cb (SoupServer        *server,
+             SoupMessage       *msg,
+             const char        *path,
+             GHashTable        *query,
+             SoupClientContext *client,
+             gpointer           user_data)
+{
+  const gchar *token = NULL;
+  gchar *body;
+
+  if (query != NULL)
+    token = g_hash_table_lookup (query, "access_token");
+
+  if (g_strcmp0 (token, SLOW_TOKEN) == 0)
+    {
+      slow_requests++;
+      soup_server_pause_message (server, msg);
+      return;
+    }
+
+  if (g_strcmp0 (token, TOKEN) != 0)
+    {
+      soup_message_set_status (msg, SOUP_STATUS_UNAUTHORIZED);
+      return;
+    }
+
+  body = g_strdup_printf ("{ \"name\": \"%s\", \"picture\": \"%spicture.png\" }",
+                          NAME, base_uri);
+  soup_message_set_status (msg, SOUP_STATUS_OK);
+  soup_message_set_response (msg, "application/json", SOUP_MEMORY_TAKE,
+                             body, strlen (body));
+}
+
+static void
+picture_cb (SoupServer        *server,
+            SoupMessage       *msg,
+            const char        *path,
+            GHashTable        *query,
+            SoupClientContext *client,
+            gpointer           user_data)
+{
+  soup_message_set_status (msg, SOUP_STATUS_OK);
+  soup_message_set_response (msg, "image/png", SOUP_MEMORY_STATIC,
+                             picture_data, picture_length);
+}
+
+static SoupServer *
+start_server (void)
+{
+  SoupServer *server;
+  GdkPixbuf *pixbuf;
+  GSList *uris;
+  gchar *url;
+  GError *error = NULL;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, FALSE, 8, PICTURE_SIZE, PICTURE_SIZE);
+  gdk_pixbuf_fill (pixbuf, 0x3465a4ff);
+  gdk_pixbuf_save_to_buffer (pixbuf, &picture_data, &picture_length, "png", &error, NULL);
+  g_assert_no_error (error);
+  g_object_unref (pixbuf);
+
+  server = soup_server_new (NULL, NULL);
+  soup_server_add_handler (server, "/userinfo", userinfo_cb, NULL, NULL);
+  soup_server_add_handler (server, "/picture.png", picture_cb, NULL, NULL);
+  soup_server_listen_local (server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error);
+  g_assert_no_error (error);
+
+  uris = soup_server_get_uris (server);
+  g_assert_nonnull (uris);
+  base_uri = soup_uri_to_string (uris->data, FALSE);
+  g_slist_free_full (uris, (GDestroyNotify) soup_uri_free);
+
+  url = g_strconcat (base_uri, "userinfo", NULL);
+  g_setenv ("GIS_GOA_USERINFO_URL", url, TRUE);
+  g_free (url);
+
+  return server;
+}
+
+static void
+name_ready (GisProfileFetcher *fetcher,
+            const gchar       *name,
+            Results           *results)
+{
+  g_free (results->name);
+  results->name = g_strdup (name);
+}
+
+static void
+picture_ready (GisProfileFetcher *fetcher,
+               GdkPixbuf         *pixbuf,
+               Results           *results)
+{
+  g_clear_object (&results->pixbuf);
+  results->pixbuf = g_object_ref (pixbuf);
+  results->got_picture = TRUE;
+}
+
+static GisProfileFetcher *
+new_fetcher (guint    timeout,
+             Results *results)
+{
+  GisProfileFetcher *fetcher;
+
+  fetcher = gis_profile_fetcher_new (timeout);
+  g_signal_connect (fetcher, "name-ready", G_CALLBACK (name_ready), results);
+  g_signal_connect (fetcher, "picture-ready", G_CALLBACK (picture_ready), results);
+
+  return fetcher;
+}
+
+static gboolean
+wait_timeout (gpointer user_data)
+{
+  gboolean *timed_out = user_data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs the main loop until *@done is set, for at most @seconds */
+static void
+wait_for (const gboolean *done,
+          guint           seconds)
+{
+  gboolean timed_out = FALSE;
+  guint timeout_id;
+
+  timeout_id = g_timeout_add_seconds (seconds, wait_timeout, &timed_out);
+
+  while (!*done && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+
+  if (!timed_out)
+    g_source_remove (timeout_id);
+}
+
+static void
+cancelled_cb (GCancellable *cancellable,
+              gboolean     *cancelled)
+{
+  *cancelled = TRUE;
+}
+
+static void
+test_fill_in (void)
+{
+  GisProfileFetcher *fetcher;
+  Results results = { NULL, };
+  const gboolean never = FALSE;
+
+  fetcher = new_fetcher (2, &results);
+
+  gis_profile_fetcher_hold (fetcher);
+  gis_profile_fetcher_fetch (fetcher, TOKEN);
+  wait_for (&results.got_picture, 10);
+
+  g_assert_cmpstr (results.name, ==, NAME);
+  g_assert_nonnull (results.pixbuf);
+  g_assert_cmpint (gdk_pixbuf_get_width (results.pixbuf), ==, 96);
+  g_assert_cmpint (gdk_pixbuf_get_height (results.pixbuf), ==, 96);
+
+  /* Everything arrived, so the timeout must not go off anymore */
+  wait_for (&never, 3);
+  g_assert_false (g_cancellable_is_cancelled (gis_profile_fetcher_get_cancellable (fetcher)));
+
+  g_object_unref (fetcher);
+  g_free (results.name);
+  g_clear_object (&results.pixbuf);
+}
+
+static void
+test_deadline (void)
+{
+  GisProfileFetcher *fetcher;
+  Results results = { NULL, };
+  gboolean cancelled = FALSE;
+  gint64 start, elapsed;
+
+  fetcher = new_fetcher (1, &results);
+  g_signal_connect (gis_profile_fetcher_get_cancellable (fetcher), "cancelled",
+                    G_CALLBACK (cancelled_cb), &cancelled);
+
+  start = g_get_monotonic_time ();
+
+  /* One lookup the server sits on, and a token that never comes */
+  gis_profile_fetcher_hold (fetcher);
+  gis_profile_fetcher_fetch (fetcher, SLOW_TOKEN);
+  gis_profile_fetcher_hold (fetcher);
+  wait_for (&cancelled, 10);
+
+  elapsed = g_get_monotonic_time () - start;
+
+  g_assert_true (cancelled);
+  g_assert_cmpint (elapsed, >=, G_USEC_PER_SEC / 2);
+  g_assert_null (results.name);
+  g_assert_false (results.got_picture);
+
+  /* The token turning up late is ignored */
+  gis_profile_fetcher_fetch (fetcher, TOKEN);
+  wait_for (&results.got_picture, 2);
+  g_assert_null (results.name);
+
+  g_object_unref (fetcher);
+}
+
+static void
+test_dispose (void)
+{
+  GisProfileFetcher *fetcher;
+  GCancellable *cancellable;
+  Results results = { NULL, };
+  const gboolean never = FALSE;
+  gboolean requested = FALSE;
+  guint before;
+
+  fetcher = new_fetcher (15, &results);
+  cancellable = g_object_ref (gis_profile_fetcher_get_cancellable (fetcher));
+  g_object_add_weak_pointer (G_OBJECT (fetcher), (gpointer *) &fetcher);
+
+  before = slow_requests;
+  gis_profile_fetcher_hold (fetcher);
+  gis_profile_fetcher_fetch (fetcher, SLOW_TOKEN);
+
+  while (!requested)
+    {
+      g_main_context_iteration (NULL, TRUE);
+      requested = slow_requests > before;
+    }
+
+  g_object_unref (fetcher);
+  g_assert_null (fetcher);
+  g_assert_true (g_cancellable_is_cancelled (cancellable));
+
+  /* The cancelled lookup finishing must not touch the fetcher */
+  wait_for (&never, 1);
+  g_assert_null (results.name);
+
+  g_object_unref (cancellable);
+}
+
+int
+main (int argc, char *argv[])
+{
+  SoupServer *server;
+
+  server = start_server ();
+
+  test_fill_in ();
+  test_deadline ();
+  test_dispose ();
+
+  soup_server_disconnect (server);
+  g_object_unref (server);
+  g_free (base_uri);
+  g_free (picture_data);
+
+  return EXIT_SUCCESS;
+}
@@ -26,6 +26,7 @@
 
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 
 #ifdef HAVE_CHEESE
@@ -43,6 +44,9 @@ struct _UmPhotoDialog {
         GtkWidget *photo_popup;
         GtkWidget *popup_button;
 
+        GPtrArray *face_images;
+        GCancellable *faces_cancellable;
+
 #ifdef HAVE_CHEESE
         CheeseCameraDeviceMonitor *monitor;
         GtkWidget *take_photo_menuitem;
@@ -143,19 +147,193 @@ stock_icon_selected (GtkMenuItem   *menuitem,
         um->callback (NULL, filename, um->data);
 }
 
+typedef struct {
+        GdkPixbuf *pixbuf;
+        gint64     mtime;
+        gint       size;
+} CachedFace;
+
+/* Decoded faces, shared by all dialogs, keyed by path. An updated face
+ * file replaces its old entry, and faces that are no longer listed are
+ * dropped, so it never holds more than one popup's worth. */
+static GHashTable *face_cache;
+G_LOCK_DEFINE_STATIC (face_cache);
+
+typedef struct {
+        gchar **filenames;
+        gint    size;
+} FaceLoad;
+
+static void
+face_load_free (FaceLoad *load)
+{
+        g_strfreev (load->filenames);
+        g_slice_free (FaceLoad, load);
+}
+
+static void
+cached_face_free (CachedFace *face)
+{
+        g_object_unref (face->pixbuf);
+        g_slice_free (CachedFace, face);
+}
+
+static void
+face_pixbuf_free (gpointer pixbuf)
+{
+        /* faces that failed to load are NULL */
+        if (pixbuf != NULL)
+                g_object_unref (pixbuf);
+}
+
+static GdkPixbuf *
+load_face (const gchar *filename,
+           gint         size)
+{
+        GStatBuf buf;
+        GdkPixbuf *pixbuf = NULL;
+        CachedFace *face;
+
+        if (g_stat (filename, &buf) != 0)
+                return NULL;
+
+        G_LOCK (face_cache);
+        if (face_cache == NULL)
+                face_cache = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free, (GDestroyNotify) cached_face_free);
+        face = g_hash_table_lookup (face_cache, filename);
+        if (face != NULL && face->mtime == (gint64) buf.st_mtime && face->size == size)
+                pixbuf = g_object_ref (face->pixbuf);
+        G_UNLOCK (face_cache);
+
+        if (pixbuf != NULL)
+                return pixbuf;
+
+        pixbuf = gdk_pixbuf_new_from_file_at_size (filename, size, size, NULL);
+        if (pixbuf == NULL)
+                return NULL;
+
+        face = g_slice_new (CachedFace);
+        face->pixbuf = g_object_ref (pixbuf);
+        face->mtime = (gint64) buf.st_mtime;
+        face->size = size;
+
+        G_LOCK (face_cache);
+        g_hash_table_insert (face_cache, g_strdup (filename), face);
+        G_UNLOCK (face_cache);
+
+        return pixbuf;
+}
+
+static gboolean
+face_not_listed (gpointer key,
+                 gpointer value,
+                 gpointer user_data)
+{
+        return !g_strv_contains ((const gchar * const *) user_data, key);
+}
+
+static void
+prune_face_cache (gchar **filenames)
+{
+        G_LOCK (face_cache);
+        if (face_cache != NULL)
+                g_hash_table_foreach_remove (face_cache, face_not_listed, filenames);
+        G_UNLOCK (face_cache);
+}
+
+static void
+load_faces_thread_func (GTask        *task,
+                        gpointer      source_object,
+                        gpointer      task_data,
+                        GCancellable *cancellable)
+{
+        FaceLoad *load = task_data;
+        GPtrArray *pixbufs;
+        guint i;
+
+        pixbufs = g_ptr_array_new_with_free_func (face_pixbuf_free);
+
+        for (i = 0; load->filenames[i] != NULL; i++) {
+                if (g_task_return_error_if_cancelled (task)) {
+                        g_ptr_array_unref (pixbufs);
+                        return;
+                }
+
+                /* keep indices in sync with the menu items, even for
+                 * files that fail to load */
+                g_ptr_array_add (pixbufs, load_face (load->filenames[i], load->size));
+        }
+
+        prune_face_cache (load->filenames);
+
+        g_task_return_pointer (task, pixbufs, (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+faces_loaded (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+        UmPhotoDialog *um = user_data;
+        GPtrArray *pixbufs;
+        GError *error = NULL;
+        guint i;
+
+        pixbufs = g_task_propagate_pointer (G_TASK (result), &error);
+        if (pixbufs == NULL) {
+                /* Cancelled means the dialog is gone */
+                g_error_free (error);
+                return;
+        }
+
+        for (i = 0; i < pixbufs->len && i < um->face_images->len; i++) {
+                GdkPixbuf *pixbuf = g_ptr_array_index (pixbufs, i);
+                GtkWidget *image = g_ptr_array_index (um->face_images, i);
+
+                if (pixbuf != NULL)
+                        gtk_image_set_from_pixbuf (GTK_IMAGE (image), pixbuf);
+        }
+
+        g_ptr_array_unref (pixbufs);
+        g_clear_object (&um->faces_cancellable);
+}
+
+static void
+load_faces (UmPhotoDialog  *um,
+            GPtrArray      *filenames)
+{
+        GTask *task;
+        FaceLoad *load;
+        gint width, height;
+
+        gtk_icon_size_lookup (GTK_ICON_SIZE_DIALOG, &width, &height);
+
+        load = g_slice_new0 (FaceLoad);
+        load->size = MAX (width, height);
+        g_ptr_array_add (filenames, NULL);
+        load->filenames = (gchar **) g_ptr_array_free (filenames, FALSE);
+
+        um->faces_cancellable = g_cancellable_new ();
+
+        task = g_task_new (NULL, um->faces_cancellable, faces_loaded, um);
+        g_task_set_task_data (task, load, (GDestroyNotify) face_load_free);
+        g_task_run_in_thread (task, load_faces_thread_func);
+        g_object_unref (task);
+}
+
 static GtkWidget *
 menu_item_for_filename (UmPhotoDialog *um,
                         const char    *filename)
 {
         GtkWidget *image, *menuitem;
-        GFile *file;
-        GIcon *icon;
+        gint width, height;
 
-        file = g_file_new_for_path (filename);
-        icon = g_file_icon_new (file);
-        g_object_unref (file);
-        image = gtk_image_new_from_gicon (icon, GTK_ICON_SIZE_DIALOG);
-        g_object_unref (icon);
+        /* The face itself is filled in by load_faces(), keep the space */
+        gtk_icon_size_lookup (GTK_ICON_SIZE_DIALOG, &width, &height);
+        image = gtk_image_new ();
+        gtk_widget_set_size_request (image, width, height);
+        g_ptr_array_add (um->face_images, image);
 
         menuitem = gtk_menu_item_new ();
         gtk_container_add (GTK_CONTAINER (menuitem), image);
@@ -169,6 +347,13 @@ menu_item_for_filename (UmPhotoDialog *um,
         return menuitem;
 }
 
+static void
+on_photo_popup_unmap (GtkWidget     *popup_menu,
+                      UmPhotoDialog *um)
+{
+        gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (um->popup_button), FALSE);
+}
+
 static void
 setup_photo_popup (UmPhotoDialog *um)
 {
@@ -180,8 +365,11 @@ setup_photo_popup (UmPhotoDialog *um)
         const char *face;
         gboolean none_item_shown;
         gboolean added_faces;
+        GPtrArray *filenames;
 
         menu = gtk_menu_new ();
+        filenames = g_ptr_array_new ();
+        um->face_images = g_ptr_array_new ();
 
         x = 0;
         y = 0;
@@ -205,9 +393,7 @@ setup_photo_popup (UmPhotoDialog *um)
 
                         filename = g_build_filename (path, face, NULL);
                         menuitem = menu_item_for_filename (um, filename);
-                        g_free (filename);
-                        if (menuitem == NULL)
-                                continue;
+                        g_ptr_array_add (filenames, filename);
 
                         gtk_menu_attach (GTK_MENU (menu), GTK_WIDGET (menuitem),
                                          x, x + 1, y, y + 1);
@@ -280,11 +466,26 @@ skip_faces:
 #endif /* HAVE_CHEESE */
 
         um->photo_popup = menu;
+        g_signal_connect (um->photo_popup, "unmap",
+                          G_CALLBACK (on_photo_popup_unmap), um);
+
+        load_faces (um, filenames);
+}
+
+static void
+ensure_photo_popup (UmPhotoDialog *um)
+{
+        /* Only pay for listing and decoding the faces when the user
+         * actually looks at them */
+        if (um->photo_popup == NULL)
+                setup_photo_popup (um);
 }
 
 static void
 popup_icon_menu (GtkToggleButton *button, UmPhotoDialog *um)
 {
+        ensure_photo_popup (um);
+
         if (gtk_toggle_button_get_active (GTK_TOGGLE_BUTTON (button)) && !gtk_widget_get_visible (um->photo_popup)) {
                 gtk_menu_popup (GTK_MENU (um->photo_popup),
                                 NULL, NULL,
@@ -301,6 +502,8 @@ on_popup_button_button_pressed (GtkToggleButton *button,
                                 UmPhotoDialog  *um)
 {
         if (event->button == 1) {
+                ensure_photo_popup (um);
+
                 if (!gtk_widget_get_visible (um->photo_popup)) {
                         popup_icon_menu (button, um);
                         gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (button), TRUE);
@@ -315,13 +518,6 @@ on_popup_button_button_pressed (GtkToggleButton *button,
         return FALSE;
 }
 
-static void
-on_photo_popup_unmap (GtkWidget     *popup_menu,
-                      UmPhotoDialog *um)
-{
-        gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (um->popup_button), FALSE);
-}
-
 static void
 popup_button_draw (GtkWidget      *widget,
                    cairo_t        *cr,
@@ -358,7 +554,6 @@ um_photo_dialog_new (GtkWidget            *button,
 
         /* Set up the popup */
         um->popup_button = button;
-        setup_photo_popup (um);
         g_signal_connect (button, "toggled",
                           G_CALLBACK (popup_icon_menu), um);
         g_signal_connect (button, "button-press-event",
@@ -368,9 +563,6 @@ um_photo_dialog_new (GtkWidget            *button,
         g_signal_connect_after (button, "draw",
                                 G_CALLBACK (popup_button_draw), um);
 
-        g_signal_connect (um->photo_popup, "unmap",
-                          G_CALLBACK (on_photo_popup_unmap), um);
-
         um->callback = callback;
         um->data = data;
 
@@ -380,7 +572,13 @@ um_photo_dialog_new (GtkWidget            *button,
 void
 um_photo_dialog_free (UmPhotoDialog *um)
 {
-        gtk_widget_destroy (um->photo_popup);
+        if (um->faces_cancellable)
+                g_cancellable_cancel (um->faces_cancellable);
+        g_clear_object (&um->faces_cancellable);
+
+        if (um->photo_popup)
+                gtk_widget_destroy (um->photo_popup);
+        g_clear_pointer (&um->face_images, g_ptr_array_unref);
 
 #ifdef HAVE_CHEESE
         if (um->monitor)
@@ -24,6 +24,9 @@
 
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <pwd.h>
 #include <utmp.h>
@@ -163,18 +166,87 @@ down_arrow (GtkStyleContext *context,
 
 #define MAXNAMELEN  (UT_NAMESIZE - 1)
 
+/* How far to count up from DEFAULT_USERNAME looking for a free name */
+#define MAX_DEFAULT_USERNAMES 100
+
+/* NSS lookups can be slow (SSSD, LDAP, ...), and the same handful of
+ * candidates get looked up over and over while the user types, so keep
+ * the answers around for the rest of the session. Lookups may happen in
+ * worker threads, hence the lock.
+ */
+static GHashTable *username_cache;
+G_LOCK_DEFINE_STATIC (username_cache);
+
+/* Returns FALSE if NSS could not tell, e.g. on EIO, EMFILE or an SSSD
+ * timeout, rather than that the name is free. */
+static gboolean
+lookup_username (const gchar *username,
+                 gboolean    *used)
+{
+        struct passwd pw, *pwp = NULL;
+        gchar *buf;
+        glong bufsize;
+        gint res;
+
+        bufsize = sysconf (_SC_GETPW_R_SIZE_MAX);
+        if (bufsize <= 0)
+                bufsize = 4096;
+
+        buf = g_malloc (bufsize);
+        while ((res = getpwnam_r (username, &pw, buf, bufsize, &pwp)) == ERANGE) {
+                bufsize *= 2;
+                buf = g_realloc (buf, bufsize);
+        }
+        g_free (buf);
+
+        if (res != 0) {
+                g_debug ("Could not look up user %s: %s", username, g_strerror (res));
+                return FALSE;
+        }
+
+        *used = pwp != NULL;
+
+        return TRUE;
+}
+
 static gboolean
 is_username_used (const gchar *username)
 {
-        struct passwd *pwent;
+        gpointer cached;
+        gboolean used;
 
         if (username == NULL || username[0] == '\0') {
                 return FALSE;
         }
 
-        pwent = getpwnam (username);
+        G_LOCK (username_cache);
+        if (username_cache != NULL &&
+            g_hash_table_lookup_extended (username_cache, username, NULL, &cached)) {
+                G_UNLOCK (username_cache);
+                return GPOINTER_TO_INT (cached);
+        }
+        G_UNLOCK (username_cache);
+
+        /* Better to pass over a free name than to offer one that may
+         * be taken; and ask again next time, as the error may not last. */
+        if (!lookup_username (username, &used))
+                return TRUE;
 
-        return pwent != NULL;
+        G_LOCK (username_cache);
+        if (username_cache == NULL)
+                username_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        g_hash_table_insert (username_cache, g_strdup (username), GINT_TO_POINTER (used));
+        G_UNLOCK (username_cache);
+
+        return used;
+}
+
+void
+clear_username_cache (void)
+{
+        G_LOCK (username_cache);
+        g_clear_pointer (&username_cache, g_hash_table_unref);
+        G_UNLOCK (username_cache);
 }
 
 gboolean
@@ -264,9 +336,78 @@ is_valid_username (const gchar *username, gchar **tip)
         return valid;
 }
 
+typedef struct {
+        gchar *username;
+        gchar *tip;
+        gboolean valid;
+} UsernameCheck;
+
+static void
+username_check_free (UsernameCheck *check)
+{
+        g_free (check->username);
+        g_free (check->tip);
+        g_slice_free (UsernameCheck, check);
+}
+
+static void
+username_check_thread_func (GTask        *task,
+                            gpointer      source_object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
+{
+        UsernameCheck *check = task_data;
+
+        check->valid = is_valid_username (check->username, &check->tip);
+        g_task_return_boolean (task, TRUE);
+}
+
 void
-generate_username_choices (const gchar  *name,
-                           GtkListStore *store)
+is_valid_username_async (const gchar         *username,
+                         GCancellable        *cancellable,
+                         GAsyncReadyCallback  callback,
+                         gpointer             user_data)
+{
+        GTask *task;
+        UsernameCheck *check;
+
+        task = g_task_new (NULL, cancellable, callback, user_data);
+        g_task_set_source_tag (task, is_valid_username_async);
+
+        check = g_slice_new0 (UsernameCheck);
+        check->username = g_strdup (username);
+        g_task_set_task_data (task, check, (GDestroyNotify) username_check_free);
+
+        g_task_set_check_cancellable (task, TRUE);
+        g_task_set_return_on_cancel (task, TRUE);
+
+        g_task_run_in_thread (task, username_check_thread_func);
+
+        g_object_unref (task);
+}
+
+gboolean
+is_valid_username_finish (GAsyncResult  *result,
+                          gboolean      *valid,
+                          gchar        **tip,
+                          GError       **error)
+{
+        UsernameCheck *check;
+
+        g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+        if (!g_task_propagate_boolean (G_TASK (result), error))
+                return FALSE;
+
+        check = g_task_get_task_data (G_TASK (result));
+        *valid = check->valid;
+        *tip = g_strdup (check->tip);
+
+        return TRUE;
+}
+
+static gchar **
+compute_username_choices (const gchar *name)
 {
         gboolean in_use, same_as_initial;
         char *lc_name, *ascii_name, *stripped_name;
@@ -281,9 +422,9 @@ generate_username_choices (const gchar  *name,
         int len;
         int nwords1, nwords2, i;
         GHashTable *items = NULL;
-        GtkTreeIter iter;
+        GPtrArray *choices;
 
-        gtk_list_store_clear (store);
+        choices = g_ptr_array_new ();
 
         ascii_name = g_convert_with_fallback (name, -1, "ASCII//TRANSLIT", "UTF-8",
                                               unicode_fallback, NULL, NULL, NULL);
@@ -437,8 +578,7 @@ generate_username_choices (const gchar  *name,
         in_use = is_username_used (first_word->str);
         if (*first_word->str && !in_use && !g_ascii_isdigit (first_word->str[0]) &&
             !g_hash_table_lookup (items, first_word->str)) {
-                gtk_list_store_append (store, &iter);
-                gtk_list_store_set (store, &iter, 0, first_word->str, -1);
+                g_ptr_array_add (choices, g_strdup (first_word->str));
                 g_hash_table_insert (items, first_word->str, first_word->str);
         }
 
@@ -448,48 +588,42 @@ generate_username_choices (const gchar  *name,
                 in_use = is_username_used (last_word->str);
                 if (*last_word->str && !in_use && !g_ascii_isdigit (last_word->str[0]) &&
                     !g_hash_table_lookup (items, last_word->str)) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, last_word->str, -1);
+                        g_ptr_array_add (choices, g_strdup (last_word->str));
                         g_hash_table_insert (items, last_word->str, last_word->str);
                 }
 
                 /* add other items */
                 in_use = is_username_used (item0->str);
                 if (*item0->str && !in_use && !g_ascii_isdigit (item0->str[0])) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, item0->str, -1);
+                        g_ptr_array_add (choices, g_strdup (item0->str));
                         g_hash_table_insert (items, item0->str, item0->str);
                 }
 
                 in_use = is_username_used (item1->str);
                 same_as_initial = (g_strcmp0 (item0->str, item1->str) == 0);
                 if (*item1->str && !same_as_initial && nwords2 > 0 && !in_use && !g_ascii_isdigit (item1->str[0])) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, item1->str, -1);
+                        g_ptr_array_add (choices, g_strdup (item1->str));
                         g_hash_table_insert (items, item1->str, item1->str);
                 }
 
                 in_use = is_username_used (item2->str);
                 if (*item2->str && !in_use && !g_ascii_isdigit (item2->str[0]) &&
                     !g_hash_table_lookup (items, item2->str)) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, item2->str, -1);
+                        g_ptr_array_add (choices, g_strdup (item2->str));
                         g_hash_table_insert (items, item2->str, item2->str);
                 }
 
                 in_use = is_username_used (item3->str);
                 if (*item3->str && !in_use && !g_ascii_isdigit (item3->str[0]) &&
                     !g_hash_table_lookup (items, item3->str)) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, item3->str, -1);
+                        g_ptr_array_add (choices, g_strdup (item3->str));
                         g_hash_table_insert (items, item3->str, item3->str);
                 }
 
                 in_use = is_username_used (item4->str);
                 if (*item4->str && !in_use && !g_ascii_isdigit (item4->str[0]) &&
                     !g_hash_table_lookup (items, item4->str)) {
-                        gtk_list_store_append (store, &iter);
-                        gtk_list_store_set (store, &iter, 0, item4->str, -1);
+                        g_ptr_array_add (choices, g_strdup (item4->str));
                         g_hash_table_insert (items, item4->str, item4->str);
                 }
         }
@@ -505,17 +639,100 @@ generate_username_choices (const gchar  *name,
 
  bailout:
         if (items == NULL || g_hash_table_size (items) == 0) {
-                gtk_list_store_append (store, &iter);
                 default_username = g_strdup (DEFAULT_USERNAME);
                 i = 0;
-                while (is_username_used (default_username)) {
+                /* Names NSS cannot answer for count as used, so don't
+                 * go on forever while it is down; validation still
+                 * catches a name that turns out to be taken. */
+                while (is_username_used (default_username) && i < MAX_DEFAULT_USERNAMES) {
                         g_free (default_username);
                         default_username = g_strdup_printf (DEFAULT_USERNAME "%d", ++i);
                 }
-                gtk_list_store_set (store, &iter, 0, default_username, -1);
-                g_free (default_username);
+                g_ptr_array_add (choices, default_username);
         }
         if (items != NULL) {
                 g_hash_table_destroy (items);
         }
+
+        g_ptr_array_add (choices, NULL);
+
+        return (gchar **) g_ptr_array_free (choices, FALSE);
+}
+
+static void
+fill_username_store (GtkListStore  *store,
+                     gchar        **choices)
+{
+        GtkTreeIter iter;
+        gchar **c;
+
+        gtk_list_store_clear (store);
+
+        for (c = choices; *c != NULL; c++) {
+                gtk_list_store_append (store, &iter);
+                gtk_list_store_set (store, &iter, 0, *c, -1);
+        }
+}
+
+void
+generate_username_choices (const gchar  *name,
+                           GtkListStore *store)
+{
+        gchar **choices;
+
+        choices = compute_username_choices (name);
+        fill_username_store (store, choices);
+        g_strfreev (choices);
+}
+
+static void
+username_choices_thread_func (GTask        *task,
+                              gpointer      source_object,
+                              gpointer      task_data,
+                              GCancellable *cancellable)
+{
+        const gchar *name = task_data;
+
+        g_task_return_pointer (task, compute_username_choices (name),
+                               (GDestroyNotify) g_strfreev);
+}
+
+void
+generate_username_choices_async (const gchar         *name,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+        GTask *task;
+
+        task = g_task_new (NULL, cancellable, callback, user_data);
+        g_task_set_source_tag (task, generate_username_choices_async);
+        g_task_set_task_data (task, g_strdup (name), g_free);
+
+        /* Results for a name the user has already typed past are useless */
+        g_task_set_check_cancellable (task, TRUE);
+        g_task_set_return_on_cancel (task, TRUE);
+
+        g_task_run_in_thread (task, username_choices_thread_func);
+
+        g_object_unref (task);
+}
+
+gboolean
+generate_username_choices_finish (GAsyncResult  *result,
+                                  GtkListStore  *store,
+                                  GError       **error)
+{
+        gchar **choices;
+
+        g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+        choices = g_task_propagate_pointer (G_TASK (result), error);
+        if (choices == NULL)
+                return FALSE;
+
+        fill_username_store (store, choices);
+        g_strfreev (choices);
+
+        return TRUE;
 }
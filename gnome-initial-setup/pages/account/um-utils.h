@@ -48,9 +48,26 @@ void     down_arrow                       (GtkStyleContext *context,
 gboolean is_valid_name                    (const gchar     *name);
 gboolean is_valid_username                (const gchar     *name,
                                            gchar          **tip);
+void     is_valid_username_async          (const gchar         *name,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data);
+gboolean is_valid_username_finish         (GAsyncResult    *result,
+                                           gboolean        *valid,
+                                           gchar          **tip,
+                                           GError         **error);
 
 void     generate_username_choices        (const gchar     *name,
                                            GtkListStore    *store);
+void     generate_username_choices_async  (const gchar         *name,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data);
+gboolean generate_username_choices_finish (GAsyncResult    *result,
+                                           GtkListStore    *store,
+                                           GError         **error);
+
+void     clear_username_cache             (void);
 
 G_END_DECLS
 
@@ -36,9 +36,6 @@ struct _GisBrandingWelcomePagePrivate {
   GtkWidget *branding_title;
   GtkWidget *branding_text;
   GtkWidget *branding_logo;
-  gchar *title;
-  gchar *description;
-  gchar *logo_path;
 
   GtkAccelGroup *accel_group;
 };
@@ -46,11 +43,6 @@ typedef struct _GisBrandingWelcomePagePrivate GisBrandingWelcomePagePrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (GisBrandingWelcomePage, gis_branding_welcome_page, GIS_TYPE_PAGE);
 
-#define VENDOR_BRANDING_WELCOME_GROUP "Welcome"
-#define VENDOR_BRANDING_WELCOME_TITLE_KEY "title"
-#define VENDOR_BRANDING_WELCOME_DESC_KEY "description"
-#define VENDOR_BRANDING_WELCOME_LOGO_KEY "logo"
-
 static void
 load_css_overrides (GisBrandingWelcomePage *page)
 {
@@ -61,91 +53,31 @@ load_css_overrides (GisBrandingWelcomePage *page)
                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
 }
 
-static void
-read_config_file (GisBrandingWelcomePage *page)
-{
-  GisBrandingWelcomePagePrivate *priv = NULL;
-  g_autoptr(GKeyFile) keyfile = NULL;
-  g_autoptr(GError) error = NULL;
-
-  /* VENDOR_CONF_FILE points to a keyfile containing vendor customization
-   * options. This code will look for options under the "Welcome" group, and
-   * supports the following keys:
-   *   - title (required): short string to show as title.
-   *   - description (optional): string containing long text, likely to be wrapped.
-   *   - logo (optional): absolute path to the file with a logo for the brand.
-   *
-   * For example, this is how this file would look on a vendor image defining a title,
-   * a description an a logo:
-   *
-   *   [Welcome]
-   *   title=A title to be shown at the top
-   *   description=A long description that will be shown at the bottom of this
-   *     page, right below the branded logo (if any), explaining what the
-   *     branded edition is about.
-   *   logo=/path/to/the/image/with/the/logo.png
-   */
-  keyfile = g_key_file_new ();
-  if (!g_key_file_load_from_file (keyfile, VENDOR_CONF_FILE, G_KEY_FILE_NONE, &error)) {
-    if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
-      g_warning ("Could not read file %s: %s", VENDOR_CONF_FILE, error->message);
-
-    return;
-  }
-
-  priv = gis_branding_welcome_page_get_instance_private (page);
-
-  priv->title = g_key_file_get_string (keyfile, VENDOR_BRANDING_WELCOME_GROUP,
-                                       VENDOR_BRANDING_WELCOME_TITLE_KEY, &error);
-  if (priv->title == NULL) {
-    g_warning ("Could not read title for 'Welcome' branding page from %s: %s",
-               VENDOR_CONF_FILE, error->message);
-    return;
-  }
-
-  priv->description = g_key_file_get_string (keyfile, VENDOR_BRANDING_WELCOME_GROUP,
-                                             VENDOR_BRANDING_WELCOME_DESC_KEY, &error);
-  if (priv->description == NULL) {
-    g_debug ("Could not read description for 'Welcome' branding page from %s: %s",
-             VENDOR_CONF_FILE, error->message);
-    g_clear_error (&error);
-  }
-
-  priv->logo_path = g_key_file_get_string (keyfile, VENDOR_BRANDING_WELCOME_GROUP,
-                                           VENDOR_BRANDING_WELCOME_LOGO_KEY, &error);
-  if (priv->logo_path == NULL) {
-    g_debug ("Could not read logo path for 'Welcome' branding page from %s: %s",
-             VENDOR_CONF_FILE, error->message);
-    g_clear_error (&error);
-  }
-}
-
 static void
 update_branding_specific_info (GisBrandingWelcomePage *page)
 {
   GisBrandingWelcomePagePrivate *priv = gis_branding_welcome_page_get_instance_private (page);
-  GtkWidget *opt_widget = NULL;
+  GisVendorConfig *config = gis_driver_get_vendor_config (GIS_PAGE (page)->driver);
+  const gchar *title, *description, *logo_path;
 
-  read_config_file (page);
+  title = gis_vendor_config_get_welcome_title (config);
+  description = gis_vendor_config_get_welcome_description (config);
+  logo_path = gis_vendor_config_get_welcome_logo (config);
 
-  if (priv->title == NULL) {
+  if (title == NULL) {
     g_debug ("No branding configuration found");
     return;
   }
 
-  gtk_label_set_label (GTK_LABEL (priv->branding_title), priv->title);
+  gtk_label_set_label (GTK_LABEL (priv->branding_title), title);
 
-  if (priv->description != NULL) {
-    opt_widget = priv->branding_text;
-    gtk_label_set_label (GTK_LABEL (opt_widget), priv->description);
-    gtk_widget_show (opt_widget);
-  }
+  if (description != NULL)
+    gtk_label_set_label (GTK_LABEL (priv->branding_text), description);
+  gtk_widget_set_visible (priv->branding_text, description != NULL);
 
-  if (priv->logo_path != NULL) {
-    opt_widget = priv->branding_logo;
-    gtk_image_set_from_file (GTK_IMAGE (opt_widget), priv->logo_path);
-    gtk_widget_show (opt_widget);
-  }
+  if (logo_path != NULL)
+    gtk_image_set_from_file (GTK_IMAGE (priv->branding_logo), logo_path);
+  gtk_widget_set_visible (priv->branding_logo, logo_path != NULL);
 }
 
 static GtkAccelGroup *
@@ -167,6 +99,9 @@ gis_branding_welcome_page_constructed (GObject *object)
   G_OBJECT_CLASS (gis_branding_welcome_page_parent_class)->constructed (object);
 
   update_branding_specific_info (page);
+  g_signal_connect_object (gis_driver_get_vendor_config (GIS_PAGE (page)->driver),
+                           "changed", G_CALLBACK (update_branding_specific_info),
+                           page, G_CONNECT_SWAPPED);
   load_css_overrides (page);
 
   /* Use ctrl+f to show factory dialog */
@@ -185,9 +120,6 @@ gis_branding_welcome_page_finalize (GObject *object)
   GisBrandingWelcomePage *page = GIS_BRANDING_WELCOME_PAGE (object);
   GisBrandingWelcomePagePrivate *priv = gis_branding_welcome_page_get_instance_private (page);
 
-  g_free (priv->title);
-  g_free (priv->description);
-  g_free (priv->logo_path);
   g_clear_object (&priv->accel_group);
 
   G_OBJECT_CLASS (gis_branding_welcome_page_parent_class)->finalize (object);
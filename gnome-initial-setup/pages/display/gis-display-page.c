@@ -36,6 +36,8 @@
 #include <libgnome-desktop/gnome-rr-config.h>
 
 typedef struct {
+  GtkWidget *title;
+  GtkWidget *question_label;
   GtkWidget *overscan_on;
   GtkWidget *overscan_off;
   GtkWidget *overscan_default_selection;
@@ -266,7 +268,14 @@ gis_display_page_apply (GisPage *gis_page,
 static void
 gis_display_page_locale_changed (GisPage *page)
 {
+  GisDisplayPagePrivate *priv = gis_display_page_get_instance_private (GIS_DISPLAY_PAGE (page));
+
   gis_page_set_title (page, _("Display"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Adjust for TV screen"));
+  gtk_label_set_label (GTK_LABEL (priv->question_label), _("Do you see this at the bottom right corner of your screen?"));
+  gtk_button_set_label (GTK_BUTTON (priv->overscan_off), _("I see it"));
+  gtk_button_set_label (GTK_BUTTON (priv->overscan_on), _("I do not see it. Shrink screen to fit TV."));
 }
 
 static void
@@ -277,6 +286,8 @@ gis_display_page_class_init (GisDisplayPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-display-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisDisplayPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisDisplayPage, question_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisDisplayPage, overscan_on);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisDisplayPage, overscan_off);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisDisplayPage, overscan_default_selection);
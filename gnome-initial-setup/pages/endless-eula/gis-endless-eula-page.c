@@ -37,6 +37,8 @@
 #include <webkit2/webkit2.h>
 
 typedef struct {
+  GtkWidget *terms_label;
+  GtkWidget *terms_text;
   GtkWidget *eula_scrolledwin;
   GtkWidget *metrics_separator;
   GtkWidget *metrics_label;
@@ -50,11 +52,29 @@ G_DEFINE_TYPE_WITH_PRIVATE (GisEndlessEulaPage, gis_endless_eula_page, GIS_TYPE_
 
 #define LICENSE_SERVICE_URI "http://localhost:3010"
 
+static void
+metrics_enabled_set (GObject      *source,
+                     GAsyncResult *res,
+                     gpointer      user_data)
+{
+  GError *error = NULL;
+  GVariant *ret;
+
+  ret = g_dbus_proxy_call_finish (G_DBUS_PROXY (source), res, &error);
+  if (ret == NULL)
+    {
+      g_critical ("Unable to set the enabled state of metrics daemon: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_variant_unref (ret);
+}
+
 static void
 sync_metrics_active_state (GisEndlessEulaPage *page)
 {
   GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (page);
-  GError *error = NULL;
   GtkWidget *widget;
   gboolean metrics_active;
 
@@ -64,17 +84,35 @@ sync_metrics_active_state (GisEndlessEulaPage *page)
   if (!priv->metrics_proxy)
     return;
 
-  g_dbus_proxy_call_sync (priv->metrics_proxy,
-                          "SetEnabled",
-                          g_variant_new ("(b)", metrics_active),
-                          G_DBUS_CALL_FLAGS_NONE, -1,
-                          NULL, &error);
+  g_dbus_proxy_call (priv->metrics_proxy,
+                     "SetEnabled",
+                     g_variant_new ("(b)", metrics_active),
+                     G_DBUS_CALL_FLAGS_NONE, -1,
+                     NULL, metrics_enabled_set, NULL);
+}
 
+static void
+metrics_proxy_ready (GObject      *source,
+                     GAsyncResult *res,
+                     gpointer      user_data)
+{
+  GisEndlessEulaPage *page = user_data;
+  GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (page);
+  GError *error = NULL;
+
+  priv->metrics_proxy = gis_proxy_pool_get_finish (GIS_PROXY_POOL (source), res, &error);
   if (error != NULL)
     {
-      g_critical ("Unable to set the enabled state of metrics daemon: %s", error->message);
+      g_critical ("Unable to create a DBus proxy for the metrics daemon: %s", error->message);
       g_error_free (error);
     }
+  else
+    {
+      /* The checkbox may have been toggled in the meantime */
+      sync_metrics_active_state (page);
+    }
+
+  g_object_unref (page);
 }
 
 static void
@@ -197,6 +235,8 @@ load_evince_view_for_file (GFile *file)
   GError *error = NULL;
   gchar *path;
 
+  gis_ensure_evince ();
+
   document = ev_document_factory_get_document_for_gfile (file,
                                                          EV_DOCUMENT_LOAD_FLAG_NONE,
                                                          NULL,
@@ -305,24 +345,17 @@ gis_endless_eula_page_constructed (GObject *object)
 {
   GisEndlessEulaPage *page = GIS_ENDLESS_EULA_PAGE (object);
   GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (page);
-  GError *error = NULL;
   GtkWidget *widget;
 
   G_OBJECT_CLASS (gis_endless_eula_page_parent_class)->constructed (object);
 
-  priv->metrics_proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,
-                                                       G_DBUS_PROXY_FLAGS_NONE,
-                                                       NULL,
-                                                       "com.endlessm.Metrics",
-                                                       "/com/endlessm/Metrics",
-                                                       "com.endlessm.Metrics.EventRecorderServer",
-                                                       NULL, &error);
-
-  if (error != NULL)
-    {
-      g_critical ("Unable to create a DBus proxy for the metrics daemon: %s", error->message);
-      g_error_free (error);
-    }
+  gis_proxy_pool_get_async (gis_driver_get_proxy_pool (GIS_PAGE (page)->driver),
+                            "com.endlessm.Metrics",
+                            "/com/endlessm/Metrics",
+                            "com.endlessm.Metrics.EventRecorderServer",
+                            NULL,
+                            metrics_proxy_ready,
+                            g_object_ref (page));
 
   load_css_overrides (page);
 
@@ -333,17 +366,33 @@ gis_endless_eula_page_constructed (GObject *object)
   g_signal_connect_swapped (widget, "toggled",
                             G_CALLBACK (sync_metrics_active_state), page);
 
-  sync_metrics_active_state (page);
   load_terms_view (page);
 
-  gis_page_set_forward_text (GIS_PAGE (page), _("_Accept and Continue"));
   gis_page_set_complete (GIS_PAGE (page), TRUE);
 }
 
 static void
 gis_endless_eula_page_locale_changed (GisPage *page)
 {
+  GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (GIS_ENDLESS_EULA_PAGE (page));
+  GtkWidget *view;
+
   gis_page_set_title (page, _("Terms of Use"));
+  gis_page_set_forward_text (page, _("_Accept and Continue"));
+
+  gtk_label_set_label (GTK_LABEL (priv->terms_label), _("Please read the following terms of use carefully"));
+  gtk_label_set_label (GTK_LABEL (priv->terms_text), _("By clicking \"Accept and continue,\" you acknowledge that you have read, understood, and agree to be bound by the following terms and conditions."));
+  gtk_label_set_label (GTK_LABEL (priv->metrics_label), _("Help make Endless better for everyone"));
+  gtk_label_set_label (GTK_LABEL (priv->metrics_privacy_label), _("Automatically save and send usage statistics and problem reports to Endless. All data is anonymous."));
+
+  /* The terms are looked up for the current language, so show the
+   * ones for the new language if they were already loaded. */
+  view = gtk_bin_get_child (GTK_BIN (priv->eula_scrolledwin));
+  if (view != NULL)
+    {
+      gtk_widget_destroy (view);
+      load_terms_view (GIS_ENDLESS_EULA_PAGE (page));
+    }
 }
 
 static void
@@ -352,6 +401,52 @@ gis_endless_eula_page_save_data (GisPage *page)
   sync_metrics_active_state (GIS_ENDLESS_EULA_PAGE (page));
 }
 
+static void
+gis_endless_eula_page_release_resources (GisPage *page)
+{
+  GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (GIS_ENDLESS_EULA_PAGE (page));
+  GtkWidget *view;
+
+  /* The document and the pages rendered from it go with the view */
+  view = gtk_bin_get_child (GTK_BIN (priv->eula_scrolledwin));
+  if (view != NULL)
+    gtk_widget_destroy (view);
+}
+
+static void
+gis_endless_eula_page_restore_resources (GisPage *page)
+{
+  GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (GIS_ENDLESS_EULA_PAGE (page));
+
+  if (gtk_bin_get_child (GTK_BIN (priv->eula_scrolledwin)) == NULL)
+    load_terms_view (GIS_ENDLESS_EULA_PAGE (page));
+}
+
+static gboolean
+gis_endless_eula_page_apply_answers (GisPage      *page,
+                                     GKeyFile     *answers,
+                                     const gchar  *group,
+                                     GError      **error)
+{
+  GisEndlessEulaPagePrivate *priv = gis_endless_eula_page_get_instance_private (GIS_ENDLESS_EULA_PAGE (page));
+  GError *local_error = NULL;
+  gboolean metrics;
+
+  if (!g_key_file_has_key (answers, group, "metrics", NULL))
+    return TRUE;
+
+  metrics = g_key_file_get_boolean (answers, group, "metrics", &local_error);
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->metrics_checkbutton), metrics);
+
+  return TRUE;
+}
+
 static void
 gis_endless_eula_page_class_init (GisEndlessEulaPageClass *klass)
 {
@@ -360,6 +455,8 @@ gis_endless_eula_page_class_init (GisEndlessEulaPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-endless-eula-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEndlessEulaPage, terms_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEndlessEulaPage, terms_text);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEndlessEulaPage, eula_scrolledwin);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEndlessEulaPage, metrics_separator);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEndlessEulaPage, metrics_label);
@@ -369,6 +466,9 @@ gis_endless_eula_page_class_init (GisEndlessEulaPageClass *klass)
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_endless_eula_page_locale_changed;
   page_class->save_data = gis_endless_eula_page_save_data;
+  page_class->apply_answers = gis_endless_eula_page_apply_answers;
+  page_class->release_resources = gis_endless_eula_page_release_resources;
+  page_class->restore_resources = gis_endless_eula_page_restore_resources;
   object_class->constructed = gis_endless_eula_page_constructed;
   object_class->finalize = gis_endless_eula_page_finalize;
 }
@@ -34,6 +34,7 @@
 
 struct _GisEulaPagePrivate
 {
+  GtkWidget *title;
   GtkWidget *checkbox;
   GtkWidget *scrolled_window;
   GtkWidget *text_view;
@@ -42,6 +43,11 @@ struct _GisEulaPagePrivate
 
   gboolean require_checkbox;
   gboolean require_scroll;
+
+  /* Accepted by an answer file, without scrolling */
+  gboolean accepted;
+  /* Scrolled to the end once; the text may have been released since */
+  gboolean read_to_end;
 };
 typedef struct _GisEulaPagePrivate GisEulaPagePrivate;
 
@@ -137,13 +143,16 @@ get_page_complete (GisEulaPage *page)
 {
   GisEulaPagePrivate *priv = gis_eula_page_get_instance_private (page);
 
+  if (priv->accepted)
+    return TRUE;
+
   if (priv->require_checkbox) {
     GtkToggleButton *checkbox = GTK_TOGGLE_BUTTON (priv->checkbox);
     if (!gtk_toggle_button_get_active (checkbox))
       return FALSE;
   }
 
-  if (priv->require_scroll) {
+  if (priv->require_scroll && !priv->read_to_end) {
     GtkScrolledWindow *scrolled_window = GTK_SCROLLED_WINDOW (priv->scrolled_window);
     GtkAdjustment *vadjust = gtk_scrolled_window_get_vadjustment (scrolled_window);
     gdouble value, upper;
@@ -191,6 +200,22 @@ get_config (GFile    *eula,
   g_key_file_unref (config);
 }
 
+static gboolean
+load_eula_text (GisEulaPage  *page,
+                GError      **error)
+{
+  GisEulaPagePrivate *priv = gis_eula_page_get_instance_private (page);
+  GtkTextBuffer *buffer;
+
+  if (!build_eula_text_buffer (priv->eula, &buffer, error))
+    return FALSE;
+
+  gtk_text_view_set_buffer (GTK_TEXT_VIEW (priv->text_view), buffer);
+  g_object_unref (buffer);
+
+  return TRUE;
+}
+
 static void
 gis_eula_page_constructed (GObject *object)
 {
@@ -201,16 +226,13 @@ gis_eula_page_constructed (GObject *object)
   gboolean require_scroll = FALSE;
 
   GFile *eula = priv->eula;
-  GtkTextBuffer *buffer;
   GError *error = NULL;
 
   G_OBJECT_CLASS (gis_eula_page_parent_class)->constructed (object);
 
-  if (!build_eula_text_buffer (eula, &buffer, &error))
+  if (!load_eula_text (page, &error))
     goto out;
 
-  gtk_text_view_set_buffer (GTK_TEXT_VIEW (priv->text_view), buffer);
-
   gtk_text_view_set_border_window_size (GTK_TEXT_VIEW (priv->text_view), GTK_TEXT_WINDOW_TOP, 16);
   gtk_text_view_set_border_window_size (GTK_TEXT_VIEW (priv->text_view), GTK_TEXT_WINDOW_LEFT, 16);
   gtk_text_view_set_border_window_size (GTK_TEXT_VIEW (priv->text_view), GTK_TEXT_WINDOW_RIGHT, 16);
@@ -298,7 +320,69 @@ gis_eula_page_dispose (GObject *object)
 static void
 gis_eula_page_locale_changed (GisPage *page)
 {
+  GisEulaPagePrivate *priv = gis_eula_page_get_instance_private (GIS_EULA_PAGE (page));
+
   gis_page_set_title (GIS_PAGE (page), _("License Agreements"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("License Agreements"));
+  gtk_button_set_label (GTK_BUTTON (priv->checkbox), _("I have _agreed to the terms and conditions in this end user license agreement."));
+}
+
+static void
+gis_eula_page_release_resources (GisPage *page)
+{
+  GisEulaPage *eula_page = GIS_EULA_PAGE (page);
+  GisEulaPagePrivate *priv = gis_eula_page_get_instance_private (eula_page);
+
+  /* Going on past the page means it was complete, so it still is when
+   * coming back to the text at the top again */
+  priv->read_to_end = TRUE;
+
+  gtk_text_view_set_buffer (GTK_TEXT_VIEW (priv->text_view), NULL);
+}
+
+static void
+gis_eula_page_restore_resources (GisPage *page)
+{
+  GError *error = NULL;
+
+  if (!load_eula_text (GIS_EULA_PAGE (page), &error) && error != NULL)
+    {
+      g_printerr ("Error while reading EULA: %s", error->message);
+      g_error_free (error);
+    }
+}
+
+static gboolean
+gis_eula_page_apply_answers (GisPage      *page,
+                             GKeyFile     *answers,
+                             const gchar  *group,
+                             GError      **error)
+{
+  GisEulaPage *eula_page = GIS_EULA_PAGE (page);
+  GisEulaPagePrivate *priv = gis_eula_page_get_instance_private (eula_page);
+  GError *local_error = NULL;
+  gboolean accept;
+
+  accept = g_key_file_get_boolean (answers, group, "accept", &local_error);
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  if (!accept)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "The license agreements must be accepted to continue");
+      return FALSE;
+    }
+
+  priv->accepted = TRUE;
+  gtk_toggle_button_set_active (GTK_TOGGLE_BUTTON (priv->checkbox), TRUE);
+  sync_page_complete (eula_page);
+
+  return TRUE;
 }
 
 static void
@@ -309,12 +393,16 @@ gis_eula_page_class_init (GisEulaPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-eula-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEulaPage, title);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEulaPage, checkbox);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEulaPage, scrolled_window);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisEulaPage, text_view);
 
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_eula_page_locale_changed;
+  page_class->apply_answers = gis_eula_page_apply_answers;
+  page_class->release_resources = gis_eula_page_release_resources;
+  page_class->restore_resources = gis_eula_page_restore_resources;
   object_class->get_property = gis_eula_page_get_property;
   object_class->set_property = gis_eula_page_set_property;
   object_class->constructed = gis_eula_page_constructed;
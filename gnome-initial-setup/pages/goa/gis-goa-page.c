@@ -36,6 +36,9 @@
 #include <gio/gio.h>
 
 struct _GisGoaPagePrivate {
+  GtkWidget *title;
+  GtkWidget *description;
+  GtkWidget *footer_label;
   GtkWidget *accounts_list;
 
   GoaClient *goa_client;
@@ -333,7 +336,13 @@ gis_goa_page_dispose (GObject *object)
 static void
 gis_goa_page_locale_changed (GisPage *page)
 {
+  GisGoaPagePrivate *priv = gis_goa_page_get_instance_private (GIS_GOA_PAGE (page));
+
   gis_page_set_title (GIS_PAGE (page), _("Online Accounts"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Connect Your Online Accounts"));
+  gtk_label_set_label (GTK_LABEL (priv->description), _("Connect your accounts to easily access your email, online calendar, contacts, documents and photos."));
+  gtk_label_set_label (GTK_LABEL (priv->footer_label), _("Accounts can be added and removed at any time from the Settings application."));
 }
 
 static void
@@ -344,6 +353,9 @@ gis_goa_page_class_init (GisGoaPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-goa-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisGoaPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisGoaPage, description);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisGoaPage, footer_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisGoaPage, accounts_list);
 
   page_class->page_id = PAGE_ID;
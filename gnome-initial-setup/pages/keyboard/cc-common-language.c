@@ -29,6 +29,8 @@
 
 #include <fontconfig/fontconfig.h>
 
+#include <act/act-user-manager.h>
+
 #define GNOME_DESKTOP_USE_UNSTABLE_API
 #include <libgnome-desktop/gnome-languages.h>
 
@@ -138,77 +140,27 @@ user_language_has_translations (const char *locale)
         return ret;
 }
 
-static char *
-get_lang_for_user_object_path (const char *path)
-{
-	GError *error = NULL;
-	GDBusProxy *user;
-	GVariant *props;
-	char *lang;
-
-	user = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,
-					      G_DBUS_PROXY_FLAGS_NONE,
-					      NULL,
-					      "org.freedesktop.Accounts",
-					      path,
-					      "org.freedesktop.Accounts.User",
-					      NULL,
-					      &error);
-	if (user == NULL) {
-		g_warning ("Failed to get proxy for user '%s': %s",
-			   path, error->message);
-		g_error_free (error);
-		return NULL;
-	}
-	props = g_dbus_proxy_get_cached_property (user, "Language");
-	lang = g_variant_dup_string (props, NULL);
-
-	g_variant_unref (props);
-	g_object_unref (user);
-	return lang;
-}
-
 static void
 add_other_users_language (GHashTable *ht)
 {
-        GVariant *variant;
-        GVariantIter *vi;
-        GError *error = NULL;
-        const char *str;
-        GDBusProxy *proxy;
-
-        proxy = g_dbus_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,
-                                               G_DBUS_PROXY_FLAGS_NONE,
-                                               NULL,
-                                               "org.freedesktop.Accounts",
-                                               "/org/freedesktop/Accounts",
-                                               "org.freedesktop.Accounts",
-                                               NULL,
-                                               NULL);
-
-        if (proxy == NULL)
-                return;
-
-        variant = g_dbus_proxy_call_sync (proxy,
-                                          "ListCachedUsers",
-                                          NULL,
-                                          G_DBUS_CALL_FLAGS_NONE,
-                                          -1,
-                                          NULL,
-                                          &error);
-        if (variant == NULL) {
-                g_warning ("Failed to list existing users: %s", error->message);
-                g_error_free (error);
-                g_object_unref (proxy);
-                return;
-        }
-        g_variant_get (variant, "(ao)", &vi);
-        while (g_variant_iter_loop (vi, "o", &str)) {
-                char *lang;
+        GSList *users, *l;
+
+        /* The user manager is shared with the rest of the process and
+         * keeps the users' properties cached, so this doesn't go back
+         * to AccountsService every time the list is built. Users it has
+         * not loaded yet are left out; callers refresh their lists from
+         * cc_common_language_watch_users(). */
+        users = act_user_manager_list_users (act_user_manager_get_default ());
+        for (l = users; l != NULL; l = l->next) {
+                ActUser *user = l->data;
+                const char *lang;
                 char *name;
                 char *language;
 
-                lang = get_lang_for_user_object_path (str);
+                if (!act_user_is_loaded (user))
+                        continue;
+
+                lang = act_user_get_language (user);
                 if (lang != NULL && *lang != '\0' &&
                     cc_common_language_has_font (lang) &&
                     user_language_has_translations (lang)) {
@@ -221,12 +173,24 @@ add_other_users_language (GHashTable *ht)
                                 g_free (name);
                         }
                 }
-                g_free (lang);
         }
-        g_variant_iter_free (vi);
-        g_variant_unref (variant);
+        g_slist_free (users);
+}
+
+/* The user manager loads the users asynchronously, and at startup
+ * none are loaded by the time the language lists are first built.
+ * Calls @callback, swapped, on @object whenever other users' languages
+ * may have become known, until @object goes away. */
+void
+cc_common_language_watch_users (GCallback callback,
+                                gpointer  object)
+{
+        ActUserManager *manager = act_user_manager_get_default ();
 
-        g_object_unref (proxy);
+        g_signal_connect_object (manager, "notify::is-loaded",
+                                 callback, object, G_CONNECT_SWAPPED);
+        g_signal_connect_object (manager, "user-added",
+                                 callback, object, G_CONNECT_SWAPPED);
 }
 
 /*
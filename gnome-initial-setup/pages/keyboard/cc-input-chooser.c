@@ -58,6 +58,7 @@ struct _CcInputChooserPrivate
         GtkWidget *more_item;
 
         gboolean showing_extra;
+        gboolean rows_released;
 	gchar *locale;
         gchar *id;
 	gchar *type;
@@ -701,9 +702,12 @@ fetch_ibus_engines_result (GObject       *object,
 	g_list_free (list);
 
 	update_ibus_active_sources (chooser);
-	get_ibus_locale_infos (chooser);
 
-        sync_all_checkmarks (chooser);
+        /* Added once the rows are built again otherwise */
+        if (!priv->rows_released) {
+                get_ibus_locale_infos (chooser);
+                sync_all_checkmarks (chooser);
+        }
 }
 
 static void
@@ -740,6 +744,33 @@ maybe_start_ibus (void)
 }
 #endif
 
+static void
+add_rows (CcInputChooser *chooser)
+{
+        get_locale_infos (chooser);
+#ifdef HAVE_IBUS
+        get_ibus_locale_infos (chooser);
+#endif
+
+        sync_all_checkmarks (chooser);
+}
+
+static void
+remove_rows (CcInputChooser *chooser)
+{
+        CcInputChooserPrivate *priv = cc_input_chooser_get_instance_private (chooser);
+        GList *rows, *l;
+
+        rows = gtk_container_get_children (GTK_CONTAINER (priv->input_list));
+        for (l = rows; l; l = l->next) {
+                if (gtk_bin_get_child (GTK_BIN (l->data)) != priv->more_item)
+                        gtk_widget_destroy (GTK_WIDGET (l->data));
+        }
+        g_list_free (rows);
+
+        g_hash_table_remove_all (priv->inputs);
+}
+
 static void
 cc_input_chooser_constructed (GObject *object)
 {
@@ -925,3 +956,57 @@ cc_input_chooser_get_showing_extra (CcInputChooser *chooser)
         CcInputChooserPrivate *priv = cc_input_chooser_get_instance_private (chooser);
         return priv->showing_extra;
 }
+
+void
+cc_input_chooser_set_locale (CcInputChooser *chooser,
+                             const gchar    *locale)
+{
+        CcInputChooserPrivate *priv = cc_input_chooser_get_instance_private (chooser);
+
+        if (g_strcmp0 (priv->locale, locale) == 0)
+                return;
+
+        g_free (priv->locale);
+        priv->locale = g_strdup (locale);
+
+        /* Drop the inputs suggested for the old locale, and start over
+         * with those for the new one, in its language. */
+        remove_rows (chooser);
+        g_clear_pointer (&priv->id, g_free);
+        g_clear_pointer (&priv->type, g_free);
+
+        gtk_widget_set_tooltip_text (priv->more_item, _("More…"));
+        priv->no_results = no_results_widget_new ();
+        gtk_list_box_set_placeholder (GTK_LIST_BOX (priv->input_list), priv->no_results);
+
+        /* Built even if they had been released, since they are where
+         * the default input for the locale comes from */
+        priv->rows_released = FALSE;
+        add_rows (chooser);
+}
+
+/* Drops the rows for the inputs, while the chooser is not shown. The
+ * chosen input is kept. */
+void
+cc_input_chooser_release_rows (CcInputChooser *chooser)
+{
+        CcInputChooserPrivate *priv = cc_input_chooser_get_instance_private (chooser);
+
+        if (priv->rows_released)
+                return;
+
+        remove_rows (chooser);
+        priv->rows_released = TRUE;
+}
+
+void
+cc_input_chooser_restore_rows (CcInputChooser *chooser)
+{
+        CcInputChooserPrivate *priv = cc_input_chooser_get_instance_private (chooser);
+
+        if (!priv->rows_released)
+                return;
+
+        priv->rows_released = FALSE;
+        add_rows (chooser);
+}
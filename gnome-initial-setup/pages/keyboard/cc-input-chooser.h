@@ -59,6 +59,10 @@ void	      cc_input_chooser_get_layout (CcInputChooser *chooser,
 					   const gchar    **layout,
 					   const gchar    **variant);
 gboolean      cc_input_chooser_get_showing_extra (CcInputChooser *chooser);
+void          cc_input_chooser_set_locale (CcInputChooser *chooser,
+                                           const gchar    *locale);
+void          cc_input_chooser_release_rows (CcInputChooser *chooser);
+void          cc_input_chooser_restore_rows (CcInputChooser *chooser);
 
 G_END_DECLS
 
@@ -28,24 +28,27 @@
 #include <glib/gi18n.h>
 #include <gio/gio.h>
 #include <gtk/gtk.h>
-#include <polkit/polkit.h>
 
 #include "gis-keyboard-page.h"
 #include "keyboard-resources.h"
 #include "cc-input-chooser.h"
 #include "cc-keyboard-query.h"
+#include "cc-common-language.h"
 
 #define GNOME_DESKTOP_INPUT_SOURCES_DIR "org.gnome.desktop.input-sources"
 #define KEY_CURRENT_INPUT_SOURCE "current"
 #define KEY_INPUT_SOURCES        "sources"
 
 struct _GisKeyboardPagePrivate {
+        GtkWidget *title;
+        GtkWidget *subtitle;
         GtkWidget *input_chooser;
 	GtkWidget *input_auto_detect;
+        /* An input was chosen, rather than suggested for the locale */
+        gboolean input_chosen;
 
 	GDBusProxy *localed;
 	GCancellable *cancellable;
-	GPermission *permission;
         GSettings *input_settings;
 
         GSList *system_sources;
@@ -64,7 +67,6 @@ gis_keyboard_page_finalize (GObject *object)
 		g_cancellable_cancel (priv->cancellable);
 	g_clear_object (&priv->cancellable);
 
-	g_clear_object (&priv->permission);
 	g_clear_object (&priv->localed);
 	g_clear_object (&priv->input_settings);
 
@@ -152,11 +154,13 @@ set_localed_input (GisKeyboardPage *self)
 #undef LAYOUT
 #undef VARIANT
 
-        g_dbus_proxy_call (priv->localed,
-                           "SetX11Keyboard",
-                           g_variant_new ("(ssssbb)", layouts->str, "", variants->str, "", TRUE, TRUE),
-                           G_DBUS_CALL_FLAGS_NONE,
-                           -1, NULL, NULL, NULL);
+        gis_settings_transaction_set_call (gis_driver_get_settings_transaction (GIS_PAGE (self)->driver),
+                                           "keyboard",
+                                           "org.freedesktop.locale1",
+                                           "/org/freedesktop/locale1",
+                                           "org.freedesktop.locale1",
+                                           "SetX11Keyboard",
+                                           g_variant_new ("(ssssbb)", layouts->str, "", variants->str, "", TRUE, TRUE));
         g_string_free (layouts, TRUE);
         g_string_free (variants, TRUE);
 }
@@ -167,39 +171,65 @@ change_locale_permission_acquired (GObject      *source,
 				   gpointer      data)
 {
 	GisKeyboardPage *page = GIS_KEYBOARD_PAGE (data);
-	GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (page);
 	GError *error = NULL;
 	gboolean allowed;
 
-	allowed = g_permission_acquire_finish (priv->permission, res, &error);
+	allowed = g_permission_acquire_finish (G_PERMISSION (source), res, &error);
 	if (error) {
 		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
 			g_warning ("Failed to acquire permission: %s\n", error->message);
 		g_error_free (error);
+		g_object_unref (page);
 		return;
 	}
 
 	if (allowed)
-		set_localed_input (GIS_KEYBOARD_PAGE (data));
+		set_localed_input (page);
+	g_object_unref (page);
+}
+
+static void
+change_locale_permission_ready (GObject      *source,
+				GAsyncResult *res,
+				gpointer      data)
+{
+	GisKeyboardPage *page = GIS_KEYBOARD_PAGE (data);
+	GPermission *permission;
+	GError *error = NULL;
+
+	permission = gis_permission_cache_get_finish (GIS_PERMISSION_CACHE (source), res, &error);
+	if (permission == NULL) {
+		g_error_free (error);
+		g_object_unref (page);
+		return;
+	}
+
+	if (g_permission_get_allowed (permission)) {
+		set_localed_input (page);
+	} else if (g_permission_get_can_acquire (permission)) {
+		g_permission_acquire_async (permission,
+					    NULL,
+					    change_locale_permission_acquired,
+					    g_object_ref (page));
+	}
+
+	g_object_unref (permission);
+	g_object_unref (page);
 }
 
 static void
 update_input (GisKeyboardPage *self)
 {
-	GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (self);
+	GisDriver *driver = GIS_PAGE (self)->driver;
 
 	set_input_settings (self);
 
-	if (gis_driver_get_mode (GIS_PAGE (self)->driver) == GIS_DRIVER_MODE_NEW_USER) {
-		if (g_permission_get_allowed (priv->permission)) {
-			set_localed_input (self);
-		} else if (g_permission_get_can_acquire (priv->permission)) {
-			g_permission_acquire_async (priv->permission,
-						    NULL,
-						    change_locale_permission_acquired,
-						    self);
-		}
-	}
+	if (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER)
+		gis_permission_cache_get_async (gis_driver_get_permission_cache (driver),
+						"org.freedesktop.locale1.set-keyboard",
+						NULL,
+						change_locale_permission_ready,
+						g_object_ref (self));
 }
 
 static gboolean
@@ -291,7 +321,7 @@ localed_proxy_ready (GObject      *source,
 	GDBusProxy *proxy;
 	GError *error = NULL;
 
-	proxy = g_dbus_proxy_new_finish (res, &error);
+	proxy = gis_proxy_pool_get_finish (GIS_PROXY_POOL (source), res, &error);
 
 	if (!proxy) {
 		if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
@@ -317,6 +347,9 @@ static void
 input_changed (CcInputChooser  *chooser,
                GisKeyboardPage *self)
 {
+        GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (self);
+
+        priv->input_chosen = TRUE;
         update_page_complete (self);
 }
 
@@ -375,20 +408,14 @@ gis_keyboard_page_constructed (GObject *object)
 
 	priv->cancellable = g_cancellable_new ();
 
-	g_dbus_proxy_new_for_bus (G_BUS_TYPE_SYSTEM,
-				  G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
-				  NULL,
+	gis_proxy_pool_get_async (gis_driver_get_proxy_pool (GIS_PAGE (self)->driver),
 				  "org.freedesktop.locale1",
 				  "/org/freedesktop/locale1",
 				  "org.freedesktop.locale1",
 				  priv->cancellable,
-				  (GAsyncReadyCallback) localed_proxy_ready,
+				  localed_proxy_ready,
 				  self);
 
-	/* If we're in new user mode then we're manipulating system settings */
-	if (gis_driver_get_mode (GIS_PAGE (self)->driver) == GIS_DRIVER_MODE_NEW_USER)
-		priv->permission = polkit_permission_new_sync ("org.freedesktop.locale1.set-keyboard", NULL, NULL, NULL);
-
         update_page_complete (self);
 
         gtk_widget_show (GTK_WIDGET (self));
@@ -397,7 +424,77 @@ gis_keyboard_page_constructed (GObject *object)
 static void
 gis_keyboard_page_locale_changed (GisPage *page)
 {
+        GisKeyboardPage *self = GIS_KEYBOARD_PAGE (page);
+        GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (self);
+        gchar *language;
+        gchar *id;
+        gchar *type;
+
         gis_page_set_title (GIS_PAGE (page), _("Typing"));
+
+        gtk_label_set_label (GTK_LABEL (priv->title), _("Typing"));
+        gtk_label_set_label (GTK_LABEL (priv->subtitle), _("Select your keyboard layout or an input method."));
+        gtk_button_set_label (GTK_BUTTON (priv->input_auto_detect), _("Help Detect My Keyboard Layout"));
+
+        /* Suggest the inputs for the new language, but keep the input
+         * that was chosen, by the user or from the system layout. It
+         * cannot be read back from localed, which only hears about it
+         * when the settings are committed. */
+        id = g_strdup (cc_input_chooser_get_input_id (CC_INPUT_CHOOSER (priv->input_chooser)));
+        type = g_strdup (cc_input_chooser_get_input_type (CC_INPUT_CHOOSER (priv->input_chooser)));
+
+        language = cc_common_language_get_current_language ();
+        cc_input_chooser_set_locale (CC_INPUT_CHOOSER (priv->input_chooser), language);
+        g_free (language);
+
+        if (priv->input_chosen && id != NULL)
+                cc_input_chooser_set_input (CC_INPUT_CHOOSER (priv->input_chooser), id, type);
+
+        g_free (id);
+        g_free (type);
+
+        update_page_complete (self);
+}
+
+static void
+gis_keyboard_page_release_resources (GisPage *page)
+{
+        GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (GIS_KEYBOARD_PAGE (page));
+
+        cc_input_chooser_release_rows (CC_INPUT_CHOOSER (priv->input_chooser));
+}
+
+static void
+gis_keyboard_page_restore_resources (GisPage *page)
+{
+        GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (GIS_KEYBOARD_PAGE (page));
+
+        cc_input_chooser_restore_rows (CC_INPUT_CHOOSER (priv->input_chooser));
+}
+
+static gboolean
+gis_keyboard_page_apply_answers (GisPage      *page,
+                                 GKeyFile     *answers,
+                                 const gchar  *group,
+                                 GError      **error)
+{
+        GisKeyboardPagePrivate *priv = gis_keyboard_page_get_instance_private (GIS_KEYBOARD_PAGE (page));
+        gchar *layout;
+        gchar *type;
+
+        layout = g_key_file_get_string (answers, group, "layout", error);
+        if (layout == NULL)
+                return FALSE;
+
+        type = g_key_file_get_string (answers, group, "type", NULL);
+
+        cc_input_chooser_set_input (CC_INPUT_CHOOSER (priv->input_chooser),
+                                    layout, type != NULL ? type : "xkb");
+
+        g_free (layout);
+        g_free (type);
+
+        return TRUE;
 }
 
 static void
@@ -408,12 +505,17 @@ gis_keyboard_page_class_init (GisKeyboardPageClass * klass)
 
         gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-keyboard-page.ui");
 
+        gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisKeyboardPage, title);
+        gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisKeyboardPage, subtitle);
         gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisKeyboardPage, input_chooser);
         gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisKeyboardPage, input_auto_detect);
 
         page_class->page_id = PAGE_ID;
         page_class->apply = gis_keyboard_page_apply;
         page_class->locale_changed = gis_keyboard_page_locale_changed;
+        page_class->apply_answers = gis_keyboard_page_apply_answers;
+        page_class->release_resources = gis_keyboard_page_release_resources;
+        page_class->restore_resources = gis_keyboard_page_restore_resources;
         object_class->constructed = gis_keyboard_page_constructed;
 	object_class->finalize = gis_keyboard_page_finalize;
 }
@@ -30,6 +30,8 @@ G_BEGIN_DECLS
 gboolean cc_common_language_has_font                (const gchar  *locale);
 gchar   *cc_common_language_get_current_language    (void);
 GHashTable *cc_common_language_get_initial_languages   (void);
+void     cc_common_language_watch_users             (GCallback     callback,
+                                                     gpointer      object);
 
 G_END_DECLS
 
@@ -52,6 +52,12 @@ struct _CcLanguageChooserPrivate
 
         gboolean showing_extra;
         gchar *language;
+
+        /* locale ID → whether it is extra, for the rows that were
+         * built, so that they can be built again without asking
+         * fontconfig about every locale */
+        GHashTable *locales;
+        gboolean rows_released;
 };
 typedef struct _CcLanguageChooserPrivate CcLanguageChooserPrivate;
 G_DEFINE_TYPE_WITH_PRIVATE (CcLanguageChooser, cc_language_chooser, GTK_TYPE_BOX);
@@ -321,8 +327,11 @@ add_one_language (CcLanguageChooser *chooser,
 	}
 
 	widget = language_widget_new (locale_id, !is_initial);
-        if (widget)
+        if (widget) {
                 gtk_container_add (GTK_CONTAINER (priv->language_list), widget);
+                g_hash_table_insert (priv->locales, g_strdup (locale_id),
+                                     GINT_TO_POINTER (!is_initial));
+        }
 }
 
 static void
@@ -368,6 +377,45 @@ add_all_languages (CcLanguageChooser *chooser)
         g_strfreev (locale_ids);
 }
 
+/* Moves the languages of users that have been loaded since the rows
+ * were built up with the initial ones */
+static void
+users_changed (CcLanguageChooser *chooser)
+{
+        CcLanguageChooserPrivate *priv = cc_language_chooser_get_instance_private (chooser);
+        GHashTable *initial;
+        GHashTableIter iter;
+        gpointer locale_id;
+        GList *rows, *l;
+        LanguageWidget *widget;
+
+        initial = cc_common_language_get_initial_languages ();
+
+        g_hash_table_iter_init (&iter, initial);
+        while (g_hash_table_iter_next (&iter, &locale_id, NULL)) {
+                if (priv->rows_released || g_hash_table_contains (priv->locales, locale_id))
+                        g_hash_table_insert (priv->locales, g_strdup (locale_id),
+                                             GINT_TO_POINTER (FALSE));
+                else
+                        add_one_language (chooser, locale_id, TRUE);
+        }
+
+        rows = gtk_container_get_children (GTK_CONTAINER (priv->language_list));
+        for (l = rows; l; l = l->next) {
+                widget = get_language_widget (gtk_bin_get_child (GTK_BIN (l->data)));
+                if (widget != NULL && g_hash_table_contains (initial, widget->locale_id))
+                        widget->is_extra = FALSE;
+        }
+        g_list_free (rows);
+
+        g_hash_table_destroy (initial);
+
+        gtk_widget_show_all (priv->language_list);
+        gtk_list_box_invalidate_sort (GTK_LIST_BOX (priv->language_list));
+        gtk_list_box_invalidate_filter (GTK_LIST_BOX (priv->language_list));
+        sync_all_checkmarks (chooser);
+}
+
 static gboolean
 language_visible (GtkListBoxRow *row,
                   gpointer       user_data)
@@ -547,6 +595,7 @@ cc_language_chooser_constructed (GObject *object)
 
         G_OBJECT_CLASS (cc_language_chooser_parent_class)->constructed (object);
 
+        priv->locales = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
         priv->more_item = more_widget_new ();
         priv->no_results = no_results_widget_new ();
 
@@ -559,6 +608,7 @@ cc_language_chooser_constructed (GObject *object)
         gtk_list_box_set_selection_mode (GTK_LIST_BOX (priv->language_list),
                                          GTK_SELECTION_NONE);
         add_all_languages (chooser);
+        cc_common_language_watch_users (G_CALLBACK (users_changed), chooser);
 
         g_signal_connect (priv->filter_entry, "changed",
                           G_CALLBACK (filter_changed),
@@ -581,6 +631,7 @@ cc_language_chooser_finalize (GObject *object)
         CcLanguageChooserPrivate *priv = cc_language_chooser_get_instance_private (chooser);
 
         g_free (priv->language);
+        g_clear_pointer (&priv->locales, g_hash_table_unref);
 
 	G_OBJECT_CLASS (cc_language_chooser_parent_class)->finalize (object);
 }
@@ -690,3 +741,48 @@ cc_language_chooser_get_showing_extra (CcLanguageChooser *chooser)
         CcLanguageChooserPrivate *priv = cc_language_chooser_get_instance_private (chooser);
         return priv->showing_extra;
 }
+
+/* Drops the rows for the languages, while the chooser is not shown */
+void
+cc_language_chooser_release_rows (CcLanguageChooser *chooser)
+{
+        CcLanguageChooserPrivate *priv = cc_language_chooser_get_instance_private (chooser);
+        GList *rows, *l;
+
+        if (priv->rows_released)
+                return;
+
+        rows = gtk_container_get_children (GTK_CONTAINER (priv->language_list));
+        for (l = rows; l; l = l->next) {
+                if (get_language_widget (gtk_bin_get_child (GTK_BIN (l->data))) != NULL)
+                        gtk_widget_destroy (GTK_WIDGET (l->data));
+        }
+        g_list_free (rows);
+
+        priv->to_be_scrolled_row = NULL;
+        priv->rows_released = TRUE;
+}
+
+void
+cc_language_chooser_restore_rows (CcLanguageChooser *chooser)
+{
+        CcLanguageChooserPrivate *priv = cc_language_chooser_get_instance_private (chooser);
+        GHashTableIter iter;
+        gpointer locale_id, is_extra;
+        GtkWidget *widget;
+
+        if (!priv->rows_released)
+                return;
+
+        g_hash_table_iter_init (&iter, priv->locales);
+        while (g_hash_table_iter_next (&iter, &locale_id, &is_extra)) {
+                widget = language_widget_new (locale_id, GPOINTER_TO_INT (is_extra));
+                if (widget)
+                        gtk_container_add (GTK_CONTAINER (priv->language_list), widget);
+        }
+
+        gtk_widget_show_all (priv->language_list);
+        priv->rows_released = FALSE;
+
+        sync_all_checkmarks (chooser);
+}
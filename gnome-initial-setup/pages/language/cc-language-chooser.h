@@ -57,6 +57,8 @@ const gchar * cc_language_chooser_get_language (CcLanguageChooser *chooser);
 void          cc_language_chooser_set_language (CcLanguageChooser *chooser,
                                                 const gchar        *language);
 gboolean      cc_language_chooser_get_showing_extra (CcLanguageChooser *chooser);
+void          cc_language_chooser_release_rows (CcLanguageChooser *chooser);
+void          cc_language_chooser_restore_rows (CcLanguageChooser *chooser);
 
 G_END_DECLS
 
@@ -37,7 +37,6 @@
 #include "gis-language-page.h"
 
 #include <act/act-user-manager.h>
-#include <polkit/polkit.h>
 #include <locale.h>
 #include <gtk/gtk.h>
 
@@ -47,12 +46,8 @@ struct _GisLanguagePagePrivate
   GtkWidget *welcome_widget;
   GtkWidget *language_chooser;
 
-  GDBusProxy *localed;
-  GPermission *permission;
   const gchar *new_locale_id;
 
-  GCancellable *cancellable;
-
   GtkAccelGroup *accel_group;
 };
 typedef struct _GisLanguagePagePrivate GisLanguagePagePrivate;
@@ -71,11 +66,14 @@ set_localed_locale (GisLanguagePage *self)
   g_variant_builder_add (b, "s", s);
   g_free (s);
 
-  g_dbus_proxy_call (priv->localed,
-                     "SetLocale",
-                     g_variant_new ("(asb)", b, TRUE),
-                     G_DBUS_CALL_FLAGS_NONE,
-                     -1, NULL, NULL, NULL);
+  /* Only the last language chosen is sent to localed */
+  gis_settings_transaction_set_call (gis_driver_get_settings_transaction (GIS_PAGE (self)->driver),
+                                     "locale",
+                                     "org.freedesktop.locale1",
+                                     "/org/freedesktop/locale1",
+                                     "org.freedesktop.locale1",
+                                     "SetLocale",
+                                     g_variant_new ("(asb)", b, TRUE));
   g_variant_builder_unref (b);
 }
 
@@ -85,20 +83,51 @@ change_locale_permission_acquired (GObject      *source,
                                    gpointer      data)
 {
   GisLanguagePage *page = GIS_LANGUAGE_PAGE (data);
-  GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (page);
   GError *error = NULL;
   gboolean allowed;
 
-  allowed = g_permission_acquire_finish (priv->permission, res, &error);
+  allowed = g_permission_acquire_finish (G_PERMISSION (source), res, &error);
   if (error) {
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_warning ("Failed to acquire permission: %s\n", error->message);
       g_error_free (error);
+      g_object_unref (page);
       return;
   }
 
   if (allowed)
     set_localed_locale (page);
+  g_object_unref (page);
+}
+
+static void
+change_locale_permission_ready (GObject      *source,
+                                GAsyncResult *res,
+                                gpointer      data)
+{
+  GisLanguagePage *page = GIS_LANGUAGE_PAGE (data);
+  GPermission *permission;
+  GError *error = NULL;
+
+  permission = gis_permission_cache_get_finish (GIS_PERMISSION_CACHE (source), res, &error);
+  if (permission == NULL) {
+      g_error_free (error);
+      g_object_unref (page);
+      return;
+  }
+
+  if (g_permission_get_allowed (permission)) {
+      set_localed_locale (page);
+  }
+  else if (g_permission_get_can_acquire (permission)) {
+      g_permission_acquire_async (permission,
+                                  NULL,
+                                  change_locale_permission_acquired,
+                                  g_object_ref (page));
+  }
+
+  g_object_unref (permission);
+  g_object_unref (page);
 }
 
 static void
@@ -134,17 +163,12 @@ language_changed (CcLanguageChooser  *chooser,
   g_setenv ("LC_MESSAGES", priv->new_locale_id, TRUE);
   g_setenv ("LC_TIME", priv->new_locale_id, TRUE);
 
-  if (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER) {
-      if (g_permission_get_allowed (priv->permission)) {
-          set_localed_locale (page);
-      }
-      else if (g_permission_get_can_acquire (priv->permission)) {
-          g_permission_acquire_async (priv->permission,
-                                      NULL,
-                                      change_locale_permission_acquired,
-                                      page);
-      }
-  }
+  if (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER)
+    gis_permission_cache_get_async (gis_driver_get_permission_cache (driver),
+                                    "org.freedesktop.locale1.set-locale",
+                                    NULL,
+                                    change_locale_permission_ready,
+                                    g_object_ref (page));
 
   /* Ensure we won't override the selected language for format strings */
   region_settings = g_settings_new (GNOME_SYSTEM_LOCALE_DIR);
@@ -169,28 +193,6 @@ language_changed (CcLanguageChooser  *chooser,
   gis_driver_locale_changed (driver);
 }
 
-static void
-localed_proxy_ready (GObject      *source,
-                     GAsyncResult *res,
-                     gpointer      data)
-{
-  GisLanguagePage *self = data;
-  GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (self);
-  GDBusProxy *proxy;
-  GError *error = NULL;
-
-  proxy = g_dbus_proxy_new_finish (res, &error);
-
-  if (!proxy) {
-      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("Failed to contact localed: %s\n", error->message);
-      g_error_free (error);
-      return;
-  }
-
-  priv->localed = proxy;
-}
-
 static char *
 get_item (const char *buffer, const char *name)
 {
@@ -265,7 +267,6 @@ gis_language_page_constructed (GObject *object)
 {
   GisLanguagePage *page = GIS_LANGUAGE_PAGE (object);
   GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (page);
-  GDBusConnection *bus;
   GClosure *closure;
 
   g_type_ensure (CC_TYPE_LANGUAGE_CHOOSER);
@@ -279,24 +280,6 @@ gis_language_page_constructed (GObject *object)
   g_signal_connect (priv->language_chooser, "confirm",
                     G_CALLBACK (language_confirmed), page);
 
-  /* If we're in new user mode then we're manipulating system settings */
-  if (gis_driver_get_mode (GIS_PAGE (page)->driver) == GIS_DRIVER_MODE_NEW_USER)
-    {
-      priv->permission = polkit_permission_new_sync ("org.freedesktop.locale1.set-locale", NULL, NULL, NULL);
-
-      bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
-      g_dbus_proxy_new (bus,
-                        G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
-                        NULL,
-                        "org.freedesktop.locale1",
-                        "/org/freedesktop/locale1",
-                        "org.freedesktop.locale1",
-                        priv->cancellable,
-                        (GAsyncReadyCallback) localed_proxy_ready,
-                        object);
-      g_object_unref (bus);
-  }
-
   /* Use ctrl+f to show factory dialog */
   priv->accel_group = gtk_accel_group_new ();
   closure = g_cclosure_new_swap (G_CALLBACK (gis_page_util_show_factory_dialog), page, NULL);
@@ -322,15 +305,47 @@ gis_language_page_locale_changed (GisPage *page)
   gis_page_set_title (GIS_PAGE (page), _("Welcome"));
 }
 
+static void
+gis_language_page_release_resources (GisPage *page)
+{
+  GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (GIS_LANGUAGE_PAGE (page));
+
+  cc_language_chooser_release_rows (CC_LANGUAGE_CHOOSER (priv->language_chooser));
+}
+
+static void
+gis_language_page_restore_resources (GisPage *page)
+{
+  GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (GIS_LANGUAGE_PAGE (page));
+
+  cc_language_chooser_restore_rows (CC_LANGUAGE_CHOOSER (priv->language_chooser));
+}
+
+static gboolean
+gis_language_page_apply_answers (GisPage      *page,
+                                 GKeyFile     *answers,
+                                 const gchar  *group,
+                                 GError      **error)
+{
+  GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (GIS_LANGUAGE_PAGE (page));
+  gchar *locale;
+
+  locale = g_key_file_get_string (answers, group, "locale", error);
+  if (locale == NULL)
+    return FALSE;
+
+  cc_language_chooser_set_language (CC_LANGUAGE_CHOOSER (priv->language_chooser), locale);
+  g_free (locale);
+
+  return TRUE;
+}
+
 static void
 gis_language_page_dispose (GObject *object)
 {
   GisLanguagePage *page = GIS_LANGUAGE_PAGE (object);
   GisLanguagePagePrivate *priv = gis_language_page_get_instance_private (page);
 
-  g_clear_object (&priv->permission);
-  g_clear_object (&priv->localed);
-  g_clear_object (&priv->cancellable);
   g_clear_object (&priv->accel_group);
 
   G_OBJECT_CLASS (gis_language_page_parent_class)->dispose (object);
@@ -351,6 +366,9 @@ gis_language_page_class_init (GisLanguagePageClass *klass)
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_language_page_locale_changed;
   page_class->get_accel_group = gis_language_page_get_accel_group;
+  page_class->apply_answers = gis_language_page_apply_answers;
+  page_class->release_resources = gis_language_page_release_resources;
+  page_class->restore_resources = gis_language_page_restore_resources;
   object_class->constructed = gis_language_page_constructed;
   object_class->dispose = gis_language_page_dispose;
 }
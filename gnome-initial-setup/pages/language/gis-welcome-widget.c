@@ -152,9 +152,17 @@ fill_stack (GisWelcomeWidget *widget)
   GHashTableIter iter;
   gpointer key, value;
   GHashTable *added_translations;
+  GList *children, *l;
 
   added_translations = g_hash_table_new (g_str_hash, g_str_equal);
 
+  /* When filling it again, keep the labels that are there already */
+  children = gtk_container_get_children (GTK_CONTAINER (priv->stack));
+  for (l = children; l != NULL; l = l->next)
+    g_hash_table_insert (added_translations,
+                         (gpointer) gtk_label_get_text (GTK_LABEL (l->data)), l->data);
+  g_list_free (children);
+
   g_hash_table_iter_init (&iter, initial);
   while (g_hash_table_iter_next (&iter, &key, &value))
     {
@@ -162,7 +170,8 @@ fill_stack (GisWelcomeWidget *widget)
       char *text;
       GtkWidget *label;
 
-      if (!cc_common_language_has_font (locale_id))
+      if (g_hash_table_contains (priv->translation_widgets, locale_id) ||
+          !cc_common_language_has_font (locale_id))
         continue;
 
       text = welcome (locale_id);
@@ -174,16 +183,21 @@ fill_stack (GisWelcomeWidget *widget)
         g_hash_table_insert (added_translations, text, label);
       }
 
-      g_hash_table_insert (priv->translation_widgets, locale_id, label);
+      g_hash_table_insert (priv->translation_widgets, g_strdup (locale_id), label);
     }
 
   g_hash_table_destroy (added_translations);
+  g_hash_table_destroy (initial);
 }
 
 static void
 gis_welcome_widget_constructed (GObject *object)
 {
   fill_stack (GIS_WELCOME_WIDGET (object));
+
+  /* Welcome the other users in their languages too, once they are
+   * loaded */
+  cc_common_language_watch_users (G_CALLBACK (fill_stack), object);
 }
 
 static void
@@ -218,7 +232,7 @@ gis_welcome_widget_init (GisWelcomeWidget *widget)
 {
   GisWelcomeWidgetPrivate *priv = gis_welcome_widget_get_instance_private (widget);
 
-  priv->translation_widgets = g_hash_table_new (g_str_hash, g_str_equal);
+  priv->translation_widgets = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
   gtk_widget_init_template (GTK_WIDGET (widget));
 }
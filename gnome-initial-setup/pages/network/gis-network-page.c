@@ -37,9 +37,16 @@
 #include <nm-access-point.h>
 #include <nm-utils.h>
 #include <nm-remote-settings.h>
+#include <nm-setting-connection.h>
+#include <nm-setting-wireless.h>
+#include <nm-setting-wireless-security.h>
+#include <nm-setting-ip4-config.h>
 
 #include "network-dialogs.h"
 
+/* Seconds to wait for the vendor network before showing the page */
+#define DEFAULT_AUTO_JOIN_TIMEOUT 30
+
 typedef enum {
   NM_AP_SEC_UNKNOWN,
   NM_AP_SEC_NONE,
@@ -49,6 +56,8 @@ typedef enum {
 } NMAccessPointSecurity;
 
 struct _GisNetworkPagePrivate {
+  GtkWidget *title;
+  GtkWidget *description;
   GtkWidget *network_list;
   GtkWidget *scrolled_window;
   GtkWidget *no_network_label;
@@ -65,6 +74,13 @@ struct _GisNetworkPagePrivate {
 };
 typedef struct _GisNetworkPagePrivate GisNetworkPagePrivate;
 
+typedef struct {
+  gchar *ssid;
+  gchar *security;
+  gchar *psk;
+  guint timeout;
+} VendorWifiProfile;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GisNetworkPage, gis_network_page, GIS_TYPE_PAGE);
 
 static GPtrArray *
@@ -420,37 +436,19 @@ connect_to_hidden_network (GisNetworkPage *page)
                                               priv->nm_settings);
 }
 
-static void
-row_activated (GtkListBox *box,
-               GtkListBoxRow *row,
-               GisNetworkPage *page)
+static NMConnection *
+find_connection_for_ssid (NMRemoteSettings *settings,
+                          NMDevice         *device,
+                          const GByteArray *ssid_target)
 {
-  GisNetworkPagePrivate *priv = gis_network_page_get_instance_private (page);
-  gchar *object_path;
   GSList *list, *filtered, *l;
   NMConnection *connection;
-  NMConnection *connection_to_activate;
+  NMConnection *found = NULL;
   NMSettingWireless *setting;
-  const GByteArray *ssid_target;
   const GByteArray *ssid;
-  GtkWidget *child;
 
-  if (priv->refreshing)
-    return;
-
-  child = gtk_bin_get_child (GTK_BIN (row));
-  object_path = g_object_get_data (G_OBJECT (child), "object-path");
-  ssid_target = g_object_get_data (G_OBJECT (child), "ssid");
-
-  if (g_strcmp0 (object_path, "ap-other...") == 0) {
-    connect_to_hidden_network (page);
-    goto out;
-  }
-
-  list = nm_remote_settings_list_connections (priv->nm_settings);
-  filtered = nm_device_filter_connections (priv->nm_device, list);
-
-  connection_to_activate = NULL;
+  list = nm_remote_settings_list_connections (settings);
+  filtered = nm_device_filter_connections (device, list);
 
   for (l = filtered; l; l = l->next) {
     connection = NM_CONNECTION (l->data);
@@ -463,13 +461,40 @@ row_activated (GtkListBox *box,
       continue;
 
     if (nm_utils_same_ssid (ssid, ssid_target, TRUE)) {
-      connection_to_activate = connection;
+      found = connection;
       break;
     }
   }
   g_slist_free (list);
   g_slist_free (filtered);
 
+  return found;
+}
+
+static void
+row_activated (GtkListBox *box,
+               GtkListBoxRow *row,
+               GisNetworkPage *page)
+{
+  GisNetworkPagePrivate *priv = gis_network_page_get_instance_private (page);
+  gchar *object_path;
+  NMConnection *connection_to_activate;
+  const GByteArray *ssid_target;
+  GtkWidget *child;
+
+  if (priv->refreshing)
+    return;
+
+  child = gtk_bin_get_child (GTK_BIN (row));
+  object_path = g_object_get_data (G_OBJECT (child), "object-path");
+  ssid_target = g_object_get_data (G_OBJECT (child), "ssid");
+
+  if (g_strcmp0 (object_path, "ap-other...") == 0) {
+    connect_to_hidden_network (page);
+    goto out;
+  }
+
+  connection_to_activate = find_connection_for_ssid (priv->nm_settings, priv->nm_device, ssid_target);
   if (connection_to_activate != NULL) {
     nm_client_activate_connection (priv->nm_client,
                                    connection_to_activate,
@@ -530,14 +555,408 @@ device_state_changed (GObject *object, GParamSpec *param, GisNetworkPage *page)
   sync_complete (page);
 }
 
+static void
+vendor_wifi_profile_free (VendorWifiProfile *profile)
+{
+  g_free (profile->ssid);
+  g_free (profile->security);
+  g_free (profile->psk);
+  g_slice_free (VendorWifiProfile, profile);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (VendorWifiProfile, vendor_wifi_profile_free)
+
+static VendorWifiProfile *
+read_vendor_wifi_profile (GisDriver *driver)
+{
+  GisVendorConfig *config = gis_driver_get_vendor_config (driver);
+  VendorWifiProfile *profile;
+  const gchar *ssid;
+  const gchar *security;
+  gint timeout;
+
+  ssid = gis_vendor_config_get_network_ssid (config);
+  if (ssid == NULL)
+    return NULL;
+
+  profile = g_slice_new0 (VendorWifiProfile);
+  profile->ssid = g_strdup (ssid);
+  profile->psk = g_strdup (gis_vendor_config_get_network_psk (config));
+
+  security = gis_vendor_config_get_network_security (config);
+  if (security == NULL)
+    security = profile->psk != NULL ? "wpa-psk" : "none";
+  profile->security = g_strdup (security);
+
+  if ((g_str_equal (security, "wpa-psk") || g_str_equal (security, "wep")) &&
+      (profile->psk == NULL || *profile->psk == '\0')) {
+    g_warning ("No psk for vendor network %s with security '%s'",
+               profile->ssid, profile->security);
+    vendor_wifi_profile_free (profile);
+    return NULL;
+  }
+
+  timeout = gis_vendor_config_get_network_timeout (config);
+  if (timeout <= 0)
+    timeout = DEFAULT_AUTO_JOIN_TIMEOUT;
+  profile->timeout = timeout;
+
+  return profile;
+}
+
+static NMConnection *
+connection_for_vendor_profile (VendorWifiProfile *profile,
+                               GByteArray        *ssid)
+{
+  NMConnection *connection;
+  NMSettingConnection *s_con;
+  NMSettingWireless *s_wifi;
+  NMSettingWirelessSecurity *s_wsec;
+  NMSetting *s_ip4;
+  gchar *uuid;
+
+  connection = nm_connection_new ();
+
+  s_con = (NMSettingConnection *) nm_setting_connection_new ();
+  uuid = nm_utils_uuid_generate ();
+  g_object_set (s_con,
+                NM_SETTING_CONNECTION_ID, profile->ssid,
+                NM_SETTING_CONNECTION_UUID, uuid,
+                NM_SETTING_CONNECTION_TYPE, NM_SETTING_WIRELESS_SETTING_NAME,
+                NM_SETTING_CONNECTION_AUTOCONNECT, TRUE,
+                NULL);
+  g_free (uuid);
+  nm_connection_add_setting (connection, NM_SETTING (s_con));
+
+  s_wifi = (NMSettingWireless *) nm_setting_wireless_new ();
+  g_object_set (s_wifi, NM_SETTING_WIRELESS_SSID, ssid, NULL);
+  nm_connection_add_setting (connection, NM_SETTING (s_wifi));
+
+  if (g_strcmp0 (profile->security, "wpa-psk") == 0) {
+    g_object_set (s_wifi, NM_SETTING_WIRELESS_SEC, NM_SETTING_WIRELESS_SECURITY_SETTING_NAME, NULL);
+    s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+    g_object_set (s_wsec,
+                  NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+                  NM_SETTING_WIRELESS_SECURITY_PSK, profile->psk,
+                  NULL);
+    nm_connection_add_setting (connection, NM_SETTING (s_wsec));
+  } else if (g_strcmp0 (profile->security, "wep") == 0) {
+    g_object_set (s_wifi, NM_SETTING_WIRELESS_SEC, NM_SETTING_WIRELESS_SECURITY_SETTING_NAME, NULL);
+    s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+    g_object_set (s_wsec,
+                  NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "none",
+                  NM_SETTING_WIRELESS_SECURITY_WEP_KEY_TYPE, NM_WEP_KEY_TYPE_PASSPHRASE,
+                  NULL);
+    nm_setting_wireless_security_set_wep_key (s_wsec, 0, profile->psk);
+    nm_connection_add_setting (connection, NM_SETTING (s_wsec));
+  } else if (g_strcmp0 (profile->security, "none") != 0) {
+    g_warning ("Unsupported security '%s' for vendor network %s",
+               profile->security, profile->ssid);
+    g_object_unref (connection);
+    return NULL;
+  }
+
+  s_ip4 = nm_setting_ip4_config_new ();
+  g_object_set (s_ip4, NM_SETTING_IP4_CONFIG_METHOD, NM_SETTING_IP4_CONFIG_METHOD_AUTO, NULL);
+  nm_connection_add_setting (connection, s_ip4);
+
+  return connection;
+}
+
+/* Joining the vendor network starts with the rest of setup rather than
+ * when the page is built, so it does not belong to the page. It hangs
+ * off the driver instead, which also remembers that it was tried, so
+ * that rebuilding the pages does not start it again.
+ */
+#define AUTO_JOIN_KEY "gis-network-page-auto-join"
+
+typedef struct {
+  VendorWifiProfile *profile;
+  GCancellable *cancellable;
+  NMClient *nm_client;
+  NMRemoteSettings *nm_settings;
+  NMDevice *nm_device;
+  /* only set while joining */
+  guint timeout_id;
+  /* once it is built */
+  GisNetworkPage *page;
+} AutoJoin;
+
+static void auto_join_device_state_changed (NMDevice   *device,
+                                            GParamSpec *pspec,
+                                            gpointer    user_data);
+
+static void
+stop_auto_join (AutoJoin *auto_join)
+{
+  g_cancellable_cancel (auto_join->cancellable);
+
+  if (auto_join->timeout_id != 0) {
+    g_source_remove (auto_join->timeout_id);
+    auto_join->timeout_id = 0;
+  }
+
+  if (auto_join->page != NULL) {
+    g_object_remove_weak_pointer (G_OBJECT (auto_join->page),
+                                  (gpointer *) &auto_join->page);
+    auto_join->page = NULL;
+  }
+
+  if (auto_join->nm_device != NULL)
+    g_signal_handlers_disconnect_by_func (auto_join->nm_device,
+                                          auto_join_device_state_changed, auto_join);
+  g_clear_object (&auto_join->nm_device);
+  g_clear_object (&auto_join->nm_settings);
+  g_clear_object (&auto_join->nm_client);
+}
+
+static void
+auto_join_free (AutoJoin *auto_join)
+{
+  stop_auto_join (auto_join);
+
+  g_clear_pointer (&auto_join->profile, vendor_wifi_profile_free);
+  g_object_unref (auto_join->cancellable);
+  g_slice_free (AutoJoin, auto_join);
+}
+
+static void
+auto_join_finished (GisNetworkPage *page)
+{
+  GisAssistant *assistant;
+
+  g_debug ("Vendor network activated, skipping network page");
+
+  /* If the user has already reached us, move on; otherwise just make sure
+   * we are never shown. */
+  assistant = gis_driver_get_assistant (GIS_PAGE (page)->driver);
+  if (gis_assistant_get_current_page (assistant) == GIS_PAGE (page))
+    gis_assistant_next_page (assistant);
+  else
+    gtk_widget_hide (GTK_WIDGET (page));
+}
+
+static void
+auto_join_device_state_changed (NMDevice   *device,
+                                GParamSpec *pspec,
+                                gpointer    user_data)
+{
+  AutoJoin *auto_join = user_data;
+  GisNetworkPage *page;
+
+  if (nm_device_get_state (device) != NM_DEVICE_STATE_ACTIVATED)
+    return;
+
+  page = auto_join->page;
+  stop_auto_join (auto_join);
+
+  /* A page built after this finds the device activated and hides
+   * itself */
+  if (page != NULL)
+    auto_join_finished (page);
+}
+
+static gboolean
+auto_join_timeout (gpointer user_data)
+{
+  AutoJoin *auto_join = user_data;
+
+  g_warning ("Timed out joining the vendor network, showing network page");
+
+  auto_join->timeout_id = 0;
+  stop_auto_join (auto_join);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+auto_join_activate_cb (NMClient           *client,
+                       NMActiveConnection *connection,
+                       GError             *error,
+                       gpointer            user_data)
+{
+  AutoJoin *auto_join = user_data;
+
+  if (connection == NULL && auto_join->timeout_id != 0) {
+    g_warning ("Could not activate vendor network: %s",
+               error ? error->message : "unknown error");
+    stop_auto_join (auto_join);
+  }
+}
+
+static void
+auto_join_add_activate_cb (NMClient           *client,
+                           NMActiveConnection *connection,
+                           const char         *path,
+                           GError             *error,
+                           gpointer            user_data)
+{
+  auto_join_activate_cb (client, connection, error, user_data);
+}
+
+static NMDevice *
+find_wifi_device (NMClient *client)
+{
+  const GPtrArray *devices;
+  NMDevice *device;
+  guint i;
+
+  devices = nm_client_get_devices (client);
+  if (devices == NULL)
+    return NULL;
+
+  for (i = 0; i < devices->len; i++) {
+    device = g_ptr_array_index (devices, i);
+
+    if (!nm_device_get_managed (device))
+      continue;
+
+    /* FIXME deal with multiple, dynamic devices */
+    if (nm_device_get_device_type (device) == NM_DEVICE_TYPE_WIFI)
+      return device;
+  }
+
+  return NULL;
+}
+
+static void
+auto_join_settings_ready (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  AutoJoin *auto_join = user_data;
+  NMRemoteSettings *settings;
+  NMConnection *connection;
+  GByteArray *ssid;
+  GError *error = NULL;
+
+  settings = nm_remote_settings_new_finish (result, &error);
+  if (settings == NULL) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_warning ("Could not get the network settings: %s", error->message);
+      stop_auto_join (auto_join);
+    }
+    g_error_free (error);
+    return;
+  }
+
+  /* Stopped while we were waiting */
+  if (auto_join->timeout_id == 0) {
+    g_object_unref (settings);
+    return;
+  }
+
+  auto_join->nm_settings = settings;
+
+  ssid = g_byte_array_new ();
+  g_byte_array_append (ssid, (const guint8 *) auto_join->profile->ssid,
+                       strlen (auto_join->profile->ssid));
+
+  /* Reuse a connection from a previous attempt rather than piling up
+   * duplicates on every boot of the image. */
+  connection = find_connection_for_ssid (auto_join->nm_settings, auto_join->nm_device, ssid);
+  if (connection != NULL) {
+    g_debug ("Activating existing connection for vendor network %s", auto_join->profile->ssid);
+    nm_client_activate_connection (auto_join->nm_client,
+                                   connection,
+                                   auto_join->nm_device, NULL,
+                                   auto_join_activate_cb, auto_join);
+    goto out;
+  }
+
+  connection = connection_for_vendor_profile (auto_join->profile, ssid);
+  if (connection == NULL) {
+    stop_auto_join (auto_join);
+    goto out;
+  }
+
+  g_debug ("Adding connection for vendor network %s", auto_join->profile->ssid);
+  nm_client_add_and_activate_connection (auto_join->nm_client,
+                                         connection,
+                                         auto_join->nm_device, NULL,
+                                         auto_join_add_activate_cb, auto_join);
+  g_object_unref (connection);
+
+ out:
+  g_byte_array_unref (ssid);
+}
+
+static void
+auto_join_client_ready (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+  AutoJoin *auto_join = user_data;
+  NMClient *client;
+  NMDevice *device;
+  GError *error = NULL;
+
+  client = nm_client_new_finish (result, &error);
+  if (client == NULL) {
+    if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      g_warning ("Could not get a NetworkManager client: %s", error->message);
+      stop_auto_join (auto_join);
+    }
+    g_error_free (error);
+    return;
+  }
+
+  if (auto_join->timeout_id == 0) {
+    g_object_unref (client);
+    return;
+  }
+
+  auto_join->nm_client = client;
+
+  /* Only bother when the page would be shown at all, i.e. there is a
+   * wireless device and it is not connected yet. */
+  device = find_wifi_device (client);
+  if (device == NULL || nm_device_get_state (device) == NM_DEVICE_STATE_ACTIVATED) {
+    stop_auto_join (auto_join);
+    return;
+  }
+
+  auto_join->nm_device = g_object_ref (device);
+  g_signal_connect (auto_join->nm_device, "notify::state",
+                    G_CALLBACK (auto_join_device_state_changed), auto_join);
+
+  nm_remote_settings_new_async (NULL, auto_join->cancellable,
+                                auto_join_settings_ready, auto_join);
+}
+
+/* Joins the network from the vendor configuration, if there is one, in
+ * the background. The network page is skipped once it is joined, or is
+ * shown as usual if that does not happen in time. */
+void
+gis_network_page_start_auto_join (GisDriver *driver)
+{
+  AutoJoin *auto_join;
+
+  if (g_object_get_data (G_OBJECT (driver), AUTO_JOIN_KEY) != NULL)
+    return;
+
+  auto_join = g_slice_new0 (AutoJoin);
+  auto_join->cancellable = g_cancellable_new ();
+  g_object_set_data_full (G_OBJECT (driver), AUTO_JOIN_KEY, auto_join,
+                          (GDestroyNotify) auto_join_free);
+
+  auto_join->profile = read_vendor_wifi_profile (driver);
+  if (auto_join->profile == NULL)
+    return;
+
+  /* The timeout covers getting NetworkManager's state too */
+  auto_join->timeout_id = g_timeout_add_seconds (auto_join->profile->timeout,
+                                                 auto_join_timeout, auto_join);
+  nm_client_new_async (auto_join->cancellable, auto_join_client_ready, auto_join);
+}
+
 static void
 gis_network_page_constructed (GObject *object)
 {
   GisNetworkPage *page = GIS_NETWORK_PAGE (object);
   GisNetworkPagePrivate *priv = gis_network_page_get_instance_private (page);
-  const GPtrArray *devices;
+  AutoJoin *auto_join;
   NMDevice *device;
-  guint i;
   gboolean visible = FALSE;
 
   G_OBJECT_CLASS (gis_network_page_parent_class)->constructed (object);
@@ -550,21 +969,9 @@ gis_network_page_constructed (GObject *object)
                           priv->turn_on_switch, "active",
                           G_BINDING_BIDIRECTIONAL | G_BINDING_SYNC_CREATE);
 
-  devices = nm_client_get_devices (priv->nm_client);
-  if (devices) {
-    for (i = 0; i < devices->len; i++) {
-      device = g_ptr_array_index (devices, i);
-
-      if (!nm_device_get_managed (device))
-        continue;
-
-      if (nm_device_get_device_type (device) == NM_DEVICE_TYPE_WIFI) {
-        /* FIXME deal with multiple, dynamic devices */
-        priv->nm_device = g_object_ref (device);
-        break;
-      }
-    }
-  }
+  device = find_wifi_device (priv->nm_client);
+  if (device != NULL)
+    priv->nm_device = g_object_ref (device);
 
   if (priv->nm_device == NULL) {
     g_debug ("No network device found, hiding network page");
@@ -595,6 +1002,13 @@ gis_network_page_constructed (GObject *object)
 
   gis_page_set_skippable (GIS_PAGE (page), TRUE);
 
+  /* Skip ahead if the vendor network is joined while we are up */
+  auto_join = g_object_get_data (G_OBJECT (GIS_PAGE (page)->driver), AUTO_JOIN_KEY);
+  if (auto_join != NULL && auto_join->timeout_id != 0) {
+    auto_join->page = page;
+    g_object_add_weak_pointer (G_OBJECT (page), (gpointer *) &auto_join->page);
+  }
+
  out:
   gtk_widget_set_visible (GTK_WIDGET (page), visible);
 }
@@ -622,7 +1036,19 @@ gis_network_page_dispose (GObject *object)
 static void
 gis_network_page_locale_changed (GisPage *page)
 {
+  GisNetworkPagePrivate *priv = gis_network_page_get_instance_private (GIS_NETWORK_PAGE (page));
+
   gis_page_set_title (GIS_PAGE (page), _("Network"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Wi-Fi"));
+  gtk_label_set_label (GTK_LABEL (priv->description), _("Connecting to the Internet will enable you to set the time, add your details, and enable you to access your email, calendar, and contacts. It is also necessary for enterprise login accounts."));
+  gtk_label_set_label (GTK_LABEL (priv->turn_on_label), _("Turn On"));
+
+  /* Rebuild the list so the status text and "Other…" row are translated */
+  if (priv->nm_device != NULL)
+    refresh_wireless_list (GIS_NETWORK_PAGE (page));
+  else
+    gtk_label_set_label (GTK_LABEL (priv->no_network_label), _("No wireless available"));
 }
 
 static void
@@ -633,6 +1059,8 @@ gis_network_page_class_init (GisNetworkPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-network-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisNetworkPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisNetworkPage, description);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisNetworkPage, network_list);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisNetworkPage, scrolled_window);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisNetworkPage, no_network_label);
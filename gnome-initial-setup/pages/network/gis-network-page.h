@@ -49,6 +49,7 @@ struct _GisNetworkPageClass
 GType gis_network_page_get_type (void);
 
 void gis_prepare_network_page (GisDriver *driver);
+void gis_network_page_start_auto_join (GisDriver *driver);
 
 G_END_DECLS
 
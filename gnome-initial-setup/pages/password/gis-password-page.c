@@ -40,6 +40,12 @@
 
 struct _GisPasswordPagePrivate
 {
+  GtkWidget *title;
+  GtkWidget *subtitle;
+  GtkWidget *password_label;
+  GtkWidget *confirm_label;
+  GtkWidget *reminder_label;
+  GtkWidget *reminder_explanation;
   GtkWidget *password_entry;
   GtkWidget *confirm_entry;
   GtkWidget *password_strength;
@@ -50,6 +56,8 @@ struct _GisPasswordPagePrivate
   gboolean valid_confirm;
   gboolean valid_password;
   guint timeout_id;
+  GCancellable *strength_cancellable;
+  gchar *keyring_password;
   const gchar *username;
 };
 typedef struct _GisPasswordPagePrivate GisPasswordPagePrivate;
@@ -84,6 +92,47 @@ page_validate (GisPasswordPage *page)
   return priv->valid_confirm && priv->valid_password && has_reminder;
 }
 
+static void
+keyring_password_updated (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+  GError *error = NULL;
+
+  if (!gis_update_login_keyring_password_finish (result, &error))
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to change keyring password: %s", error->message);
+      g_error_free (error);
+    }
+}
+
+/* Only once the password is saved, so that the keyring never ends up
+ * with one the user did not settle on. The change takes a few D-Bus
+ * round trips; the summary page waits for it before handing off. */
+static void
+update_keyring_password (GisPasswordPage *page)
+{
+  GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (page);
+  const gchar *password;
+
+  if (GIS_PAGE (page)->driver == NULL ||
+      gis_driver_get_account_mode (GIS_PAGE (page)->driver) == UM_ENTERPRISE)
+    return;
+
+  password = gtk_entry_get_text (GTK_ENTRY (priv->password_entry));
+  if (g_strcmp0 (password, priv->keyring_password) == 0)
+    return;
+
+  if (priv->keyring_password)
+    memset (priv->keyring_password, 0, strlen (priv->keyring_password));
+  g_free (priv->keyring_password);
+  priv->keyring_password = g_strdup (password);
+
+  gis_update_login_keyring_password_async (password, NULL,
+                                           keyring_password_updated, NULL);
+}
+
 static void
 update_page_validation (GisPasswordPage *page)
 {
@@ -124,7 +173,7 @@ gis_password_page_save_data (GisPage *gis_page)
 
   gis_driver_set_user_permissions (gis_page->driver, act_user, password);
 
-  gis_update_login_keyring_password (password);
+  update_keyring_password (page);
 }
 
 static void
@@ -136,31 +185,46 @@ gis_password_page_shown (GisPage *gis_page)
   gtk_widget_grab_focus (priv->password_entry);
 }
 
-static gboolean
-validate (GisPasswordPage *page)
+static void
+cancel_strength_check (GisPasswordPage *page)
 {
   GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (page);
+
+  if (priv->strength_cancellable) {
+    g_cancellable_cancel (priv->strength_cancellable);
+    g_clear_object (&priv->strength_cancellable);
+  }
+}
+
+static void
+strength_checked (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+  GisPasswordPage *page = user_data;
+  GisPasswordPagePrivate *priv;
   const gchar *password;
-  const gchar *verify;
   gint strength_level;
   const gchar *hint;
   const gchar *long_hint;
+  GError *error = NULL;
 
-  if (priv->timeout_id != 0) {
-    g_source_remove (priv->timeout_id);
-    priv->timeout_id = 0;
+  if (!pw_strength_finish (result, NULL, &hint, &long_hint, &strength_level, &error)) {
+    /* Superseded by newer input, or the page is gone */
+    g_error_free (error);
+    return;
   }
 
-  password = gtk_entry_get_text (GTK_ENTRY (priv->password_entry));
-  verify = gtk_entry_get_text (GTK_ENTRY (priv->confirm_entry));
+  priv = gis_password_page_get_instance_private (page);
+  g_clear_object (&priv->strength_cancellable);
 
-  pw_strength (password, NULL, priv->username, &hint, &long_hint, &strength_level);
+  password = gtk_entry_get_text (GTK_ENTRY (priv->password_entry));
 
   /*
    * If the password is not empty but it's strength is 0, show a
    * red bar instead of nothing.
    */
-  if (gtk_entry_get_text_length (GTK_ENTRY (priv->password_entry)) > 0)
+  if (strlen (password) > 0)
     strength_level = MIN (4, strength_level + 1);
 
   gtk_level_bar_set_value (GTK_LEVEL_BAR (priv->password_strength), strength_level);
@@ -171,13 +235,39 @@ validate (GisPasswordPage *page)
   else
     clear_entry_validation_error (GTK_ENTRY (priv->password_entry));
 
-  gtk_label_set_label (GTK_LABEL (priv->confirm_explanation), "");
-  priv->valid_confirm = FALSE;
-
   priv->valid_password = (strength_level > 0);
   if (priv->valid_password)
     set_entry_validation_checkmark (GTK_ENTRY (priv->password_entry));
 
+  update_page_validation (page);
+}
+
+static gboolean
+validate (GisPasswordPage *page)
+{
+  GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (page);
+  const gchar *password;
+  const gchar *verify;
+
+  if (priv->timeout_id != 0) {
+    g_source_remove (priv->timeout_id);
+    priv->timeout_id = 0;
+  }
+
+  password = gtk_entry_get_text (GTK_ENTRY (priv->password_entry));
+  verify = gtk_entry_get_text (GTK_ENTRY (priv->confirm_entry));
+
+  /* pwquality can take a noticeable while (cracklib dictionary
+   * lookups), so keep it off the main thread. */
+  cancel_strength_check (page);
+  priv->valid_password = FALSE;
+  priv->strength_cancellable = g_cancellable_new ();
+  pw_strength_async (password, NULL, priv->username,
+                     priv->strength_cancellable, strength_checked, page);
+
+  gtk_label_set_label (GTK_LABEL (priv->confirm_explanation), "");
+  priv->valid_confirm = FALSE;
+
   if (strlen (password) > 0 && strlen (verify) > 0) {
     priv->valid_confirm = password && *password != '\0' && strcmp (password, verify) == 0;
     if (!priv->valid_confirm) {
@@ -219,6 +309,7 @@ password_changed (GtkWidget      *w,
   clear_entry_validation_error (GTK_ENTRY (w));
   clear_entry_validation_error (GTK_ENTRY (priv->confirm_entry));
 
+  cancel_strength_check (page);
   priv->valid_password = FALSE;
   update_page_validation (page);
 
@@ -332,9 +423,24 @@ gis_password_page_constructed (GObject *object)
 static void
 gis_password_page_dispose (GObject *object)
 {
+  GisPasswordPage *page = GIS_PASSWORD_PAGE (object);
+  GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (page);
   GtkSettings *settings = gtk_settings_get_default ();
   g_object_set (G_OBJECT (settings), "gtk-entry-password-hint-timeout", 0, NULL);
 
+  if (priv->timeout_id != 0) {
+    g_source_remove (priv->timeout_id);
+    priv->timeout_id = 0;
+  }
+
+  cancel_strength_check (page);
+
+  if (priv->keyring_password)
+    {
+      memset (priv->keyring_password, 0, strlen (priv->keyring_password));
+      g_clear_pointer (&priv->keyring_password, g_free);
+    }
+
   if (GIS_PAGE (object)->driver)
   g_signal_handlers_disconnect_by_func (GIS_PAGE (object)->driver,
                                         username_changed, object);
@@ -345,7 +451,52 @@ gis_password_page_dispose (GObject *object)
 static void
 gis_password_page_locale_changed (GisPage *page)
 {
+  GisPasswordPage *password_page = GIS_PASSWORD_PAGE (page);
+  GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (password_page);
+
   gis_page_set_title (GIS_PAGE (page), _("Password"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Set a Password"));
+  gtk_label_set_label (GTK_LABEL (priv->subtitle), _("Be careful not to lose your password."));
+  gtk_label_set_label (GTK_LABEL (priv->password_label), _("_Password"));
+  gtk_label_set_label (GTK_LABEL (priv->confirm_label), _("_Verify"));
+  gtk_button_set_label (GTK_BUTTON (priv->password_toggle), _("Show password"));
+  gtk_label_set_label (GTK_LABEL (priv->reminder_label), _("Password _reminder"));
+  gtk_label_set_label (GTK_LABEL (priv->reminder_explanation), _("Password reminder will be shown in case you forget your password."));
+
+  /* Redo the strength hints and confirmation message in the new language */
+  if (*gtk_entry_get_text (GTK_ENTRY (priv->password_entry)) != '\0')
+    validate (password_page);
+}
+
+static gboolean
+gis_password_page_apply_answers (GisPage      *page,
+                                 GKeyFile     *answers,
+                                 const gchar  *group,
+                                 GError      **error)
+{
+  GisPasswordPage *password_page = GIS_PASSWORD_PAGE (page);
+  GisPasswordPagePrivate *priv = gis_password_page_get_instance_private (password_page);
+  gchar *password;
+  gchar *hint;
+
+  password = g_key_file_get_string (answers, group, "password", error);
+  if (password == NULL)
+    return FALSE;
+
+  hint = g_key_file_get_string (answers, group, "hint", NULL);
+
+  gtk_entry_set_text (GTK_ENTRY (priv->password_entry), password);
+  gtk_entry_set_text (GTK_ENTRY (priv->confirm_entry), password);
+  gtk_entry_set_text (GTK_ENTRY (priv->reminder_entry), hint != NULL ? hint : "");
+
+  /* Don't wait for the typing delay; the strength check completes the page */
+  validate (password_page);
+
+  g_free (password);
+  g_free (hint);
+
+  return TRUE;
 }
 
 static void
@@ -356,6 +507,12 @@ gis_password_page_class_init (GisPasswordPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-password-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, subtitle);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, password_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, confirm_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, reminder_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, reminder_explanation);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, password_entry);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, confirm_entry);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPasswordPage, password_strength);
@@ -368,6 +525,7 @@ gis_password_page_class_init (GisPasswordPageClass *klass)
   page_class->locale_changed = gis_password_page_locale_changed;
   page_class->save_data = gis_password_page_save_data;
   page_class->shown = gis_password_page_shown;
+  page_class->apply_answers = gis_password_page_apply_answers;
 
   object_class->constructed = gis_password_page_constructed;
   object_class->dispose = gis_password_page_dispose;
@@ -381,6 +539,38 @@ gis_password_page_init (GisPasswordPage *page)
   gtk_widget_init_template (GTK_WIDGET (page));
 }
 
+static void
+warm_up_done (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+  GError *error = NULL;
+
+  if (!pw_warm_up_finish (result, &error))
+    {
+      g_warning ("Could not preload password quality checks: %s", error->message);
+      g_error_free (error);
+      return;
+    }
+
+  g_debug ("Password quality checks preloaded in %" G_GINT64_FORMAT " ms",
+           pw_warm_up_get_duration () / 1000);
+}
+
+/* Parses the pwquality config and pages in the cracklib dictionary in
+ * a thread, so that the first check on the page does not have to. */
+void
+gis_password_page_warm_up (void)
+{
+  static gboolean started = FALSE;
+
+  if (started)
+    return;
+  started = TRUE;
+
+  pw_warm_up_async (NULL, warm_up_done, NULL);
+}
+
 void
 gis_prepare_password_page (GisDriver *driver)
 {
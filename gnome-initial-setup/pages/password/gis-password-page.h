@@ -51,6 +51,7 @@ struct _GisPasswordPageClass
 GType gis_password_page_get_type (void);
 
 void gis_prepare_password_page (GisDriver *driver);
+void gis_password_page_warm_up (void);
 
 G_END_DECLS
 
@@ -0,0 +1,263 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: nil; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2017 Endless Mobile, Inc.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Runs a fixed corpus through pw_strength(), with the pwquality
+ * settings in pw-bench.conf rather than the system ones. Checks that
+ * every result gets the hint and level that go with it, checks
+ * pw_min_length() and pw_generate(), and prints how long the checks
+ * took:
+ *
+ *   make -C gnome-initial-setup/pages/password check
+ *
+ * The result cache is cleared before every timed check, so the times
+ * are those of pwquality itself. Without the cracklib dictionary every
+ * password fails the dictionary check, so the bench is skipped then.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <pwquality.h>
+
+#include "pw-utils.h"
+
+/* Times every password in the corpus is checked */
+#define ITERATIONS 20
+
+/* Any level from 1 up, i.e. pwquality accepted the password */
+#define LEVEL_ACCEPTED -1
+
+/* minlen in pw-bench.conf */
+#define MIN_LENGTH 8
+
+/* What automake takes as a skipped test */
+#define EXIT_SKIP 77
+
+typedef struct {
+        const gchar *password;
+        const gchar *old_password;
+        const gchar *username;
+        gint level;
+        /* or NULL if it depends on the score */
+        const gchar *long_hint;
+} CorpusEntry;
+
+static const CorpusEntry corpus[] = {
+        { "", NULL, NULL, 0,
+          "Mix uppercase and lowercase and use a number or two." },
+        { "Ab1x", NULL, NULL, 0,
+          "This is a weak password. Try to add more letters, numbers and symbols." },
+        { "Qx7!benchuser", NULL, "benchuser", 0,
+          "This is a weak password. A password without your user name would be stronger." },
+        { "abcd1221dcba", NULL, NULL, 0,
+          "This is a weak password. Try to avoid reordering existing words." },
+        { "Z4RP%Ai%6*oEY&", "Z4RP%Ai%6*oEY&", NULL, 0,
+          "The new password needs to be different from the old one." },
+        { "Z4RP%Ai%6*oEY&", NULL, "benchuser", LEVEL_ACCEPTED, NULL },
+        { "FakIFsyrJD^#X)", NULL, "benchuser", LEVEL_ACCEPTED, NULL },
+
+        /* Dictionary words */
+        { "password", NULL, NULL, 0,
+          "This is a weak password. Try to avoid common words." },
+        { "computer", NULL, "benchuser", 0,
+          "This is a weak password. Try to avoid common words." },
+
+        /* Longer runs than maxsequence allows, either way */
+        { "Xk!abcdef9q", NULL, NULL, 0,
+          "This is a weak password. Try to avoid sequences like 1234 or abcd." },
+        { "q9!Zw1234567", NULL, NULL, 0,
+          "This is a weak password. Try to avoid sequences like 1234 or abcd." },
+        { "Hg#9876543k", NULL, NULL, 0,
+          "This is a weak password. Try to avoid sequences like 1234 or abcd." },
+
+        /* Long passphrases */
+        { "purple tuesday kettle ambushes oregano", NULL, "benchuser", LEVEL_ACCEPTED, NULL },
+        { "long walks with benchuser on sundays", NULL, "benchuser", 0,
+          "This is a weak password. A password without your user name would be stronger." },
+
+        /* Non-ASCII; pwquality counts the length in bytes */
+        { "Grüße aus Köln, 1997!", NULL, "benchuser", LEVEL_ACCEPTED, NULL },
+        { "Ωμέγα-Σίγμα-42", NULL, "benchuser", LEVEL_ACCEPTED, NULL },
+        { "äö", NULL, NULL, 0,
+          "This is a weak password. Try to add more letters, numbers and symbols." },
+};
+
+/* The strength hint for each level */
+static const gchar *level_hints[] = {
+        "Strength: Weak",
+        "Strength: Low",
+        "Strength: Medium",
+        "Strength: Good",
+        "Strength: High",
+};
+
+static void
+check_result (const CorpusEntry *entry,
+              gdouble            strength,
+              const gchar       *hint,
+              const gchar       *long_hint,
+              gint               level)
+{
+        g_assert_cmpint (level, >=, 0);
+        g_assert_cmpint (level, <, G_N_ELEMENTS (level_hints));
+        g_assert_cmpstr (hint, ==, level_hints[level]);
+
+        switch (level) {
+        case 0:
+                g_assert_cmpfloat (strength, ==, 0.0);
+                break;
+        case 1:
+                g_assert_cmpfloat (strength, <, 0.50);
+                break;
+        case 2:
+                g_assert_cmpfloat (strength, >=, 0.50);
+                g_assert_cmpfloat (strength, <, 0.75);
+                break;
+        case 3:
+                g_assert_cmpfloat (strength, >=, 0.75);
+                g_assert_cmpfloat (strength, <, 0.90);
+                break;
+        case 4:
+                g_assert_cmpfloat (strength, >=, 0.90);
+                break;
+        }
+
+        if (entry->level == LEVEL_ACCEPTED)
+                g_assert_cmpint (level, >, 0);
+        else
+                g_assert_cmpint (level, ==, entry->level);
+
+        if (entry->long_hint != NULL)
+                g_assert_cmpstr (long_hint, ==, entry->long_hint);
+        else
+                g_assert_nonnull (long_hint);
+}
+
+static gint
+compare_latencies (gconstpointer a,
+                   gconstpointer b)
+{
+        gint64 la = *(const gint64 *) a;
+        gint64 lb = *(const gint64 *) b;
+
+        return (la > lb) - (la < lb);
+}
+
+static gint64
+get_percentile (const gint64 *sorted,
+                guint         n,
+                gdouble       percentile)
+{
+        return sorted[(guint) (percentile / 100.0 * (n - 1) + 0.5)];
+}
+
+/* cracklib fails every check with this when it has no dictionary */
+static gboolean
+have_dictionary (void)
+{
+        pwquality_settings_t *settings;
+        gpointer auxerror = NULL;
+        gboolean ret;
+        gint rv;
+
+        settings = pwquality_default_settings ();
+        pwquality_read_config (settings, PW_CONFIG_FILE, NULL);
+        rv = pwquality_check (settings, "Z4RP%Ai%6*oEY&", NULL, NULL, &auxerror);
+        ret = rv != PWQ_ERROR_CRACKLIB_CHECK ||
+              g_strcmp0 (auxerror, "error loading dictionary") != 0;
+        pwquality_free_settings (settings);
+
+        return ret;
+}
+
+static void
+check_generate (void)
+{
+        gchar *first, *second;
+
+        first = pw_generate ();
+        second = pw_generate ();
+
+        g_assert_cmpuint (strlen (first), >=, MIN_LENGTH);
+        g_assert_cmpuint (strlen (second), >=, MIN_LENGTH);
+        g_assert_cmpstr (first, !=, second);
+
+        g_free (first);
+        g_free (second);
+}
+
+int
+main (int argc, char *argv[])
+{
+        const CorpusEntry *entry;
+        const gchar *hint;
+        const gchar *long_hint;
+        gdouble strength;
+        gint level;
+        gint64 latencies[ITERATIONS * G_N_ELEMENTS (corpus)];
+        gint64 start, first;
+        guint n = 0;
+        guint i, j;
+
+        /* The first check reads the settings and maps in the cracklib
+         * dictionary, so it is reported on its own. */
+        start = g_get_monotonic_time ();
+        pw_strength ("pw-bench", NULL, NULL, &hint, &long_hint, &level);
+        first = g_get_monotonic_time () - start;
+
+        if (!have_dictionary ()) {
+                g_print ("cracklib dictionary not found, skipping\n");
+                return EXIT_SKIP;
+        }
+
+        g_assert_cmpint (pw_min_length (), ==, MIN_LENGTH);
+        check_generate ();
+
+        for (i = 0; i < ITERATIONS; i++) {
+                for (j = 0; j < G_N_ELEMENTS (corpus); j++) {
+                        entry = &corpus[j];
+
+                        pw_clear_cache ();
+
+                        start = g_get_monotonic_time ();
+                        strength = pw_strength (entry->password,
+                                                entry->old_password,
+                                                entry->username,
+                                                &hint, &long_hint, &level);
+                        latencies[n++] = g_get_monotonic_time () - start;
+
+                        check_result (entry, strength, hint, long_hint, level);
+                }
+        }
+
+        qsort (latencies, n, sizeof (gint64), compare_latencies);
+
+        g_print ("first check: %" G_GINT64_FORMAT " us\n", first);
+        g_print ("%u checks: p50 %" G_GINT64_FORMAT " us, p90 %" G_GINT64_FORMAT
+                 " us, p99 %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us\n",
+                 n,
+                 get_percentile (latencies, n, 50),
+                 get_percentile (latencies, n, 90),
+                 get_percentile (latencies, n, 99),
+                 latencies[n - 1]);
+
+        return EXIT_SUCCESS;
+}
@@ -22,28 +22,219 @@
 
 #include "pw-utils.h"
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib/gi18n.h>
 
 #include <pwquality.h>
 
+/* Number of recent pwquality_check() results to remember */
+#define PW_CACHE_SIZE 16
+
+/* Builds can pin the settings; see pw-bench.c */
+#ifndef PW_CONFIG_FILE
+#define PW_CONFIG_FILE NULL
+#endif
 
 static pwquality_settings_t *
 get_pwq (void)
 {
         static pwquality_settings_t *settings;
 
-        if (settings == NULL) {
+        /* Checks may run in worker threads */
+        if (g_once_init_enter (&settings)) {
+                pwquality_settings_t *s;
                 gchar *err = NULL;
-                settings = pwquality_default_settings ();
-                if (pwquality_read_config (settings, NULL, (gpointer)&err) < 0) {
+                s = pwquality_default_settings ();
+                if (pwquality_read_config (s, PW_CONFIG_FILE, (gpointer)&err) < 0) {
                         g_error ("failed to read pwquality configuration: %s\n", err);
                 }
+                g_once_init_leave (&settings, s);
         }
 
         return settings;
 }
 
+/* cracklib keeps static state and is not thread-safe, so only one
+ * pwquality_check() runs at a time, whichever thread it is on. */
+G_LOCK_DEFINE_STATIC (pwquality_check);
+
+static gint
+run_check (const gchar *password,
+           const gchar *old_password,
+           const gchar *username)
+{
+        gint rv;
+
+        G_LOCK (pwquality_check);
+        rv = pwquality_check (get_pwq (), password, old_password, username, NULL);
+        G_UNLOCK (pwquality_check);
+
+        return rv;
+}
+
+/* Results are keyed by a hash of the password rather than the password
+ * itself, so no plaintext lingers in the cache. */
+static GHashTable *pw_cache;
+static GQueue pw_cache_order = G_QUEUE_INIT;
+G_LOCK_DEFINE_STATIC (pw_cache);
+
+static gchar *
+pw_cache_key (const gchar *password,
+              const gchar *old_password,
+              const gchar *username)
+{
+        GChecksum *checksum;
+        gchar *key;
+
+        checksum = g_checksum_new (G_CHECKSUM_SHA256);
+        g_checksum_update (checksum, (const guchar *) password, -1);
+        g_checksum_update (checksum, (const guchar *) "", 1);
+        if (old_password)
+                g_checksum_update (checksum, (const guchar *) old_password, -1);
+        g_checksum_update (checksum, (const guchar *) "", 1);
+        if (username)
+                g_checksum_update (checksum, (const guchar *) username, -1);
+        key = g_strdup (g_checksum_get_string (checksum));
+        g_checksum_free (checksum);
+
+        return key;
+}
+
+static gboolean
+pw_cache_lookup (const gchar *key,
+                 gint        *rv)
+{
+        gpointer value;
+        gboolean found = FALSE;
+
+        G_LOCK (pw_cache);
+        if (pw_cache != NULL &&
+            g_hash_table_lookup_extended (pw_cache, key, NULL, &value)) {
+                *rv = GPOINTER_TO_INT (value);
+                found = TRUE;
+        }
+        G_UNLOCK (pw_cache);
+
+        return found;
+}
+
+static void
+pw_cache_insert (const gchar *key,
+                 gint         rv)
+{
+        gchar *k;
+
+        G_LOCK (pw_cache);
+        if (pw_cache == NULL)
+                pw_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+        if (!g_hash_table_contains (pw_cache, key)) {
+                k = g_strdup (key);
+                g_hash_table_insert (pw_cache, k, GINT_TO_POINTER (rv));
+                g_queue_push_tail (&pw_cache_order, k);
+
+                if (g_queue_get_length (&pw_cache_order) > PW_CACHE_SIZE)
+                        g_hash_table_remove (pw_cache, g_queue_pop_head (&pw_cache_order));
+        }
+        G_UNLOCK (pw_cache);
+}
+
+/* Forgets every result, so that the next checks reach pwquality again;
+ * pw-bench uses it to time pwquality rather than the cache. */
+void
+pw_clear_cache (void)
+{
+        G_LOCK (pw_cache);
+        g_queue_clear (&pw_cache_order);
+        g_clear_pointer (&pw_cache, g_hash_table_unref);
+        G_UNLOCK (pw_cache);
+}
+
+static gint
+pw_check (const gchar *password,
+          const gchar *old_password,
+          const gchar *username)
+{
+        gchar *key;
+        gint rv;
+
+        key = pw_cache_key (password, old_password, username);
+
+        if (!pw_cache_lookup (key, &rv)) {
+                rv = run_check (password, old_password, username);
+                pw_cache_insert (key, rv);
+        }
+
+        g_free (key);
+
+        return rv;
+}
+
+/* Duration of the last warm-up in microseconds, or 0 if none finished */
+static gint64 pw_warm_up_duration;
+G_LOCK_DEFINE_STATIC (pw_warm_up);
+
+static void
+warm_up_thread_func (GTask        *task,
+                     gpointer      source_object,
+                     gpointer      task_data,
+                     GCancellable *cancellable)
+{
+        gint64 start;
+
+        start = g_get_monotonic_time ();
+
+        /* Parses pwquality.conf */
+        get_pwq ();
+
+        /* cracklib only maps its dictionary in on the first check. The
+         * throwaway password is deliberately not cached. */
+        run_check ("gnome-initial-setup", NULL, NULL);
+
+        G_LOCK (pw_warm_up);
+        pw_warm_up_duration = g_get_monotonic_time () - start;
+        G_UNLOCK (pw_warm_up);
+
+        g_task_return_boolean (task, TRUE);
+}
+
+void
+pw_warm_up_async (GCancellable        *cancellable,
+                  GAsyncReadyCallback  callback,
+                  gpointer             user_data)
+{
+        GTask *task;
+
+        task = g_task_new (NULL, cancellable, callback, user_data);
+        g_task_set_source_tag (task, pw_warm_up_async);
+        g_task_run_in_thread (task, warm_up_thread_func);
+        g_object_unref (task);
+}
+
+gboolean
+pw_warm_up_finish (GAsyncResult  *result,
+                   GError       **error)
+{
+        g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+        return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+/* Returns how long the last warm-up took, in microseconds */
+gint64
+pw_warm_up_get_duration (void)
+{
+        gint64 duration;
+
+        G_LOCK (pw_warm_up);
+        duration = pw_warm_up_duration;
+        G_UNLOCK (pw_warm_up);
+
+        return duration;
+}
+
 gint
 pw_min_length (void)
 {
@@ -120,21 +311,14 @@ pw_error_hint (gint error)
         }
 }
 
-gdouble
-pw_strength (const gchar  *password,
-             const gchar  *old_password,
-             const gchar  *username,
-             const gchar **hint,
-             const gchar **long_hint,
-             gint         *strength_level)
+static gdouble
+pw_strength_from_result (gint          rv,
+                         const gchar **hint,
+                         const gchar **long_hint,
+                         gint         *strength_level)
 {
-        gint rv, level = 0;
+        gint level = 0;
         gdouble strength = 0.0;
-        void *auxerror;
-
-        rv = pwquality_check (get_pwq (),
-                              password, old_password, username,
-                              &auxerror);
 
         strength = CLAMP (0.01 * rv, 0.0, 1.0);
         if (rv < 0) {
@@ -161,3 +345,126 @@ pw_strength (const gchar  *password,
 
         return strength;
 }
+
+gdouble
+pw_strength (const gchar  *password,
+             const gchar  *old_password,
+             const gchar  *username,
+             const gchar **hint,
+             const gchar **long_hint,
+             gint         *strength_level)
+{
+        gint rv;
+
+        rv = pw_check (password, old_password, username);
+
+        return pw_strength_from_result (rv, hint, long_hint, strength_level);
+}
+
+typedef struct {
+        gchar *password;
+        gchar *old_password;
+        gchar *username;
+        gchar *key;
+        gint   rv;
+} StrengthCheck;
+
+static void
+strength_check_free (StrengthCheck *check)
+{
+        if (check->password) {
+                memset (check->password, 0, strlen (check->password));
+                g_free (check->password);
+        }
+        if (check->old_password) {
+                memset (check->old_password, 0, strlen (check->old_password));
+                g_free (check->old_password);
+        }
+        g_free (check->username);
+        g_free (check->key);
+        g_slice_free (StrengthCheck, check);
+}
+
+static void
+strength_check_thread_func (GTask        *task,
+                            gpointer      source_object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
+{
+        StrengthCheck *check = task_data;
+
+        /* Superseded while waiting for a thread; the result would be
+         * dropped anyway. */
+        if (g_task_return_error_if_cancelled (task))
+                return;
+
+        check->rv = run_check (check->password, check->old_password,
+                               check->username);
+        pw_cache_insert (check->key, check->rv);
+
+        g_task_return_boolean (task, TRUE);
+}
+
+void
+pw_strength_async (const gchar         *password,
+                   const gchar         *old_password,
+                   const gchar         *username,
+                   GCancellable        *cancellable,
+                   GAsyncReadyCallback  callback,
+                   gpointer             user_data)
+{
+        GTask *task;
+        StrengthCheck *check;
+
+        task = g_task_new (NULL, cancellable, callback, user_data);
+        g_task_set_source_tag (task, pw_strength_async);
+
+        /* A stale result is of no use to anybody */
+        g_task_set_check_cancellable (task, TRUE);
+
+        check = g_slice_new0 (StrengthCheck);
+        check->key = pw_cache_key (password, old_password, username);
+        g_task_set_task_data (task, check, (GDestroyNotify) strength_check_free);
+
+        /* Toggling visibility or retyping the same thing is answered
+         * without going back to pwquality */
+        if (pw_cache_lookup (check->key, &check->rv)) {
+                g_task_return_boolean (task, TRUE);
+                g_object_unref (task);
+                return;
+        }
+
+        check->password = g_strdup (password);
+        check->old_password = g_strdup (old_password);
+        check->username = g_strdup (username);
+
+        g_task_set_return_on_cancel (task, TRUE);
+
+        g_task_run_in_thread (task, strength_check_thread_func);
+
+        g_object_unref (task);
+}
+
+gboolean
+pw_strength_finish (GAsyncResult  *result,
+                    gdouble       *strength,
+                    const gchar  **hint,
+                    const gchar  **long_hint,
+                    gint          *strength_level,
+                    GError       **error)
+{
+        StrengthCheck *check;
+        gdouble value;
+
+        g_return_val_if_fail (g_task_is_valid (result, NULL), FALSE);
+
+        if (!g_task_propagate_boolean (G_TASK (result), error))
+                return FALSE;
+
+        check = g_task_get_task_data (G_TASK (result));
+        value = pw_strength_from_result (check->rv, hint, long_hint, strength_level);
+        if (strength)
+                *strength = value;
+
+        return TRUE;
+}
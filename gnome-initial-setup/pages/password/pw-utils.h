@@ -19,12 +19,33 @@
  */
 
 #include <glib.h>
+#include <gio/gio.h>
 
-gint     pw_min_length (void);
-gchar   *pw_generate   (void);
+void     pw_warm_up_async        (GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data);
+gboolean pw_warm_up_finish       (GAsyncResult        *result,
+                                  GError             **error);
+gint64   pw_warm_up_get_duration (void);
+
+gint     pw_min_length  (void);
+gchar   *pw_generate    (void);
+void     pw_clear_cache (void);
 gdouble  pw_strength   (const gchar  *password,
                         const gchar  *old_password,
                         const gchar  *username,
                         const gchar **hint,
                         const gchar **long_hints,
                         gint         *strength_level);
+void     pw_strength_async  (const gchar         *password,
+                             const gchar         *old_password,
+                             const gchar         *username,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data);
+gboolean pw_strength_finish (GAsyncResult  *result,
+                             gdouble       *strength,
+                             const gchar  **hint,
+                             const gchar  **long_hint,
+                             gint          *strength_level,
+                             GError       **error);
@@ -34,12 +34,17 @@
 
 struct _GisPrivacyPagePrivate
 {
+  GtkWidget *title;
+  GtkWidget *location_title;
+  GtkWidget *location_label;
   GtkWidget *location_switch;
   GtkWidget *reporting_row;
+  GtkWidget *reporting_title;
   GtkWidget *reporting_switch;
   GtkWidget *reporting_label;
   GtkWidget *mozilla_privacy_policy_label;
   GtkWidget *distro_privacy_policy_label;
+  GtkWidget *footer_label;
   GSettings *location_settings;
   GSettings *privacy_settings;
   guint abrt_watch_id;
@@ -158,7 +163,6 @@ gis_privacy_page_constructed (GObject *object)
 {
   GisPrivacyPage *page = GIS_PRIVACY_PAGE (object);
   GisPrivacyPagePrivate *priv = gis_privacy_page_get_instance_private (page);
-  char *text;
 
   G_OBJECT_CLASS (gis_privacy_page_parent_class)->constructed (object);
 
@@ -170,12 +174,6 @@ gis_privacy_page_constructed (GObject *object)
   gtk_switch_set_active (GTK_SWITCH (priv->location_switch), TRUE);
   gtk_switch_set_active (GTK_SWITCH (priv->reporting_switch), TRUE);
 
-  update_os_data (page);
-
-  text = g_strdup_printf ("<a href='%s'>%s</a>", "https://location.services.mozilla.com/privacy", _("Privacy Policy"));
-  gtk_label_set_markup (GTK_LABEL (priv->mozilla_privacy_policy_label), text);
-  g_free (text);
-
   priv->abrt_watch_id = g_bus_watch_name (G_BUS_TYPE_SYSTEM,
                                           "org.freedesktop.problems.daemon",
                                           G_BUS_NAME_WATCHER_FLAGS_NONE,
@@ -283,7 +281,58 @@ activate_link (GtkLabel       *label,
 static void
 gis_privacy_page_locale_changed (GisPage *page)
 {
+  GisPrivacyPagePrivate *priv = gis_privacy_page_get_instance_private (GIS_PRIVACY_PAGE (page));
+  char *text;
+
   gis_page_set_title (GIS_PAGE (page), _("Privacy"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Privacy"));
+  gtk_label_set_label (GTK_LABEL (priv->location_title), _("Location Services"));
+  gtk_label_set_label (GTK_LABEL (priv->location_label), _("Allows applications to determine your geographical location. An indication is shown when location services are in use."));
+  gtk_label_set_label (GTK_LABEL (priv->reporting_title), _("Automatic Problem Reporting"));
+  gtk_label_set_label (GTK_LABEL (priv->footer_label), _("Privacy controls can be changed at any time from the Settings application."));
+
+  update_os_data (GIS_PRIVACY_PAGE (page));
+
+  text = g_strdup_printf ("<a href='%s'>%s</a>", "https://location.services.mozilla.com/privacy", _("Privacy Policy"));
+  gtk_label_set_markup (GTK_LABEL (priv->mozilla_privacy_policy_label), text);
+  g_free (text);
+}
+
+static gboolean
+set_switch_from_answers (GtkWidget    *widget,
+                         GKeyFile     *answers,
+                         const gchar  *group,
+                         const gchar  *key,
+                         GError      **error)
+{
+  GError *local_error = NULL;
+  gboolean active;
+
+  if (!g_key_file_has_key (answers, group, key, NULL))
+    return TRUE;
+
+  active = g_key_file_get_boolean (answers, group, key, &local_error);
+  if (local_error != NULL)
+    {
+      g_propagate_error (error, local_error);
+      return FALSE;
+    }
+
+  gtk_switch_set_active (GTK_SWITCH (widget), active);
+  return TRUE;
+}
+
+static gboolean
+gis_privacy_page_apply_answers (GisPage      *page,
+                                GKeyFile     *answers,
+                                const gchar  *group,
+                                GError      **error)
+{
+  GisPrivacyPagePrivate *priv = gis_privacy_page_get_instance_private (GIS_PRIVACY_PAGE (page));
+
+  return set_switch_from_answers (priv->location_switch, answers, group, "location", error) &&
+         set_switch_from_answers (priv->reporting_switch, answers, group, "reporting", error);
 }
 
 static void
@@ -293,17 +342,23 @@ gis_privacy_page_class_init (GisPrivacyPageClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-privacy-page.ui");
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, location_title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, location_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, location_switch);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, reporting_row);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, reporting_title);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, reporting_switch);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, reporting_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, mozilla_privacy_policy_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, distro_privacy_policy_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisPrivacyPage, footer_label);
   gtk_widget_class_bind_template_callback (GTK_WIDGET_CLASS (klass), activate_link);
 
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_privacy_page_locale_changed;
   page_class->apply = gis_privacy_page_apply;
+  page_class->apply_answers = gis_privacy_page_apply_answers;
   object_class->constructed = gis_privacy_page_constructed;
   object_class->dispose = gis_privacy_page_dispose;
 }
@@ -318,6 +318,26 @@ add_all_regions (CcRegionChooser *chooser)
         g_strfreev (locale_ids);
 }
 
+/* Adds the regions for the languages of users that have been loaded
+ * since the rows were built */
+static void
+users_changed (CcRegionChooser *chooser)
+{
+        CcRegionChooserPrivate *priv = cc_region_chooser_get_instance_private (chooser);
+        GHashTable *initial;
+        GHashTableIter iter;
+        gchar *key;
+
+        initial = cc_common_language_get_initial_languages ();
+        g_hash_table_iter_init (&iter, initial);
+        while (g_hash_table_iter_next (&iter, (gpointer *)&key, NULL))
+                add_one_region (chooser, key);
+        g_hash_table_destroy (initial);
+
+        gtk_widget_show_all (priv->region_list);
+        sync_all_checkmarks (chooser);
+}
+
 static gboolean
 region_visible (GtkListBoxRow *row,
                   gpointer       user_data)
@@ -560,6 +580,7 @@ cc_region_chooser_constructed (GObject *object)
 	}
 
 	add_all_regions (chooser);
+        cc_common_language_watch_users (G_CALLBACK (users_changed), chooser);
 
 	gtk_container_add (GTK_CONTAINER (priv->region_list), priv->more_item);
 
@@ -32,20 +32,17 @@
 #include "gis-region-page.h"
 
 #include <act/act-user-manager.h>
-#include <polkit/polkit.h>
 #include <locale.h>
 #include <gtk/gtk.h>
 
 struct _GisRegionPagePrivate
 {
+  GtkWidget *title;
+  GtkWidget *description;
   GtkWidget *region_chooser;
 
-  GDBusProxy *localed;
-  GPermission *permission;
   const gchar *new_locale_id;
   gboolean updating;
-
-  GCancellable *cancellable;
 };
 typedef struct _GisRegionPagePrivate GisRegionPagePrivate;
 
@@ -63,11 +60,14 @@ set_localed_locale (GisRegionPage *self)
   g_variant_builder_add (b, "s", s);
   g_free (s);
 
-  g_dbus_proxy_call (priv->localed,
-                     "SetLocale",
-                     g_variant_new ("(asb)", b, TRUE),
-                     G_DBUS_CALL_FLAGS_NONE,
-                     -1, NULL, NULL, NULL);
+  /* Only the last locale chosen is sent to localed */
+  gis_settings_transaction_set_call (gis_driver_get_settings_transaction (GIS_PAGE (self)->driver),
+                                     "locale",
+                                     "org.freedesktop.locale1",
+                                     "/org/freedesktop/locale1",
+                                     "org.freedesktop.locale1",
+                                     "SetLocale",
+                                     g_variant_new ("(asb)", b, TRUE));
   g_variant_builder_unref (b);
 }
 
@@ -77,20 +77,51 @@ change_locale_permission_acquired (GObject      *source,
                                    gpointer      data)
 {
   GisRegionPage *page = GIS_REGION_PAGE (data);
-  GisRegionPagePrivate *priv = gis_region_page_get_instance_private (page);
   GError *error = NULL;
   gboolean allowed;
 
-  allowed = g_permission_acquire_finish (priv->permission, res, &error);
+  allowed = g_permission_acquire_finish (G_PERMISSION (source), res, &error);
   if (error) {
       if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         g_warning ("Failed to acquire permission: %s\n", error->message);
       g_error_free (error);
+      g_object_unref (page);
       return;
   }
 
   if (allowed)
     set_localed_locale (page);
+  g_object_unref (page);
+}
+
+static void
+change_locale_permission_ready (GObject      *source,
+                                GAsyncResult *res,
+                                gpointer      data)
+{
+  GisRegionPage *page = GIS_REGION_PAGE (data);
+  GPermission *permission;
+  GError *error = NULL;
+
+  permission = gis_permission_cache_get_finish (GIS_PERMISSION_CACHE (source), res, &error);
+  if (permission == NULL) {
+      g_error_free (error);
+      g_object_unref (page);
+      return;
+  }
+
+  if (g_permission_get_allowed (permission)) {
+      set_localed_locale (page);
+  }
+  else if (g_permission_get_can_acquire (permission)) {
+      g_permission_acquire_async (permission,
+                                  NULL,
+                                  change_locale_permission_acquired,
+                                  g_object_ref (page));
+  }
+
+  g_object_unref (permission);
+  g_object_unref (page);
 }
 
 static void
@@ -123,17 +154,12 @@ region_changed (CcRegionChooser  *chooser,
   setlocale (LC_MESSAGES, priv->new_locale_id);
   gis_driver_locale_changed (driver);
 
-  if (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER) {
-      if (g_permission_get_allowed (priv->permission)) {
-          set_localed_locale (page);
-      }
-      else if (g_permission_get_can_acquire (priv->permission)) {
-          g_permission_acquire_async (priv->permission,
-                                      NULL,
-                                      change_locale_permission_acquired,
-                                      page);
-      }
-  }
+  if (gis_driver_get_mode (driver) == GIS_DRIVER_MODE_NEW_USER)
+    gis_permission_cache_get_async (gis_driver_get_permission_cache (driver),
+                                    "org.freedesktop.locale1.set-locale",
+                                    NULL,
+                                    change_locale_permission_ready,
+                                    g_object_ref (page));
   user = act_user_manager_get_user (act_user_manager_get_default (),
                                     g_get_user_name ());
   if (act_user_is_loaded (user))
@@ -147,28 +173,6 @@ region_changed (CcRegionChooser  *chooser,
   gis_driver_set_user_language (driver, priv->new_locale_id);
 }
 
-static void
-localed_proxy_ready (GObject      *source,
-                     GAsyncResult *res,
-                     gpointer      data)
-{
-  GisRegionPage *self = data;
-  GisRegionPagePrivate *priv = gis_region_page_get_instance_private (self);
-  GDBusProxy *proxy;
-  GError *error = NULL;
-
-  proxy = g_dbus_proxy_new_finish (res, &error);
-
-  if (!proxy) {
-      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        g_warning ("Failed to contact localed: %s\n", error->message);
-      g_error_free (error);
-      return;
-  }
-
-  priv->localed = proxy;
-}
-
 static void
 region_confirmed (CcRegionChooser *chooser,
                   GisRegionPage   *page)
@@ -181,7 +185,6 @@ gis_region_page_constructed (GObject *object)
 {
   GisRegionPage *page = GIS_REGION_PAGE (object);
   GisRegionPagePrivate *priv = gis_region_page_get_instance_private (page);
-  GDBusConnection *bus;
 
   g_type_ensure (CC_TYPE_REGION_CHOOSER);
 
@@ -192,24 +195,6 @@ gis_region_page_constructed (GObject *object)
   g_signal_connect (priv->region_chooser, "confirm",
                     G_CALLBACK (region_confirmed), page);
 
-  /* If we're in new user mode then we're manipulating system settings */
-  if (gis_driver_get_mode (GIS_PAGE (page)->driver) == GIS_DRIVER_MODE_NEW_USER)
-    {
-      priv->permission = polkit_permission_new_sync ("org.freedesktop.locale1.set-locale", NULL, NULL, NULL);
-
-      bus = g_bus_get_sync (G_BUS_TYPE_SYSTEM, NULL, NULL);
-      g_dbus_proxy_new (bus,
-                        G_DBUS_PROXY_FLAGS_GET_INVALIDATED_PROPERTIES,
-                        NULL,
-                        "org.freedesktop.locale1",
-                        "/org/freedesktop/locale1",
-                        "org.freedesktop.locale1",
-                        priv->cancellable,
-                        (GAsyncReadyCallback) localed_proxy_ready,
-                        object);
-      g_object_unref (bus);
-  }
-
   gis_page_set_complete (GIS_PAGE (page), TRUE);
   if (cc_region_chooser_get_n_regions (CC_REGION_CHOOSER (priv->region_chooser)) > 1)
     gtk_widget_show (GTK_WIDGET (page));
@@ -225,6 +210,9 @@ gis_region_page_locale_changed (GisPage *page)
 
   gis_page_set_title (page, _("Region"));
 
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Region"));
+  gtk_label_set_label (GTK_LABEL (priv->description), _("Choose your country or region."));
+
   locale = g_strdup (setlocale (LC_MESSAGES, NULL));
 
   priv->updating = TRUE;
@@ -238,19 +226,6 @@ gis_region_page_locale_changed (GisPage *page)
     gtk_widget_hide (GTK_WIDGET (page));
 }
 
-static void
-gis_region_page_dispose (GObject *object)
-{
-  GisRegionPage *page = GIS_REGION_PAGE (object);
-  GisRegionPagePrivate *priv = gis_region_page_get_instance_private (page);
-
-  g_clear_object (&priv->permission);
-  g_clear_object (&priv->localed);
-  g_clear_object (&priv->cancellable);
-
-  G_OBJECT_CLASS (gis_region_page_parent_class)->dispose (object);
-}
-
 static void
 gis_region_page_class_init (GisRegionPageClass *klass)
 {
@@ -259,12 +234,13 @@ gis_region_page_class_init (GisRegionPageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-region-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisRegionPage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisRegionPage, description);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisRegionPage, region_chooser);
 
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_region_page_locale_changed;
   object_class->constructed = gis_region_page_constructed;
-  object_class->dispose = gis_region_page_dispose;
 }
 
 static void
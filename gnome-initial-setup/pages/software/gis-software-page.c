@@ -38,12 +38,18 @@
 
 struct _GisSoftwarePagePrivate
 {
+  GtkWidget *title;
+  GtkWidget *more_label;
   GtkWidget *more_popover;
+  GtkWidget *proprietary_title;
+  GtkWidget *proprietary_label;
+  GtkWidget *free_software_label;
   GtkWidget *proprietary_switch;
   GtkWidget *text_label;
 
   GSettings *software_settings;
   guint enable_count;
+  gboolean enable_failed;
 #ifdef ENABLE_SOFTWARE_SOURCES
   PkTask *task;
 #endif
@@ -174,14 +180,18 @@ repo_enabled_cb (GObject      *source,
 #if PK_CHECK_VERSION(1,1,4)
       if (!g_error_matches (error, PK_CLIENT_ERROR, 0xff + PK_ERROR_ENUM_REPO_ALREADY_SET))
 #endif
-        g_critical ("Failed to enable repository: %s", error->message);
+        {
+          g_critical ("Failed to enable repository: %s", error->message);
+          priv->enable_failed = TRUE;
+        }
     }
 
   priv->enable_count--;
   if (priv->enable_count == 0)
     {
-      /* all done */
-      gis_page_apply_complete (GIS_PAGE (page), TRUE);
+      /* all done; this runs in the background, so a failure sends
+       * the user back here from the assistant */
+      gis_page_apply_complete (GIS_PAGE (page), !priv->enable_failed);
     }
 #endif
 }
@@ -196,6 +206,8 @@ enable_repos (GisSoftwarePage *page,
   GisSoftwarePagePrivate *priv = gis_software_page_get_instance_private (page);
   guint i;
 
+  priv->enable_failed = FALSE;
+
   /* enable each repo */
   for (i = 0; repo_ids[i] != NULL; i++)
     {
@@ -242,8 +254,16 @@ gis_software_page_apply (GisPage *gis_page,
 static void
 gis_software_page_locale_changed (GisPage *page)
 {
+  GisSoftwarePagePrivate *priv = gis_software_page_get_instance_private (GIS_SOFTWARE_PAGE (page));
+
   gis_page_set_title (page, _("Software Sources"));
   update_distro_name (GIS_SOFTWARE_PAGE (page));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Additional Software Sources"));
+  gtk_label_set_label (GTK_LABEL (priv->more_label), _("<a href=\"more\">Find out more…</a>"));
+  gtk_label_set_label (GTK_LABEL (priv->proprietary_title), _("Proprietary Software Sources"));
+  gtk_label_set_label (GTK_LABEL (priv->proprietary_label), _("Proprietary software typically has restrictions on how it can be used and on access to source code. This prevents anyone but the software owner from inspecting, improving or learning from its code."));
+  gtk_label_set_label (GTK_LABEL (priv->free_software_label), _("In contrast, Free Software can be freely run, copied, distributed, studied and modified."));
 }
 
 static gboolean
@@ -276,13 +296,20 @@ gis_software_page_class_init (GisSoftwarePageClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-software-page.ui");
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, more_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, more_popover);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, proprietary_title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, proprietary_label);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, free_software_label);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, proprietary_switch);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisSoftwarePage, text_label);
   gtk_widget_class_bind_template_callback (GTK_WIDGET_CLASS (klass), activate_link);
   gtk_widget_class_bind_template_callback (GTK_WIDGET_CLASS (klass), state_set);
 
   page_class->page_id = PAGE_ID;
+  /* PackageKit can take a long time, and no other page cares */
+  page_class->apply_in_background = TRUE;
   page_class->locale_changed = gis_software_page_locale_changed;
   page_class->apply = gis_software_page_apply;
   object_class->constructed = gis_software_page_constructed;
@@ -39,6 +39,9 @@
 
 #define SERVICE_NAME "gdm-password"
 
+/* How long to wait for a pending keyring password change, in ms */
+#define KEYRING_UPDATE_TIMEOUT 10000
+
 struct _GisSummaryPagePrivate {
   GtkWidget *start_button;
   GtkWidget *start_button_label;
@@ -48,6 +51,9 @@ struct _GisSummaryPagePrivate {
 
   ActUser *user_account;
   const gchar *user_password;
+
+  /* Things to wait for before the session can start */
+  guint pending_operations;
 };
 typedef struct _GisSummaryPagePrivate GisSummaryPagePrivate;
 
@@ -232,6 +238,59 @@ done_cb (GtkButton *button, GisSummaryPage *page)
     }
 }
 
+static void
+operation_done (GisSummaryPage *page)
+{
+  GisSummaryPagePrivate *priv = gis_summary_page_get_instance_private (page);
+
+  g_assert (priv->pending_operations > 0);
+
+  if (--priv->pending_operations == 0)
+    {
+      gtk_widget_set_sensitive (priv->start_button, TRUE);
+      gtk_widget_grab_focus (priv->start_button);
+    }
+
+  g_object_unref (page);
+}
+
+static void
+keyring_password_changed (GObject      *source,
+                          GAsyncResult *res,
+                          gpointer      user_data)
+{
+  GisSummaryPage *page = user_data;
+  GError *error = NULL;
+
+  /* Don't hold the user back forever on it either */
+  if (!gis_wait_for_login_keyring_password_finish (res, &error))
+    {
+      g_warning ("%s", error->message);
+      g_error_free (error);
+    }
+
+  operation_done (page);
+}
+
+static void
+settings_committed (GObject      *source,
+                    GAsyncResult *res,
+                    gpointer      user_data)
+{
+  GisSummaryPage *page = user_data;
+  GError *error = NULL;
+
+  /* The individual results stay in the transaction; a setting that
+   * didn't stick is no reason to keep the user out of their session. */
+  if (!gis_settings_transaction_commit_finish (GIS_SETTINGS_TRANSACTION (source), res, &error))
+    {
+      g_warning ("Could not apply system settings: %s", error->message);
+      g_error_free (error);
+    }
+
+  operation_done (page);
+}
+
 static void
 gis_summary_page_shown (GisPage *page)
 {
@@ -244,7 +303,20 @@ gis_summary_page_shown (GisPage *page)
                                    &priv->user_account,
                                    &priv->user_password);
 
-  gtk_widget_grab_focus (priv->start_button);
+  /* Send the system settings chosen on earlier pages all at once, and
+   * hold the session back until they have landed. The keyring is
+   * copied over to the new user, so any pending password change has
+   * to land first as well. */
+  gtk_widget_set_sensitive (priv->start_button, FALSE);
+  priv->pending_operations += 2;
+  gis_settings_transaction_commit_async (gis_driver_get_settings_transaction (GIS_PAGE (page)->driver),
+                                         NULL,
+                                         settings_committed,
+                                         g_object_ref (page));
+  gis_wait_for_login_keyring_password_async (KEYRING_UPDATE_TIMEOUT,
+                                             NULL,
+                                             keyring_password_changed,
+                                             g_object_ref (page));
 }
 
 static char *
@@ -329,23 +401,29 @@ gis_summary_page_constructed (GObject *object)
   gtk_widget_set_visible (priv->warning_icon,
                           gis_driver_is_live_session (GIS_PAGE (object)->driver));
 
-  if (gis_driver_is_live_session (GIS_PAGE (object)->driver))
-  {
-    gtk_label_set_label (GTK_LABEL (priv->title),
-                         _("You're ready to try Endless OS"));
-    gtk_label_set_markup (GTK_LABEL (priv->tagline),
-                          _("<b>Any files you download or documents you create will be "
-                            "lost forever when you restart or shutdown the computer.</b>"));
-  }
-
   gtk_widget_show (GTK_WIDGET (page));
 }
 
 static void
 gis_summary_page_locale_changed (GisPage *page)
 {
+  GisSummaryPagePrivate *priv = gis_summary_page_get_instance_private (GIS_SUMMARY_PAGE (page));
+
   gis_page_set_title (page, _("Ready to Go"));
   update_distro_name (GIS_SUMMARY_PAGE (page));
+
+  if (gis_driver_is_live_session (page->driver))
+  {
+    gtk_label_set_label (GTK_LABEL (priv->title),
+                         _("You're ready to try Endless OS"));
+    gtk_label_set_markup (GTK_LABEL (priv->tagline),
+                          _("<b>Any files you download or documents you create will be "
+                            "lost forever when you restart or shutdown the computer.</b>"));
+  }
+  else
+  {
+    gtk_label_set_label (GTK_LABEL (priv->title), _("You're ready to go!"));
+  }
 }
 
 static void
@@ -50,6 +50,9 @@ struct _CcTimezoneMapPrivate
   GdkPixbuf *orig_background;
   GdkPixbuf *orig_background_dim;
   GdkPixbuf *orig_color_map;
+  /* Of orig_background, kept while the images are released */
+  gint natural_width;
+  gint natural_height;
 
   GdkPixbuf *background;
   GdkPixbuf *color_map;
@@ -166,7 +169,7 @@ cc_timezone_map_get_preferred_width (GtkWidget *widget,
   CcTimezoneMapPrivate *priv = CC_TIMEZONE_MAP (widget)->priv;
   gint size;
 
-  size = gdk_pixbuf_get_width (priv->orig_background);
+  size = priv->natural_width;
 
   if (minimum != NULL)
     *minimum = size;
@@ -182,7 +185,7 @@ cc_timezone_map_get_preferred_height (GtkWidget *widget,
   CcTimezoneMapPrivate *priv = CC_TIMEZONE_MAP (widget)->priv;
   gint size;
 
-  size = gdk_pixbuf_get_height (priv->orig_background);
+  size = priv->natural_height;
 
   if (minimum != NULL)
     *minimum = size;
@@ -200,6 +203,19 @@ cc_timezone_map_size_allocate (GtkWidget     *widget,
   if (priv->background)
     g_object_unref (priv->background);
 
+  if (priv->orig_background == NULL)
+    {
+      /* Released; scaled again once they are restored */
+      priv->background = NULL;
+      g_clear_object (&priv->color_map);
+      priv->visible_map_pixels = NULL;
+      priv->visible_map_rowstride = 0;
+
+      GTK_WIDGET_CLASS (cc_timezone_map_parent_class)->size_allocate (widget,
+                                                                      allocation);
+      return;
+    }
+
   if (!gtk_widget_is_sensitive (widget))
     pixbuf = priv->orig_background_dim;
   else
@@ -373,6 +389,9 @@ cc_timezone_map_draw (GtkWidget *widget,
   gdouble pointx, pointy;
   char buf[16];
 
+  if (priv->background == NULL)
+    return FALSE;
+
   gtk_widget_get_allocation (widget, &alloc);
 
   /* paint background */
@@ -558,6 +577,9 @@ button_press_event (GtkWidget      *widget,
   rowstride = priv->visible_map_rowstride;
   pixels = priv->visible_map_pixels;
 
+  if (pixels == NULL)
+    return FALSE;
+
   r = pixels[(rowstride * y + x * 4)];
   g = pixels[(rowstride * y + x * 4) + 1];
   b = pixels[(rowstride * y + x * 4) + 2];
@@ -609,13 +631,11 @@ button_press_event (GtkWidget      *widget,
 }
 
 static void
-cc_timezone_map_init (CcTimezoneMap *self)
+load_images (CcTimezoneMap *map)
 {
-  CcTimezoneMapPrivate *priv;
+  CcTimezoneMapPrivate *priv = map->priv;
   GError *err = NULL;
 
-  priv = self->priv = TIMEZONE_MAP_PRIVATE (self);
-
   priv->orig_background = gdk_pixbuf_new_from_resource (DATETIME_RESOURCE_PATH "/bg.png",
                                                         &err);
 
@@ -645,6 +665,23 @@ cc_timezone_map_init (CcTimezoneMap *self)
       g_clear_error (&err);
     }
 
+  if (priv->orig_background)
+    {
+      priv->natural_width = gdk_pixbuf_get_width (priv->orig_background);
+      priv->natural_height = gdk_pixbuf_get_height (priv->orig_background);
+    }
+}
+
+static void
+cc_timezone_map_init (CcTimezoneMap *self)
+{
+  CcTimezoneMapPrivate *priv;
+  GError *err = NULL;
+
+  priv = self->priv = TIMEZONE_MAP_PRIVATE (self);
+
+  load_images (self);
+
   priv->pin = gdk_pixbuf_new_from_resource (DATETIME_RESOURCE_PATH "/pin.png",
                                             &err);
   if (!priv->pin)
@@ -717,3 +754,38 @@ cc_timezone_map_get_location (CcTimezoneMap *map)
 {
   return map->priv->location;
 }
+
+/**
+ * cc_timezone_map_release_images:
+ * @map: a #CcTimezoneMap
+ *
+ * Drops the map images, full size and scaled, while @map is not shown.
+ * The map keeps asking for the same size, and draws nothing until
+ * cc_timezone_map_restore_images() is called.
+ */
+void
+cc_timezone_map_release_images (CcTimezoneMap *map)
+{
+  CcTimezoneMapPrivate *priv = map->priv;
+
+  g_clear_object (&priv->orig_background);
+  g_clear_object (&priv->orig_background_dim);
+  g_clear_object (&priv->orig_color_map);
+  g_clear_object (&priv->background);
+  g_clear_object (&priv->color_map);
+
+  priv->visible_map_pixels = NULL;
+  priv->visible_map_rowstride = 0;
+}
+
+void
+cc_timezone_map_restore_images (CcTimezoneMap *map)
+{
+  if (map->priv->orig_background != NULL)
+    return;
+
+  load_images (map);
+
+  /* The scaled images are made when allocating */
+  gtk_widget_queue_resize (GTK_WIDGET (map));
+}
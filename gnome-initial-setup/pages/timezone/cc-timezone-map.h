@@ -74,6 +74,8 @@ gboolean cc_timezone_map_set_timezone (CcTimezoneMap *map,
 void cc_timezone_map_set_bubble_text (CcTimezoneMap *map,
                                       const gchar   *text);
 TzLocation * cc_timezone_map_get_location (CcTimezoneMap *map);
+void cc_timezone_map_release_images (CcTimezoneMap *map);
+void cc_timezone_map_restore_images (CcTimezoneMap *map);
 
 G_END_DECLS
 
@@ -43,7 +43,6 @@
 #define GWEATHER_I_KNOW_THIS_IS_UNSTABLE
 #include <libgweather/gweather.h>
 
-#include "timedated.h"
 #include "cc-datetime-resources.h"
 #include "timezone-resources.h"
 
@@ -58,6 +57,8 @@
 
 struct _GisTimezonePagePrivate
 {
+  GtkWidget *title;
+  GtkWidget *description;
   GtkWidget *map;
   GtkWidget *search_entry;
   GtkWidget *search_overlay;
@@ -66,7 +67,6 @@ struct _GisTimezonePagePrivate
   GClueClient *geoclue_client;
   GClueSimple *geoclue_simple;
   GWeatherLocation *current_location;
-  Timedate1 *dtm;
 
   GnomeWallClock *clock;
   GDesktopClockFormat clock_format;
@@ -100,39 +100,17 @@ get_default_time_format (void)
     return G_DESKTOP_CLOCK_FORMAT_24H;
 }
 
-static void
-set_timezone_cb (GObject      *source,
-                 GAsyncResult *res,
-                 gpointer      user_data)
-{
-  GisTimezonePage *page = user_data;
-  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (page);
-  GError *error;
-
-  error = NULL;
-  if (!timedate1_call_set_timezone_finish (priv->dtm,
-                                           res,
-                                           &error)) {
-    /* TODO: display any error in a user friendly way */
-    g_warning ("Could not set system timezone: %s", error->message);
-    g_error_free (error);
-  }
-}
-
-
 static void
 queue_set_timezone (GisTimezonePage *page,
                     const char      *tzid)
 {
-  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (page);
-
-  /* for now just do it */
-  timedate1_call_set_timezone (priv->dtm,
-                               tzid,
-                               TRUE,
-                               NULL,
-                               set_timezone_cb,
-                               page);
+  gis_settings_transaction_set_call (gis_driver_get_settings_transaction (GIS_PAGE (page)->driver),
+                                     "timezone",
+                                     "org.freedesktop.timedate1",
+                                     "/org/freedesktop/timedate1",
+                                     "org.freedesktop.timedate1",
+                                     "SetTimezone",
+                                     g_variant_new ("(sb)", tzid, TRUE));
 }
 
 static void
@@ -389,23 +367,10 @@ gis_timezone_page_constructed (GObject *object)
 {
   GisTimezonePage *page = GIS_TIMEZONE_PAGE (object);
   GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (page);
-  GError *error;
   GSettings *settings;
 
   G_OBJECT_CLASS (gis_timezone_page_parent_class)->constructed (object);
 
-  error = NULL;
-  priv->dtm = timedate1_proxy_new_for_bus_sync (G_BUS_TYPE_SYSTEM,
-                                                G_DBUS_PROXY_FLAGS_NONE,
-                                                "org.freedesktop.timedate1",
-                                                "/org/freedesktop/timedate1",
-                                                NULL,
-                                                &error);
-  if (priv->dtm == NULL) {
-    g_error ("Failed to create proxy for timedated: %s", error->message);
-    exit (1);
-  }
-
   priv->clock = g_object_new (GNOME_TYPE_WALL_CLOCK, NULL);
   g_signal_connect (priv->clock, "notify::clock", G_CALLBACK (on_clock_changed), page);
 
@@ -437,7 +402,6 @@ gis_timezone_page_dispose (GObject *object)
 
   stop_geolocation (page);
 
-  g_clear_object (&priv->dtm);
   g_clear_object (&priv->clock);
 
   G_OBJECT_CLASS (gis_timezone_page_parent_class)->dispose (object);
@@ -446,7 +410,20 @@ gis_timezone_page_dispose (GObject *object)
 static void
 gis_timezone_page_locale_changed (GisPage *page)
 {
+  GisTimezonePage *tz_page = GIS_TIMEZONE_PAGE (page);
+  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (tz_page);
+  TzLocation *location;
+
   gis_page_set_title (GIS_PAGE (page), _("Time Zone"));
+
+  gtk_label_set_label (GTK_LABEL (priv->title), _("Time Zone"));
+  gtk_label_set_label (GTK_LABEL (priv->description), _("The time zone will be set automatically if your location can be found. You can also search for a city to set it yourself."));
+  g_object_set (priv->search_overlay, "label", _("Please search for a nearby city"), NULL);
+
+  /* The city, country and time format in the bubble are translated too */
+  location = cc_timezone_map_get_location (CC_TIMEZONE_MAP (priv->map));
+  if (location)
+    update_timezone (tz_page, location);
 }
 
 static void
@@ -458,6 +435,56 @@ gis_timezone_page_shown (GisPage *page)
   stop_geolocation (tz_page);
 }
 
+static void
+gis_timezone_page_release_resources (GisPage *page)
+{
+  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (GIS_TIMEZONE_PAGE (page));
+
+  cc_timezone_map_release_images (CC_TIMEZONE_MAP (priv->map));
+}
+
+static void
+gis_timezone_page_restore_resources (GisPage *page)
+{
+  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (GIS_TIMEZONE_PAGE (page));
+
+  cc_timezone_map_restore_images (CC_TIMEZONE_MAP (priv->map));
+}
+
+static gboolean
+gis_timezone_page_apply_answers (GisPage      *page,
+                                 GKeyFile     *answers,
+                                 const gchar  *group,
+                                 GError      **error)
+{
+  GisTimezonePagePrivate *priv = gis_timezone_page_get_instance_private (GIS_TIMEZONE_PAGE (page));
+  gchar *tzid;
+  gboolean found;
+
+  tzid = g_key_file_get_string (answers, group, "timezone", error);
+  if (tzid == NULL)
+    return FALSE;
+
+  stop_geolocation (GIS_TIMEZONE_PAGE (page));
+
+  /* Emits location-changed, which queues the call to timedated */
+  found = cc_timezone_map_set_timezone (CC_TIMEZONE_MAP (priv->map), tzid);
+  if (found)
+    {
+      gtk_widget_set_visible (priv->search_overlay, FALSE);
+      gis_page_set_complete (page, TRUE);
+    }
+  else
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                   "Unknown timezone %s", tzid);
+    }
+
+  g_free (tzid);
+
+  return found;
+}
+
 static void
 gis_timezone_page_class_init (GisTimezonePageClass *klass)
 {
@@ -466,6 +493,8 @@ gis_timezone_page_class_init (GisTimezonePageClass *klass)
 
   gtk_widget_class_set_template_from_resource (GTK_WIDGET_CLASS (klass), "/org/gnome/initial-setup/gis-timezone-page.ui");
 
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisTimezonePage, title);
+  gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisTimezonePage, description);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisTimezonePage, map);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisTimezonePage, search_entry);
   gtk_widget_class_bind_template_child_private (GTK_WIDGET_CLASS (klass), GisTimezonePage, search_overlay);
@@ -473,6 +502,9 @@ gis_timezone_page_class_init (GisTimezonePageClass *klass)
   page_class->page_id = PAGE_ID;
   page_class->locale_changed = gis_timezone_page_locale_changed;
   page_class->shown = gis_timezone_page_shown;
+  page_class->apply_answers = gis_timezone_page_apply_answers;
+  page_class->release_resources = gis_timezone_page_release_resources;
+  page_class->restore_resources = gis_timezone_page_restore_resources;
   object_class->constructed = gis_timezone_page_constructed;
   object_class->dispose = gis_timezone_page_dispose;
 }